@@ -0,0 +1,94 @@
+#include <cmath>
+#include <vector>
+
+#include "../mesitype.h"
+#include "../mesimath.h"
+#include "../mesifastmath.h"
+#include "../mesiangle.h"
+#include "bench.h"
+
+Bench_Case(bench_angle) {
+	using Scalar = Mesi::Scalar;
+	using Angle = Mesi::Angle<>;
+	constexpr std::size_t count = 1 << 14;
+
+	// Headings spread over several turns, as after a long run of updates
+	std::vector<Scalar> radians(count), out(count);
+	std::vector<Angle> angles(count);
+	std::vector<Mesi::Meters> north(count), east(count);
+	for(std::size_t i = 0; i < count; i++)
+	{
+		radians[i] = Scalar(-100 + 200 * float(i) / count);
+		angles[i] = Angle(radians[i]);
+		north[i] = Mesi::Meters(std::cos(radians[i].val) * float(1 + i % 10));
+		east[i] = Mesi::Meters(std::sin(radians[i].val) * float(1 + i % 10));
+	}
+	std::vector<Angle> headings(count);
+
+	Bench::Run("sin, std::sin of Scalar (libm)", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			out[i] = std::sin(radians[i]);
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("sin, Mesi::Fast::sin of Scalar", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			out[i] = Mesi::Fast::sin(radians[i]);
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("sin, Mesi::sin of Angle", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			out[i] = Mesi::sin(angles[i]);
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("sin, Mesi::sin of Angle batch", count, [&] {
+		Mesi::sin(angles, out);
+		Bench::ClobberMemory();
+	});
+
+	Bench::Run("atan2, std::atan2 of Scalar (libm)", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			out[i] = std::atan2(Scalar(east[i].val), Scalar(north[i].val));
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("atan2, Angle::atan2", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			headings[i] = Angle::atan2(east[i], north[i]);
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("atan2, Mesi::atan2 batch", count, [&] {
+		Mesi::atan2(east, north, headings);
+		Bench::ClobberMemory();
+	});
+
+	// Turning by a small step each update, kept within one turn
+	Scalar const step(0.001f);
+	Angle const angle_step(step);
+	Bench::Run("Heading update, Scalar with fmod", count, [&] {
+		Scalar heading(0);
+		for(std::size_t i = 0; i < count; i++)
+		{
+			heading = Scalar(std::fmod((heading + step).val, 6.2831853f));
+			out[i] = heading;
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Heading update, Angle", count, [&] {
+		Angle heading = Angle::fromCode(0);
+		for(std::size_t i = 0; i < count; i++)
+		{
+			heading += angle_step;
+			headings[i] = heading;
+		}
+		Bench::ClobberMemory();
+	});
+}
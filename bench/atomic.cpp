@@ -0,0 +1,87 @@
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../mesiatomic.h"
+#include "bench.h"
+
+namespace {
+	/**
+	 * Runs body(thread) on `threads` threads and waits for them
+	 */
+	template<typename F>
+	void OnThreads(unsigned threads, F const& body)
+	{
+		std::vector<std::thread> workers;
+		for(unsigned t = 0; t < threads; t++)
+		{
+			workers.emplace_back(body, t);
+		}
+		for(auto& w : workers)
+		{
+			w.join();
+		}
+	}
+}
+
+Bench_Case(bench_atomic_contention) {
+	using Joules = Mesi::Joules;
+	using Coulombs = Mesi::Type<int64_t, 0, 1, 0, 1>;
+	constexpr std::size_t additions = 1 << 20;
+	unsigned const hardware = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+
+	for(unsigned threads = 1; threads <= hardware && threads <= 16; threads *= 2)
+	{
+		std::size_t const items = additions * threads;
+		char name[64];
+		std::printf("  %u thread(s)\n", threads);
+
+		Joules locked(0);
+		std::mutex mutex;
+		std::snprintf(name, sizeof(name), "  Joules behind std::mutex");
+		Bench::Run(name, items, [&] {
+			OnThreads(threads, [&](unsigned) {
+				for(std::size_t i = 0; i < additions; i++)
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					locked += Joules(1);
+				}
+			});
+		});
+
+		Mesi::Atomic<Joules> energy(Joules(0));
+		std::snprintf(name, sizeof(name), "  Atomic<Joules>::fetch_add (CAS loop)");
+		Bench::Run(name, items, [&] {
+			OnThreads(threads, [&](unsigned) {
+				for(std::size_t i = 0; i < additions; i++)
+				{
+					energy.fetch_add(Joules(1), std::memory_order_relaxed);
+				}
+			});
+		});
+
+		Mesi::Atomic<Coulombs> charge(Coulombs(0));
+		std::snprintf(name, sizeof(name), "  Atomic<int64 Coulombs>::fetch_add");
+		Bench::Run(name, items, [&] {
+			OnThreads(threads, [&](unsigned) {
+				for(std::size_t i = 0; i < additions; i++)
+				{
+					charge.fetch_add(Coulombs(1), std::memory_order_relaxed);
+				}
+			});
+		});
+
+		Mesi::ShardedCounter<Joules> sharded;
+		std::snprintf(name, sizeof(name), "  ShardedCounter<Joules>::add");
+		Bench::Run(name, items, [&] {
+			OnThreads(threads, [&](unsigned) {
+				for(std::size_t i = 0; i < additions; i++)
+				{
+					sharded.add(Joules(1));
+				}
+			});
+		});
+		Bench::DoNotOptimize(locked);
+		Bench::DoNotOptimize(sharded.load());
+	}
+}
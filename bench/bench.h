@@ -0,0 +1,177 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(__linux__)
+#	include <linux/perf_event.h>
+#	include <sys/ioctl.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#endif
+
+/**
+ * Minimal benchmarking harness. Cases are registered with Bench_Case and
+ * run by main.cpp; each case reports results through Bench::Report.
+ */
+namespace Bench {
+	/**
+	 * Prevents the compiler from discarding a value that is otherwise unused
+	 */
+	template<typename T>
+	inline void DoNotOptimize(T const& value)
+	{
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+
+	/**
+	 * Prevents the compiler from assuming memory is unchanged across this point
+	 */
+	inline void ClobberMemory()
+	{
+		asm volatile("" : : : "memory");
+	}
+
+	struct Case
+	{
+		char const* name;
+		void (*run)();
+	};
+
+	inline std::vector<Case>& Cases()
+	{
+		static std::vector<Case> s_cases;
+		return s_cases;
+	}
+
+	struct Registrar
+	{
+		Registrar(char const* name, void (*run)())
+		{
+			Cases().push_back(Case{name, run});
+		}
+	};
+
+	/**
+	 * Runs f() `repeats` times and returns the best wall-clock time for a
+	 * single run, in nanoseconds
+	 */
+	template<typename F>
+	double Time(F&& f, int repeats = 5)
+	{
+		double best = 0;
+		for(int i = 0; i < repeats; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			f();
+			auto end = std::chrono::steady_clock::now();
+			double ns = std::chrono::duration<double, std::nano>(end - start).count();
+			if(i == 0 || ns < best)
+			{
+				best = ns;
+			}
+		}
+		return best;
+	}
+
+	/**
+	 * Prints one row of the results table
+	 */
+	inline void Report(char const* name, double value, char const* unit)
+	{
+		std::printf("  %-48s %12.3f %s\n", name, value, unit);
+	}
+
+	/**
+	 * Times f(), which processes `items` items, and reports ns per item
+	 */
+	template<typename F>
+	void Run(char const* name, std::size_t items, F&& f)
+	{
+		Report(name, Time(f) / double(items), "ns/item");
+	}
+
+	/**
+	 * Counts the last-level cache misses of the calling thread in user
+	 * space. Only available on Linux, and only where the kernel exposes the PMU and
+	 * perf_event_paranoid allows it (virtual machines often don't), so
+	 * check available() before reporting a count.
+	 */
+	class CacheMisses
+	{
+	public:
+#if defined(__linux__)
+		CacheMisses()
+		{
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_CACHE_MISSES;
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			p_fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+		}
+
+		~CacheMisses()
+		{
+			if(p_fd >= 0)
+			{
+				close(p_fd);
+			}
+		}
+
+		/**
+		 * The number of misses during f(), or 0 if unavailable
+		 */
+		template<typename F>
+		unsigned long long count(F&& f)
+		{
+			if(p_fd < 0)
+			{
+				f();
+				return 0;
+			}
+			ioctl(p_fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(p_fd, PERF_EVENT_IOC_ENABLE, 0);
+			f();
+			ioctl(p_fd, PERF_EVENT_IOC_DISABLE, 0);
+			unsigned long long value = 0;
+			if(read(p_fd, &value, sizeof(value)) != sizeof(value))
+			{
+				return 0;
+			}
+			return value;
+		}
+#else
+		CacheMisses()
+		{}
+
+		template<typename F>
+		unsigned long long count(F&& f)
+		{
+			f();
+			return 0;
+		}
+#endif
+
+		bool available() const
+		{
+			return p_fd >= 0;
+		}
+
+		CacheMisses(CacheMisses const&) = delete;
+		CacheMisses& operator=(CacheMisses const&) = delete;
+
+	private:
+		int p_fd = -1;
+	};
+}
+
+#define Bench_Case(name) \
+	static void name(); \
+	static Bench::Registrar name##_registrar(#name, &name); \
+	static void name()
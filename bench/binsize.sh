@@ -0,0 +1,35 @@
+#!/bin/sh
+# Measures the code size of the simulation workloads in simulation.h, built
+# once against Mesi types and once against raw floats, so that growth in the
+# headers' generated code shows up. Each workload is compiled on its own
+# into an object file and the sizes of their text sections are compared.
+#
+# Usage: binsize.sh [compiler flags]
+
+set -e
+
+CXX=${CXX:-g++}
+FLAGS=${*:--O3 -march=native}
+ROOT=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+unit() {
+	cat <<UNIT
+#include "$ROOT/simulation.h"
+
+void gravity(Simulation::$1::Bodies& b, $2 dt) { Simulation::$1::GravityStep(b, dt); }
+void springs(Simulation::$1::Chain& c, $2 dt) { Simulation::$1::SpringStep(c, dt); }
+UNIT
+}
+
+# Prints the text section size of one workload's object file
+measure() {
+	unit "$1" "$2" > "$WORK/$1.cpp"
+	$CXX -std=c++14 $FLAGS -c "$WORK/$1.cpp" -o "$WORK/$1.o"
+	size "$WORK/$1.o" | awk -v name="$1" 'NR == 2 { printf "  %-36s %8d bytes\n", name, $1 }'
+}
+
+echo "Text size of the simulation workloads with $CXX $FLAGS"
+measure Raw float
+measure Typed Mesi::Seconds
@@ -0,0 +1,71 @@
+#!/bin/sh
+# Measures the time to compile a project of many translation units that
+# each use the Mesi named units, included as mesitype.h, as mesicore.h, and
+# imported as the C++20 module.
+#
+# Usage: buildtime.sh [translation units]
+
+set -e
+
+UNITS=${1:-64}
+CXX=${CXX:-g++}
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+unit_body() {
+	cat <<BODY
+namespace unit$1 {
+	Mesi::Joules work(Mesi::Newtons f, Mesi::Meters d) { return f * d; }
+	Mesi::Watts power(Mesi::Volts v, Mesi::Amperes i) { return v * i; }
+	Mesi::Ohms resistance(Mesi::Volts v, Mesi::Amperes i) { return v / i; }
+	Mesi::Pascals pressure(Mesi::Newtons f, Mesi::MetersSq a) { return f / a; }
+	Mesi::Henry inductance(Mesi::Webers w, Mesi::Amperes i) { return w / i; }
+	Mesi::Tesla field(Mesi::Webers w, Mesi::MetersSq a) { return w / a; }
+	Mesi::Farads capacitance(Mesi::Coulombs q, Mesi::Volts v) { return q / v; }
+	Mesi::Meters distance(Mesi::Kilo<Mesi::Meters> km) { return Mesi::Meters(km); }
+}
+BODY
+}
+
+generate() {
+	dir=$WORK/$1
+	mkdir -p "$dir"
+	i=0
+	while [ "$i" -lt "$UNITS" ]; do
+		{ printf '%s\n' "$2"; unit_body "$i"; } > "$dir/unit$i.cpp"
+		i=$((i + 1))
+	done
+}
+
+# Compiles every unit in a directory one after another, printing the time
+measure() {
+	name=$1
+	dir=$WORK/$1
+	shift
+	start=$(date +%s.%N)
+	for f in "$dir"/unit*.cpp; do
+		(cd "$WORK" && $CXX "$@" -c "$f" -o "$f.o")
+	done
+	end=$(date +%s.%N)
+	echo "$start $end" | awk -v name="$name" -v n="$UNITS" '{ printf "  %-36s %8.2f s (%.1f ms/unit)\n", name, $2 - $1, 1000 * ($2 - $1) / n }'
+}
+
+echo "Compiling $UNITS translation units with $CXX"
+
+generate mesitype "#include \"$ROOT/mesitype.h\""
+measure mesitype -std=c++14 -O0
+
+generate mesicore "#include \"$ROOT/mesicore.h\""
+measure mesicore -std=c++14 -O0
+
+generate module "import mesi;"
+if (cd "$WORK" && $CXX -std=c++20 -fmodules-ts -x c++ -c "$ROOT/mesi.cppm" -o mesi.o) 2>/dev/null; then
+	start=$(date +%s.%N)
+	(cd "$WORK" && $CXX -std=c++20 -fmodules-ts -x c++ -c "$ROOT/mesi.cppm" -o mesi.o)
+	end=$(date +%s.%N)
+	echo "$start $end" | awk '{ printf "  %-36s %8.2f s\n", "module interface (once)", $2 - $1 }'
+	measure module -std=c++20 -fmodules-ts -O0
+else
+	echo "  $CXX can't build mesi.cppm with -fmodules-ts, skipping the module"
+fi
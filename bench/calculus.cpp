@@ -0,0 +1,81 @@
+#include <vector>
+
+#include "../mesicalculus.h"
+#include "bench.h"
+
+Bench_Case(bench_calculus) {
+	using Speed = decltype(Mesi::Meters{} / Mesi::Seconds{});
+	using Distance = decltype(Speed{} * Mesi::Seconds{});
+	constexpr std::size_t count = 1 << 22;
+
+	std::vector<Speed> speeds(count);
+	std::vector<Mesi::Seconds> times(count);
+	std::vector<float> raw_speeds(count), raw_times(count), raw_out(count);
+	float t = 0;
+	for(std::size_t i = 0; i < count; i++)
+	{
+		t += 0.01f + 0.001f * float(i % 7);
+		times[i] = Mesi::Seconds(t);
+		speeds[i] = Speed(float(i % 100) * 0.1f);
+		raw_times[i] = t;
+		raw_speeds[i] = speeds[i].val;
+	}
+	std::vector<Distance> distances(count);
+	std::vector<decltype(Speed{} / Mesi::Seconds{})> accelerations(count);
+
+	Bench::Run("Trapezoid, raw float serial loop", count, [&] {
+		float sum = 0;
+		for(std::size_t i = 1; i < count; i++)
+		{
+			sum += 0.5f * (raw_speeds[i] + raw_speeds[i - 1]) * (raw_times[i] - raw_times[i - 1]);
+		}
+		Bench::DoNotOptimize(sum);
+	});
+	Bench::Run("Trapezoid, 1 thread", count, [&] {
+		Bench::DoNotOptimize(Mesi::trapezoid(speeds, times, 1));
+	});
+	Bench::Run("Trapezoid, automatic threads", count, [&] {
+		Bench::DoNotOptimize(Mesi::trapezoid(speeds, times));
+	});
+
+	Bench::Run("Cumulative trapezoid, raw float serial loop", count, [&] {
+		float sum = 0;
+		raw_out[0] = 0;
+		for(std::size_t i = 1; i < count; i++)
+		{
+			sum += 0.5f * (raw_speeds[i] + raw_speeds[i - 1]) * (raw_times[i] - raw_times[i - 1]);
+			raw_out[i] = sum;
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Cumulative trapezoid, 1 thread", count, [&] {
+		Mesi::cumulative_trapezoid(speeds, times, distances, 1);
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Cumulative trapezoid, automatic threads", count, [&] {
+		Mesi::cumulative_trapezoid(speeds, times, distances);
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Cumulative Simpson, automatic threads", count, [&] {
+		Mesi::cumulative_simpson(speeds, times, distances);
+		Bench::ClobberMemory();
+	});
+
+	Bench::Run("Gradient, raw float serial loop", count, [&] {
+		raw_out[0] = (raw_speeds[1] - raw_speeds[0]) / (raw_times[1] - raw_times[0]);
+		for(std::size_t i = 1; i + 1 < count; i++)
+		{
+			raw_out[i] = (raw_speeds[i + 1] - raw_speeds[i - 1]) / (raw_times[i + 1] - raw_times[i - 1]);
+		}
+		raw_out[count - 1] = (raw_speeds[count - 1] - raw_speeds[count - 2]) / (raw_times[count - 1] - raw_times[count - 2]);
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Gradient, 1 thread", count, [&] {
+		Mesi::gradient(speeds, times, accelerations, 1);
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Gradient, automatic threads", count, [&] {
+		Mesi::gradient(speeds, times, accelerations);
+		Bench::ClobberMemory();
+	});
+}
@@ -0,0 +1,63 @@
+#include <vector>
+
+#include "../mesichecked.h"
+#include "bench.h"
+
+namespace {
+	/**
+	 * A dependent chain of kinematics updates, as a simulation loop would
+	 * do, so the cost of the checks isn't hidden by memory bandwidth
+	 */
+	template<typename T>
+	void Integrate(std::vector<Mesi::Type<T, 1, 0, 0>>& positions, std::vector<Mesi::Type<T, 1, -1, 0>>& velocities,
+		Mesi::Type<T, 1, -2, 0> gravity, Mesi::Type<T, 0, 1, 0> dt)
+	{
+		for(std::size_t i = 0; i < positions.size(); i++)
+		{
+			velocities[i] += gravity * dt;
+			positions[i] += velocities[i] * dt;
+		}
+	}
+
+	template<typename T>
+	void BenchIntegrate(char const* name, std::size_t count)
+	{
+		std::vector<Mesi::Type<T, 1, 0, 0>> positions(count, Mesi::Type<T, 1, 0, 0>(T(0)));
+		std::vector<Mesi::Type<T, 1, -1, 0>> velocities(count, Mesi::Type<T, 1, -1, 0>(T(1)));
+		Bench::Run(name, count, [&] {
+			Integrate(positions, velocities, Mesi::Type<T, 1, -2, 0>(T(-9.8f)), Mesi::Type<T, 0, 1, 0>(T(0.01f)));
+			Bench::ClobberMemory();
+		});
+		Bench::DoNotOptimize(positions[count / 2]);
+	}
+
+	template<typename T>
+	void BenchIntegerSum(char const* name, std::vector<int32_t> const& values)
+	{
+		Bench::Run(name, values.size(), [&] {
+			Mesi::Type<T, 0, 0, 0, 1> sum(T(0));
+			for(int32_t v : values)
+			{
+				sum += Mesi::Type<T, 0, 0, 0, 1>(T(v));
+			}
+			Bench::DoNotOptimize(sum);
+		});
+	}
+}
+
+Bench_Case(bench_checked) {
+	constexpr std::size_t count = 1 << 16;
+	BenchIntegrate<float>("Kinematics step, float", count);
+	BenchIntegrate<Mesi::Checked<float>>("Kinematics step, Checked<float>", count);
+	BenchIntegrate<double>("Kinematics step, double", count);
+	BenchIntegrate<Mesi::Checked<double>>("Kinematics step, Checked<double>", count);
+
+	std::vector<int32_t> values(1 << 20);
+	for(std::size_t i = 0; i < values.size(); i++)
+	{
+		values[i] = int32_t(i % 1000) - 500;
+	}
+	BenchIntegerSum<int32_t>("Sum of Amperes, int32_t", values);
+	BenchIntegerSum<Mesi::Checked<int32_t>>("Sum of Amperes, Checked<int32_t>", values);
+	Bench::Report("Failures recorded", double(Mesi::CheckedFailures().total()), "");
+}
@@ -0,0 +1,44 @@
+#include <chrono>
+#include <cstdint>
+
+#include "../mesiclock.h"
+#include "bench.h"
+
+Bench_Case(bench_clock) {
+	constexpr std::size_t reads = 1 << 20;
+
+	Bench::Run("Clock read, std::chrono::steady_clock", reads, [&] {
+		for(std::size_t i = 0; i < reads; i++)
+		{
+			Bench::DoNotOptimize(std::chrono::steady_clock::now());
+		}
+	});
+	Bench::Run("Clock read, Mesi::SteadyClock", reads, [&] {
+		for(std::size_t i = 0; i < reads; i++)
+		{
+			Bench::DoNotOptimize(Mesi::SteadyClock::ticks());
+		}
+	});
+	Bench::Run("Clock read, Mesi::ProfileClock", reads, [&] {
+		for(std::size_t i = 0; i < reads; i++)
+		{
+			Bench::DoNotOptimize(Mesi::ProfileClock::ticks());
+		}
+	});
+
+	// An empty scope, i.e. the whole cost of timing one
+	Mesi::TimeHistogram histogram;
+	Bench::Run("Empty scope, ScopedTimer<SteadyClock>", reads, [&] {
+		for(std::size_t i = 0; i < reads; i++)
+		{
+			Mesi::ScopedTimer<Mesi::SteadyClock> timer(histogram);
+		}
+	});
+	Bench::Run("Empty scope, ScopedTimer<ProfileClock>", reads, [&] {
+		for(std::size_t i = 0; i < reads; i++)
+		{
+			Mesi::ScopedTimer<> timer(histogram);
+		}
+	});
+	Bench::Report("Empty scope, median", double(Mesi::Nano<Mesi::Seconds>(histogram.quantile(0.5)).val), "ns");
+}
@@ -0,0 +1,65 @@
+#include <complex>
+#include <vector>
+
+#include "../mesicomplex.h"
+#include "bench.h"
+
+Bench_Case(bench_complex) {
+	using Complex = std::complex<float>;
+	using ComplexVolts = Mesi::Type<Complex, 2, -3, 1, -1>;
+	using ComplexAmperes = Mesi::Type<Complex, 0, 0, 0, 1>;
+	using ComplexOhms = decltype(ComplexVolts{} / ComplexAmperes{});
+	constexpr std::size_t count = 1 << 20;
+
+	// A frequency sweep of the voltage across, and current through, a load
+	std::vector<ComplexVolts> voltages(count);
+	std::vector<ComplexAmperes> currents(count);
+	std::vector<Complex> raw_voltages(count), raw_currents(count), raw_out(count);
+	for(std::size_t i = 0; i < count; i++)
+	{
+		raw_voltages[i] = std::polar(230.0f, 0.001f * float(i % 1000));
+		raw_currents[i] = std::polar(1.0f + 0.01f * float(i % 100), -0.002f * float(i % 500));
+		voltages[i] = ComplexVolts(raw_voltages[i]);
+		currents[i] = ComplexAmperes(raw_currents[i]);
+	}
+	std::vector<ComplexOhms> impedances(count);
+	std::vector<ComplexVolts> products(count);
+
+	Bench::Run("Complex multiply, raw std::complex loop", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			raw_out[i] = raw_voltages[i] * raw_currents[i];
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Complex multiply, Mesi scalar loop", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			products[i] = impedances[i] * currents[i];
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Complex multiply, Mesi::multiply", count, [&] {
+		Mesi::multiply(impedances, currents, products);
+		Bench::ClobberMemory();
+	});
+
+	Bench::Run("Complex divide, raw std::complex loop", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			raw_out[i] = raw_voltages[i] / raw_currents[i];
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Complex divide, Mesi scalar loop", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			impedances[i] = voltages[i] / currents[i];
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Complex divide, Mesi::divide", count, [&] {
+		Mesi::divide(voltages, currents, impedances);
+		Bench::ClobberMemory();
+	});
+}
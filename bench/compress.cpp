@@ -0,0 +1,38 @@
+#include <cmath>
+#include <vector>
+
+#include "../mesicompress.h"
+#include "bench.h"
+
+Bench_Case(bench_time_series_compression) {
+	using Time = Mesi::NanosecondTimestamps;
+	constexpr std::size_t count = 1 << 20;
+	std::vector<Time> times;
+	std::vector<Mesi::Kelvin> values;
+	for(std::size_t i = 0; i < count; i++)
+	{
+		// A 10 Hz sensor with a little jitter, reporting to 0.1 K
+		times.push_back(Time(int64_t(i) * 100000000 + int64_t(i % 11 == 0 ? 1000 : 0)));
+		values.push_back(Mesi::Kelvin(std::round(2930.f + 20.f * std::sin(float(i) * 1e-3f)) / 10.f));
+	}
+
+	Mesi::TimeSeriesEncoder<Mesi::Kelvin> encoder;
+	Bench::Run("TimeSeriesEncoder::append", count, [&] {
+		Mesi::TimeSeriesEncoder<Mesi::Kelvin> e;
+		e.append(times, values);
+		Bench::DoNotOptimize(e);
+	});
+	encoder.append(times, values);
+
+	std::vector<Time> outTimes(count);
+	std::vector<Mesi::Kelvin> outValues(count);
+	double ns = Bench::Time([&] {
+		Mesi::TimeSeriesDecoder<Mesi::Kelvin> decoder(encoder.words());
+		decoder.decode(outTimes, outValues);
+		Bench::ClobberMemory();
+	});
+	double raw = double(count * (sizeof(Time) + sizeof(Mesi::Kelvin)));
+	Bench::Report("TimeSeriesDecoder::decode", ns / count, "ns/item");
+	Bench::Report("Decode throughput (uncompressed bytes)", raw / ns, "GB/s");
+	Bench::Report("Compression ratio", raw / double(encoder.sizeInBytes()), "x");
+}
@@ -0,0 +1,79 @@
+#include <cmath>
+#include <vector>
+
+#include "../mesitype.h"
+#include "../mesimath.h"
+#include "../mesidual.h"
+#include "bench.h"
+
+namespace {
+	/**
+	 * Gravitational potential energy of a unit mass at (x, y, z) near two
+	 * point masses, written once for any storage type
+	 */
+	template<typename L>
+	auto Potential(L const& x, L const& y, L const& z)
+	{
+		using Mass = decltype(Mesi::Kilograms{} * Mesi::Scalar{});
+		using Gravitational = decltype(Mesi::MetersCu{} / Mesi::Kilograms{} / Mesi::Seconds{} / Mesi::Seconds{});
+		Gravitational const g(6.674e-11f);
+		Mass const m1(5.97e24f), m2(7.35e22f), unit(1.0f);
+		auto const dx = x - Mesi::Meters(3.84e8f);
+		auto const r1 = std::sqrt(x * x + y * y + z * z);
+		auto const r2 = std::sqrt(dx * dx + y * y + z * z);
+		return -g * unit * (m1 / r1 + m2 / r2);
+	}
+}
+
+Bench_Case(bench_dual) {
+	using Meters = Mesi::Meters;
+	constexpr std::size_t count = 1 << 16;
+
+	std::vector<Meters> xs(count), ys(count), zs(count);
+	for(std::size_t i = 0; i < count; i++)
+	{
+		xs[i] = Meters(1e7f + 3e8f * float(i) / count);
+		ys[i] = Meters(2e7f * float(i % 17));
+		zs[i] = Meters(1e6f * float(i % 5));
+	}
+	using Force = Mesi::Newtons;
+	std::vector<Force> fx(count), fy(count), fz(count);
+
+	// Central differences need two more evaluations per direction, and a
+	// step that trades truncation error against rounding error
+	Bench::Run("Gradient, central differences (6 evaluations)", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			Meters const h = xs[i] * Mesi::Scalar(1e-3f);
+			Mesi::Scalar const half(0.5f);
+			fx[i] = -(Potential(xs[i] + h, ys[i], zs[i]) - Potential(xs[i] - h, ys[i], zs[i])) * half / h;
+			fy[i] = -(Potential(xs[i], ys[i] + h, zs[i]) - Potential(xs[i], ys[i] - h, zs[i])) * half / h;
+			fz[i] = -(Potential(xs[i], ys[i], zs[i] + h) - Potential(xs[i], ys[i], zs[i] - h)) * half / h;
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Gradient, Dual<float, 3> (1 evaluation)", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			auto const x = Mesi::independent<3>(xs[i], 0);
+			auto const y = Mesi::independent<3>(ys[i], 1);
+			auto const z = Mesi::independent<3>(zs[i], 2);
+			auto const energy = Potential(x, y, z);
+			fx[i] = -Mesi::derivative(energy, x, 0);
+			fy[i] = -Mesi::derivative(energy, y, 1);
+			fz[i] = -Mesi::derivative(energy, z, 2);
+		}
+		Bench::ClobberMemory();
+	});
+
+	// The dual results are exact up to rounding, so this is the error of
+	// the differences
+	float worst = 0;
+	for(std::size_t i = 0; i < count; i++)
+	{
+		Meters const h = xs[i] * Mesi::Scalar(1e-3f);
+		Force const difference = -(Potential(xs[i] + h, ys[i], zs[i]) - Potential(xs[i] - h, ys[i], zs[i])) * Mesi::Scalar(0.5f) / h;
+		worst = std::fmax(worst, std::fabs((difference.val - fx[i].val) / fx[i].val));
+	}
+	Bench::Report("Worst relative error of central differences", worst, "");
+}
@@ -0,0 +1,44 @@
+#include <cmath>
+#include <vector>
+
+#include "../mesifastmath.h"
+#include "bench.h"
+
+namespace {
+	constexpr std::size_t c_count = 1 << 14;
+
+	/**
+	 * Times f over c_count inputs spread over [lo, hi)
+	 */
+	template<typename F>
+	void Measure(char const* name, float lo, float hi, F f)
+	{
+		std::vector<Mesi::Scalar> in;
+		for(std::size_t i = 0; i < c_count; i++)
+		{
+			in.push_back(Mesi::Scalar(lo + (hi - lo) * float(i) / c_count));
+		}
+		std::vector<decltype(f(in[0]))> out(c_count);
+		Bench::Run(name, c_count, [&] {
+			for(std::size_t i = 0; i < c_count; i++)
+			{
+				out[i] = f(in[i]);
+			}
+			Bench::ClobberMemory();
+		});
+	}
+}
+
+Bench_Case(bench_fast_math) {
+	using Scalar = Mesi::Scalar;
+	Measure("Mesi::Fast::exp", -20, 20, [](Scalar x) { return Mesi::Fast::exp(x); });
+	Measure("std::exp (libm)", -20, 20, [](Scalar x) { return std::exp(x); });
+	Measure("Mesi::Fast::log", 1e-3f, 1e3f, [](Scalar x) { return Mesi::Fast::log(x); });
+	Measure("std::log (libm)", 1e-3f, 1e3f, [](Scalar x) { return std::log(x); });
+	Measure("Mesi::Fast::sin", -100, 100, [](Scalar x) { return Mesi::Fast::sin(x); });
+	Measure("std::sin (libm)", -100, 100, [](Scalar x) { return std::sin(x); });
+	Measure("Mesi::Fast::atan2", -100, 100, [](Scalar x) { return Mesi::Fast::atan2(x, Scalar(7)); });
+	Measure("std::atan2 (libm)", -100, 100, [](Scalar x) { return std::atan2(x, Scalar(7)); });
+	Measure("Mesi::Fast::sqrt", 1e-3f, 1e3f, [](Scalar x) { return Mesi::Fast::sqrt(x); });
+	Measure("std::sqrt (libm)", 1e-3f, 1e3f, [](Scalar x) { return std::sqrt(x); });
+}
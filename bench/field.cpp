@@ -0,0 +1,68 @@
+#include <string>
+#include <vector>
+
+#include "../mesifield.h"
+#include "bench.h"
+
+Bench_Case(bench_field) {
+	using Curvature = decltype(Mesi::Kelvin{} / (Mesi::Meters{} * Mesi::Meters{}));
+	constexpr std::size_t side = 2048;
+	constexpr std::size_t cube = 128;
+	auto const Label = [](char const* name, unsigned const threads) {
+		return name + (threads == 0 ? std::string("automatic threads")
+			: std::to_string(threads) + (threads == 1 ? " thread" : " threads"));
+	};
+
+	Mesi::Field<Mesi::Kelvin, 2> plate({side, side});
+	Mesi::Field<Curvature, 2> plate_out({side, side});
+	for(std::size_t i = 0; i < side; i++)
+	{
+		for(std::size_t j = 0; j < side; j++)
+		{
+			plate(i, j) = Mesi::Kelvin(float((i * 7 + j * 3) % 100));
+		}
+	}
+	plate.extendHalo();
+
+	// The same padded layout without units, as a hand-written stencil would
+	// use it
+	std::size_t const row = plate.strides()[0];
+	std::vector<float> raw((side + 2) * row), raw_out((side + 2) * row);
+	for(std::size_t k = 0; k < raw.size(); k++)
+	{
+		raw[k] = plate.baseData()[k];
+	}
+	Bench::Run("Laplacian 2048^2, raw float serial loop", side * side, [&] {
+		float const scale = 1.0f / (0.01f * 0.01f);
+		for(std::size_t i = 1; i <= side; i++)
+		{
+			float const* src = raw.data() + i * row + 1;
+			float* dst = raw_out.data() + i * row + 1;
+			for(std::size_t j = 0; j < side; j++)
+			{
+				dst[j] = (src[j - row] + src[j + row] + src[j - 1] + src[j + 1] - 4 * src[j]) * scale;
+			}
+		}
+		Bench::ClobberMemory();
+	});
+	for(unsigned const threads : {1u, 2u, 4u, 0u})
+	{
+		Bench::Run(Label("Laplacian 2048^2, ", threads).c_str(), side * side, [&] {
+			Mesi::laplacian(plate, Mesi::Meters(0.01f), plate_out, threads);
+			Bench::ClobberMemory();
+		});
+	}
+
+	Mesi::Field<Mesi::Kelvin, 3> block({cube, cube, cube});
+	Mesi::Field<Curvature, 3> block_out({cube, cube, cube});
+	block.fill(Mesi::Kelvin(300));
+	block(cube / 2, cube / 2, cube / 2) = Mesi::Kelvin(400);
+	block.wrapHalo();
+	for(unsigned const threads : {1u, 2u, 4u, 0u})
+	{
+		Bench::Run(Label("Laplacian 128^3, ", threads).c_str(), cube * cube * cube, [&] {
+			Mesi::laplacian(block, Mesi::Meters(0.01f), block_out, threads);
+			Bench::ClobberMemory();
+		});
+	}
+}
@@ -0,0 +1,61 @@
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../mesigroupby.h"
+#include "bench.h"
+
+Bench_Case(bench_group_by) {
+	using Watts = Mesi::Watts;
+	using Seconds = Mesi::Seconds;
+	using Joules = Mesi::Joules;
+	constexpr std::size_t rows = 1 << 22;
+	constexpr std::size_t devices = 1000;
+
+	// Power readings from a thousand devices with arbitrary 32-bit IDs, in
+	// no particular order
+	uint32_t state = 12345;
+	std::vector<uint32_t> serials(devices);
+	for(auto& s : serials)
+	{
+		state = state * 1664525u + 1013904223u;
+		s = state;
+	}
+	std::vector<uint32_t> ids(rows);
+	std::vector<Watts> power(rows);
+	std::vector<Seconds> durations(rows, Seconds(0.5f));
+	for(std::size_t i = 0; i < rows; i++)
+	{
+		state = state * 1664525u + 1013904223u;
+		ids[i] = serials[(state >> 8) % devices];
+		power[i] = Watts(float(state >> 20));
+	}
+
+	Bench::Run("Energy per device, std::unordered_map, raw float", rows, [&] {
+		std::unordered_map<uint32_t, double> energy;
+		for(std::size_t i = 0; i < rows; i++)
+		{
+			energy[ids[i]] += double(power[i].val) * double(durations[i].val);
+		}
+		Bench::DoNotOptimize(energy);
+	});
+	for(unsigned threads : {1u, 2u, 4u, 0u})
+	{
+		std::string const label = "Energy per device, GroupBy, threads " + (threads ? std::to_string(threads) : std::string("auto"));
+		Bench::Run(label.c_str(), rows, [&] {
+			Mesi::GroupBy<uint32_t> const groups(ids, threads);
+			std::vector<Joules> energy(groups.size());
+			groups.sumProduct(power, durations, energy, threads);
+			Bench::DoNotOptimize(energy);
+		});
+	}
+
+	// Grouping once and aggregating several columns
+	Mesi::GroupBy<uint32_t> const groups(ids);
+	std::vector<Watts> peak(groups.size());
+	Bench::Run("Peak power per device, grouped once", rows, [&] {
+		groups.max(power, peak);
+		Bench::ClobberMemory();
+	});
+}
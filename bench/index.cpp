@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "../mesiindex.h"
+#include "bench.h"
+
+Bench_Case(bench_index) {
+	using Meters = Mesi::Meters;
+	using Kilometers = Mesi::Kilo<Meters>;
+	constexpr std::size_t count = 1 << 22;
+	constexpr std::size_t queries = 1 << 16;
+
+	// Altitudes up to 10 km in no particular order
+	std::vector<Meters> altitudes(count);
+	uint32_t state = 12345;
+	for(auto& a : altitudes)
+	{
+		state = state * 1664525u + 1013904223u;
+		a = Meters(float(state >> 8) * (10000.0f / 16777216.0f));
+	}
+	std::vector<Meters> keys(queries);
+	for(auto& k : keys)
+	{
+		state = state * 1664525u + 1013904223u;
+		k = Meters(float(state >> 8) * (10000.0f / 16777216.0f));
+	}
+	Mesi::SortedIndex<Meters> const index(altitudes);
+	std::vector<Meters> const sorted(index.values().begin(), index.values().end());
+	std::vector<std::size_t> out(queries);
+
+	Bench::Run("Lower bound, std::lower_bound", queries, [&] {
+		for(std::size_t i = 0; i < queries; i++)
+		{
+			out[i] = std::size_t(std::lower_bound(sorted.begin(), sorted.end(), keys[i]) - sorted.begin());
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Lower bound, SortedIndex::lowerBound", queries, [&] {
+		for(std::size_t i = 0; i < queries; i++)
+		{
+			out[i] = index.lowerBound(keys[i]);
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Lower bound, SortedIndex::lowerBounds batch", queries, [&] {
+		index.lowerBounds(keys, out);
+		Bench::ClobberMemory();
+	});
+
+	// "All readings between 3 km and 5 km", with a narrow band so the
+	// search rather than the copy of the rows dominates
+	constexpr std::size_t scans = 16;
+	Bench::Run("Range 3-3.001 km, linear scan (per query)", scans, [&] {
+		for(std::size_t q = 0; q < scans; q++)
+		{
+			std::size_t matches = 0;
+			for(std::size_t i = 0; i < count; i++)
+			{
+				matches += altitudes[i] >= Meters(3000) && altitudes[i] <= Meters(3001);
+			}
+			Bench::DoNotOptimize(matches);
+		}
+	});
+	Bench::Run("Range 3-3.001 km, SortedIndex::between (per query)", scans, [&] {
+		for(std::size_t q = 0; q < scans; q++)
+		{
+			Bench::DoNotOptimize(index.between(Kilometers(3), Kilometers(3.001f)).size());
+		}
+	});
+}
@@ -0,0 +1,67 @@
+#include <vector>
+
+#include "../mesilut.h"
+#include "../mesimath.h"
+#include "bench.h"
+
+namespace {
+	/**
+	 * The Clausius-Clapeyron equation for water, referenced to its boiling
+	 * point
+	 */
+	Mesi::Pascals VapourPressure(Mesi::Kelvin t)
+	{
+		Mesi::Kelvin const boiling(373.15f);
+		Mesi::Kelvin const latent(4883.f);
+		return Mesi::Pascals(101325.f) * std::exp(latent / boiling - latent / t);
+	}
+}
+
+Bench_Case(bench_lut) {
+	using Interpolation = Mesi::LutInterpolation;
+	constexpr std::size_t count = 1 << 20;
+	std::vector<Mesi::Kelvin> temperatures(count);
+	for(std::size_t i = 0; i < count; i++)
+	{
+		temperatures[i] = Mesi::Kelvin(273.f + float((i * 7919) % count) * (100.f / count));
+	}
+	std::vector<Mesi::Pascals> pressures(count);
+
+	auto linear = Mesi::Lut<Mesi::Kelvin, Mesi::Pascals>::sample(VapourPressure, Mesi::Kelvin(273), Mesi::Kelvin(373), 1024);
+	auto cubic = Mesi::Lut<Mesi::Kelvin, Mesi::Pascals, Interpolation::Cubic>::sample(VapourPressure, Mesi::Kelvin(273), Mesi::Kelvin(373), 256);
+	std::vector<Mesi::Kelvin> knots;
+	for(float t = 273; t < 373; t += 2 + (t - 273) / 20)
+	{
+		knots.push_back(Mesi::Kelvin(t));
+	}
+	knots.push_back(Mesi::Kelvin(373));
+	auto nonUniform = Mesi::Lut<Mesi::Kelvin, Mesi::Pascals, Interpolation::Cubic>::sample(VapourPressure, knots);
+
+	Bench::Run("Vapour pressure via std::exp", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			pressures[i] = VapourPressure(temperatures[i]);
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Lut, linear, one at a time", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			pressures[i] = linear(temperatures[i]);
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Lut, linear, batch", count, [&] {
+		linear(temperatures, pressures);
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Lut, cubic, batch", count, [&] {
+		cubic(temperatures, pressures);
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Lut, cubic, non-uniform, batch", count, [&] {
+		nonUniform(temperatures, pressures);
+		Bench::ClobberMemory();
+	});
+	Bench::DoNotOptimize(pressures[count / 2]);
+}
@@ -0,0 +1,16 @@
+#include <cstdio>
+#include <cstring>
+
+#include "bench.h"
+
+int main(int argc, char** argv) {
+	char const* filter = argc > 1 ? argv[1] : nullptr;
+	for(auto const& c : Bench::Cases())
+	{
+		if(filter && std::strstr(c.name, filter) == nullptr)
+			continue;
+		std::printf("%s\n", c.name);
+		c.run();
+	}
+	return 0;
+}
@@ -0,0 +1,67 @@
+#include <vector>
+
+#include "../mesipoly.h"
+#include "bench.h"
+
+Bench_Case(bench_polynomial) {
+	using Ohms = decltype(Mesi::Volts{} / Mesi::Amperes{});
+	using Rtd = Mesi::Polynomial<Mesi::Kelvin, Ohms, 3>;
+	constexpr std::size_t count = 1 << 20;
+	Rtd const rtd(Ohms(100), Rtd::Coefficient<1>(0.39083f), Rtd::Coefficient<2>(-5.775e-5f), Rtd::Coefficient<3>(-4.183e-10f));
+	float const raw[] = {100, 0.39083f, -5.775e-5f, -4.183e-10f};
+
+	std::vector<Mesi::Kelvin> temperatures(count);
+	for(std::size_t i = 0; i < count; i++)
+	{
+		temperatures[i] = Mesi::Kelvin(float(i % 1000) * 0.5f - 200);
+	}
+	std::vector<Ohms> resistances(count);
+	std::vector<float> raw_resistances(count);
+
+	Bench::Run("Cubic, raw float Horner loop", count, [&] {
+		float const* in = Mesi::view_as<float>(Mesi::Span<Mesi::Kelvin const>(temperatures)).data();
+		float* out = raw_resistances.data();
+		for(std::size_t i = 0; i < count; i++)
+		{
+			float const x = in[i];
+			out[i] = raw[0] + x * (raw[1] + x * (raw[2] + x * raw[3]));
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Cubic, Polynomial one at a time", count, [&] {
+		for(std::size_t i = 0; i < count; i++)
+		{
+			resistances[i] = rtd(temperatures[i]);
+		}
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Cubic, Polynomial batch", count, [&] {
+		rtd(temperatures, resistances);
+		Bench::ClobberMemory();
+	});
+
+	// A chain where each result feeds the next input, so latency counts
+	auto const s = [](float v) { return Mesi::Scalar(v); };
+	auto const series = Mesi::make_polynomial<Mesi::Scalar>(s(0.5f), s(0.25f), s(-0.125f), s(0.0625f),
+		s(-0.03125f), s(0.015625f), s(-0.0078125f), s(0.00390625f), s(-0.001953125f),
+		s(0.0009765625f), s(-0.00048828125f), s(0.000244140625f));
+	constexpr std::size_t steps = 1 << 20;
+	Bench::Run("Degree 11 chain, Horner", steps, [&] {
+		Mesi::Scalar x(0.1f);
+		for(std::size_t i = 0; i < steps; i++)
+		{
+			x = series(x);
+		}
+		Bench::DoNotOptimize(x);
+	});
+	Bench::Run("Degree 11 chain, Estrin", steps, [&] {
+		Mesi::Scalar x(0.1f);
+		for(std::size_t i = 0; i < steps; i++)
+		{
+			x = series.estrin(x);
+		}
+		Bench::DoNotOptimize(x);
+	});
+	Bench::DoNotOptimize(resistances[count / 2]);
+	Bench::DoNotOptimize(raw_resistances[count / 2]);
+}
@@ -0,0 +1,59 @@
+#include <cmath>
+#include <vector>
+
+#include "../mesitype.h"
+#include "bench.h"
+
+namespace {
+	constexpr std::size_t c_count = 1 << 14;
+
+	std::vector<Mesi::Meters> Inputs()
+	{
+		std::vector<Mesi::Meters> ret;
+		for(std::size_t i = 0; i < c_count; i++)
+		{
+			ret.push_back(Mesi::Meters(1.f + float(i % 1000) / 100.f));
+		}
+		return ret;
+	}
+
+	/**
+	 * Times Mesi::pow<t_ratio> against std::pow with the same exponent on
+	 * the raw values
+	 */
+	template<intmax_t t_num, intmax_t t_den>
+	void Compare(char const* mesiName, char const* stdName)
+	{
+		auto in = Inputs();
+		using Out = decltype(Mesi::pow<std::ratio<t_num, t_den>>(in[0]));
+		std::vector<Out> out(c_count);
+		std::vector<float> rawOut(c_count);
+
+		Bench::Run(mesiName, c_count, [&] {
+			for(std::size_t i = 0; i < c_count; i++)
+			{
+				out[i] = Mesi::pow<std::ratio<t_num, t_den>>(in[i]);
+			}
+			Bench::ClobberMemory();
+		});
+		Bench::Run(stdName, c_count, [&] {
+			for(std::size_t i = 0; i < c_count; i++)
+			{
+				rawOut[i] = std::pow(in[i].val, float(t_num) / float(t_den));
+			}
+			Bench::ClobberMemory();
+		});
+	}
+}
+
+Bench_Case(bench_pow) {
+	Compare<2, 1>("Mesi::pow<2>", "std::pow(x, 2)");
+	Compare<3, 1>("Mesi::pow<3>", "std::pow(x, 3)");
+	Compare<-1, 1>("Mesi::pow<-1>", "std::pow(x, -1)");
+	Compare<1, 2>("Mesi::pow<1/2>", "std::pow(x, 1/2)");
+	Compare<1, 3>("Mesi::pow<1/3>", "std::pow(x, 1/3)");
+	Compare<3, 2>("Mesi::pow<3/2>", "std::pow(x, 3/2)");
+	Compare<-1, 2>("Mesi::pow<-1/2>", "std::pow(x, -1/2)");
+	Compare<5, 4>("Mesi::pow<5/4>", "std::pow(x, 5/4)");
+	Compare<2, 5>("Mesi::pow<2/5> (fallback)", "std::pow(x, 2/5)");
+}
@@ -0,0 +1,51 @@
+#include <vector>
+
+#include "../mesiquantized.h"
+#include "bench.h"
+
+Bench_Case(bench_quantized) {
+	using Volts8 = Mesi::Quantized<Mesi::Volts, uint8_t, std::ratio<0>, std::ratio<5>>;
+	using Volts16 = Mesi::Quantized<Mesi::Volts, uint16_t, std::ratio<0>, std::ratio<5>>;
+	constexpr std::size_t count = 1 << 24;
+	std::vector<Mesi::Volts> volts(count);
+	for(std::size_t i = 0; i < count; i++)
+	{
+		volts[i] = Mesi::Volts(float(i % 5000) * 1e-3f);
+	}
+	std::vector<Volts8> volts8(count);
+	std::vector<Volts16> volts16(count);
+	std::vector<Mesi::Volts> decoded(count);
+
+	Bench::Run("Quantized<uint8_t>::encode (bulk)", count, [&] {
+		Volts8::encode(volts, volts8);
+		Bench::ClobberMemory();
+	});
+	Bench::Run("Quantized<uint8_t>::decode (bulk)", count, [&] {
+		Volts8::decode(volts8, decoded);
+		Bench::ClobberMemory();
+	});
+	Volts16::encode(volts, volts16);
+
+	// A bandwidth-bound pass over the whole array, as float and quantized
+	Bench::Run("Sum of float Volts", count, [&] {
+		Mesi::Volts sum[8] = {};
+		for(std::size_t i = 0; i < count; i += 8)
+			for(std::size_t j = 0; j < 8; j++)
+				sum[j] += volts[i + j];
+		Bench::DoNotOptimize(sum);
+	});
+	Bench::Run("Sum of Quantized<uint16_t> Volts", count, [&] {
+		Mesi::Volts sum[8] = {};
+		for(std::size_t i = 0; i < count; i += 8)
+			for(std::size_t j = 0; j < 8; j++)
+				sum[j] += volts16[i + j].decode();
+		Bench::DoNotOptimize(sum);
+	});
+	Bench::Run("Sum of Quantized<uint8_t> Volts", count, [&] {
+		Mesi::Volts sum[8] = {};
+		for(std::size_t i = 0; i < count; i += 8)
+			for(std::size_t j = 0; j < 8; j++)
+				sum[j] += volts8[i + j].decode();
+		Bench::DoNotOptimize(sum);
+	});
+}
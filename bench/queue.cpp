@@ -0,0 +1,152 @@
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../mesiqueue.h"
+#include "bench.h"
+
+namespace {
+	using Volts = Mesi::Type<float, 2, -3, 1, -1>;
+	constexpr std::size_t c_count = 1 << 20;
+	constexpr std::size_t c_batch = 256;
+
+	/**
+	 * Times moving c_count values from a producer thread to this thread.
+	 * Both sides yield when the queue is full or empty, which matters on
+	 * machines with fewer cores than threads.
+	 */
+	template<typename Push, typename Pop>
+	void Transfer(char const* name, Push&& push, Pop&& pop)
+	{
+		Bench::Run(name, c_count, [&] {
+			std::thread producer([&] {
+				for(std::size_t sent = 0; sent < c_count;)
+				{
+					std::size_t const n = push(sent);
+					if(n == 0)
+					{
+						std::this_thread::yield();
+					}
+					sent += n;
+				}
+			});
+			for(std::size_t received = 0; received < c_count;)
+			{
+				std::size_t const n = pop();
+				if(n == 0)
+				{
+					std::this_thread::yield();
+				}
+				received += n;
+			}
+			producer.join();
+		});
+	}
+}
+
+Bench_Case(bench_queue) {
+	std::vector<Volts> samples(c_count);
+	for(std::size_t i = 0; i < c_count; i++)
+	{
+		samples[i] = Volts(float(i % 1000) * 0.01f);
+	}
+	std::vector<Volts> block(c_batch);
+	float sum = 0;
+
+	std::mutex mutex;
+	std::deque<float> deque;
+	Transfer("Throughput, mutex and std::deque<float>", [&](std::size_t const i) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if(deque.size() >= 4096)
+		{
+			return std::size_t(0);
+		}
+		deque.push_back(samples[i].val);
+		return std::size_t(1);
+	}, [&] {
+		std::lock_guard<std::mutex> lock(mutex);
+		if(deque.empty())
+		{
+			return std::size_t(0);
+		}
+		sum += deque.front();
+		deque.pop_front();
+		return std::size_t(1);
+	});
+
+	Mesi::SpscQueue<Volts> spsc(4096);
+	Transfer("Throughput, SpscQueue one at a time", [&](std::size_t const i) {
+		return std::size_t(spsc.push(samples[i]));
+	}, [&] {
+		Volts v;
+		if(!spsc.pop(v))
+		{
+			return std::size_t(0);
+		}
+		sum += v.val;
+		return std::size_t(1);
+	});
+	Transfer("Throughput, SpscQueue batches of 256", [&](std::size_t const i) {
+		return spsc.push(Mesi::Span<Volts const>(samples).subspan(i, c_batch));
+	}, [&] {
+		std::size_t const n = spsc.pop(block);
+		for(std::size_t j = 0; j < n; j++)
+		{
+			sum += block[j].val;
+		}
+		return n;
+	});
+
+	Mesi::MpscQueue<Volts> mpsc(4096);
+	Transfer("Throughput, MpscQueue one at a time", [&](std::size_t const i) {
+		return std::size_t(mpsc.push(samples[i]));
+	}, [&] {
+		Volts v;
+		if(!mpsc.pop(v))
+		{
+			return std::size_t(0);
+		}
+		sum += v.val;
+		return std::size_t(1);
+	});
+	Transfer("Throughput, MpscQueue batches of 256", [&](std::size_t const i) {
+		return mpsc.push(Mesi::Span<Volts const>(samples).subspan(i, c_batch));
+	}, [&] {
+		std::size_t const n = mpsc.pop(block);
+		for(std::size_t j = 0; j < n; j++)
+		{
+			sum += block[j].val;
+		}
+		return n;
+	});
+	Bench::DoNotOptimize(sum);
+
+	// Latency as a round trip through a pair of queues. With fewer cores
+	// than threads this measures the scheduler rather than the queue.
+	constexpr std::size_t trips = 1 << 12;
+	Mesi::SpscQueue<Volts> ping(16), pong(16);
+	Bench::Run("Latency, SpscQueue round trip", trips, [&] {
+		std::thread echo([&] {
+			Volts v;
+			for(std::size_t i = 0; i < trips; i++)
+			{
+				while(!ping.pop(v))
+				{
+					std::this_thread::yield();
+				}
+				pong.push(v);
+			}
+		});
+		Volts v;
+		for(std::size_t i = 0; i < trips; i++)
+		{
+			ping.push(samples[i]);
+			while(!pong.pop(v))
+			{
+				std::this_thread::yield();
+			}
+		}
+		echo.join();
+	});
+}
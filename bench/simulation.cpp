@@ -0,0 +1,96 @@
+#include <cstddef>
+
+#include "simulation.h"
+#include "bench.h"
+
+namespace {
+	constexpr std::size_t c_bodies = 1024;
+	constexpr std::size_t c_links = 1 << 16;
+	constexpr int c_steps = 10;
+
+	/**
+	 * Times `steps` calls of step(), reporting steps per second and, where
+	 * the counters are available, cache misses per step
+	 */
+	template<typename F>
+	void RunSteps(char const* name, F&& step)
+	{
+		double const ns = Bench::Time([&] {
+			for(int s = 0; s < c_steps; s++)
+			{
+				step();
+			}
+			Bench::ClobberMemory();
+		});
+		Bench::Report(name, 1e9 * c_steps / ns, "steps/s");
+
+		Bench::CacheMisses counter;
+		unsigned long long const misses = counter.count([&] {
+			for(int s = 0; s < c_steps; s++)
+			{
+				step();
+			}
+			Bench::ClobberMemory();
+		});
+		if(counter.available())
+		{
+			Bench::Report(name, double(misses) / c_steps, "misses/step");
+		}
+	}
+}
+
+Bench_Case(bench_simulation) {
+	using namespace Simulation;
+
+	// A cold disc of bodies a few thousand kilometres across
+	Typed::Bodies bodies;
+	Raw::Bodies raw_bodies;
+	bodies.resize(c_bodies);
+	raw_bodies.resize(c_bodies);
+	for(std::size_t i = 0; i < c_bodies; i++)
+	{
+		float const angle = 0.618034f * 6.2831853f * float(i);
+		float const radius = 1e6f * float(1 + i % 97);
+		bodies.x[i] = Mesi::Meters(radius * std::cos(angle));
+		bodies.y[i] = Mesi::Meters(radius * std::sin(angle));
+		bodies.z[i] = Mesi::Meters(1e4f * float(i % 13));
+		bodies.mass[i] = Mesi::Kilograms(1e20f * float(1 + i % 5));
+		raw_bodies.x[i] = bodies.x[i].val;
+		raw_bodies.y[i] = bodies.y[i].val;
+		raw_bodies.z[i] = bodies.z[i].val;
+		raw_bodies.mass[i] = bodies.mass[i].val;
+	}
+	Mesi::Seconds const dt(10);
+	RunSteps("N-body 1024, raw float", [&] {
+		Raw::GravityStep(raw_bodies, dt.val);
+	});
+	RunSteps("N-body 1024, Mesi types", [&] {
+		Typed::GravityStep(bodies, dt);
+	});
+
+	// A hanging chain of 10 g beads on stiff springs, released horizontally
+	Typed::Chain chain;
+	Raw::Chain raw_chain;
+	chain.resize(c_links);
+	raw_chain.resize(c_links);
+	chain.mass.assign(c_links, Mesi::Grams(10));
+	chain.rest = Mesi::Meters(0.01f);
+	chain.stiffness = Typed::Stiffness(500);
+	chain.damping = Typed::Damping(0.05f);
+	raw_chain.mass.assign(c_links, 10);
+	raw_chain.rest = chain.rest.val;
+	raw_chain.stiffness = chain.stiffness.val;
+	raw_chain.damping = chain.damping.val;
+	for(std::size_t i = 0; i < c_links; i++)
+	{
+		chain.x[i] = Mesi::Meters(0.01f * float(i));
+		raw_chain.x[i] = chain.x[i].val;
+	}
+	Mesi::Seconds const spring_dt(1e-5f);
+	RunSteps("Spring chain 65536, raw float", [&] {
+		Raw::SpringStep(raw_chain, spring_dt.val);
+	});
+	RunSteps("Spring chain 65536, Mesi types", [&] {
+		Typed::SpringStep(chain, spring_dt);
+	});
+}
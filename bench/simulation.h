@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "../mesitype.h"
+#include "../mesimath.h"
+
+/**
+ * Application-level workloads, written once against Mesi types and once
+ * against raw floats with the same operations in the same order, so the
+ * difference between them is the overhead of the quantity types in a
+ * realistic chain of `auto` intermediates, scale conversions and mesimath
+ * calls. Used by simulation.cpp and binsize.sh.
+ */
+namespace Simulation {
+	constexpr float c_gravitational = 6.674e-11f;
+	constexpr float c_softening = 1e3f;
+	constexpr float c_gravity = 9.81f;
+
+	namespace Typed {
+		using Speed = decltype(Mesi::Meters{} / Mesi::Seconds{});
+		using Acceleration = decltype(Speed{} / Mesi::Seconds{});
+		using Gravitational = decltype(Mesi::MetersCu{} / Mesi::Kilograms{} / Mesi::Seconds{} / Mesi::Seconds{});
+		using Stiffness = decltype(Mesi::Newtons{} / Mesi::Meters{});
+		using Damping = decltype(Mesi::Newtons{} / Speed{});
+
+		struct Bodies
+		{
+			std::vector<Mesi::Meters> x, y, z;
+			std::vector<Speed> vx, vy, vz;
+			std::vector<Acceleration> ax, ay, az;
+			std::vector<Mesi::Kilograms> mass;
+
+			void resize(std::size_t const n)
+			{
+				x.resize(n);
+				y.resize(n);
+				z.resize(n);
+				vx.resize(n);
+				vy.resize(n);
+				vz.resize(n);
+				ax.resize(n);
+				ay.resize(n);
+				az.resize(n);
+				mass.resize(n);
+			}
+		};
+
+		/**
+		 * One step of direct-sum gravity over all pairs, with softening, then
+		 * a semi-implicit Euler update
+		 */
+		inline void GravityStep(Bodies& b, Mesi::Seconds const dt)
+		{
+			Gravitational const g(c_gravitational);
+			Mesi::MetersSq const softening(c_softening * c_softening);
+			std::size_t const n = b.mass.size();
+			for(std::size_t i = 0; i < n; i++)
+			{
+				Acceleration ax(0), ay(0), az(0);
+				for(std::size_t j = 0; j < n; j++)
+				{
+					auto const dx = b.x[j] - b.x[i];
+					auto const dy = b.y[j] - b.y[i];
+					auto const dz = b.z[j] - b.z[i];
+					auto const r2 = dx * dx + dy * dy + dz * dz + softening;
+					auto const r = std::sqrt(r2);
+					auto const s = g * b.mass[j] / (r2 * r);
+					ax += s * dx;
+					ay += s * dy;
+					az += s * dz;
+				}
+				b.ax[i] = ax;
+				b.ay[i] = ay;
+				b.az[i] = az;
+			}
+			for(std::size_t i = 0; i < n; i++)
+			{
+				b.vx[i] += b.ax[i] * dt;
+				b.vy[i] += b.ay[i] * dt;
+				b.vz[i] += b.az[i] * dt;
+				b.x[i] += b.vx[i] * dt;
+				b.y[i] += b.vy[i] * dt;
+				b.z[i] += b.vz[i] * dt;
+			}
+		}
+
+		struct Chain
+		{
+			std::vector<Mesi::Meters> x, y;
+			std::vector<Speed> vx, vy;
+			std::vector<Mesi::Newtons> fx, fy;
+			std::vector<Mesi::Grams> mass;
+			Mesi::Meters rest;
+			Stiffness stiffness;
+			Damping damping;
+
+			void resize(std::size_t const n)
+			{
+				x.resize(n);
+				y.resize(n);
+				vx.resize(n);
+				vy.resize(n);
+				fx.resize(n);
+				fy.resize(n);
+				mass.resize(n);
+			}
+		};
+
+		/**
+		 * One step of a hanging chain of damped springs in 2D, pinned at the
+		 * first mass. Masses are stored in grams, so every step converts them.
+		 */
+		inline void SpringStep(Chain& c, Mesi::Seconds const dt)
+		{
+			Acceleration const gravity(c_gravity);
+			std::size_t const n = c.mass.size();
+			for(std::size_t i = 0; i < n; i++)
+			{
+				c.fx[i] = Mesi::Newtons(0);
+				c.fy[i] = -gravity * Mesi::Kilograms(c.mass[i]);
+			}
+			for(std::size_t i = 0; i + 1 < n; i++)
+			{
+				auto const dx = c.x[i + 1] - c.x[i];
+				auto const dy = c.y[i + 1] - c.y[i];
+				auto const length = std::hypot(dx, dy);
+				auto const closing = ((c.vx[i + 1] - c.vx[i]) * dx + (c.vy[i + 1] - c.vy[i]) * dy) / length;
+				Mesi::Newtons const tension = c.stiffness * (length - c.rest) + c.damping * closing;
+				auto const fx = tension * (dx / length);
+				auto const fy = tension * (dy / length);
+				c.fx[i] += fx;
+				c.fy[i] += fy;
+				c.fx[i + 1] -= fx;
+				c.fy[i + 1] -= fy;
+			}
+			for(std::size_t i = 1; i < n; i++)
+			{
+				auto const inverse = Mesi::Scalar(1) / Mesi::Kilograms(c.mass[i]);
+				c.vx[i] += c.fx[i] * inverse * dt;
+				c.vy[i] += c.fy[i] * inverse * dt;
+				c.x[i] += c.vx[i] * dt;
+				c.y[i] += c.vy[i] * dt;
+			}
+		}
+	}
+
+	namespace Raw {
+		struct Bodies
+		{
+			std::vector<float> x, y, z;
+			std::vector<float> vx, vy, vz;
+			std::vector<float> ax, ay, az;
+			std::vector<float> mass;
+
+			void resize(std::size_t const n)
+			{
+				for(auto* v : {&x, &y, &z, &vx, &vy, &vz, &ax, &ay, &az, &mass})
+				{
+					v->resize(n);
+				}
+			}
+		};
+
+		inline void GravityStep(Bodies& b, float const dt)
+		{
+			float const g = c_gravitational;
+			float const softening = c_softening * c_softening;
+			std::size_t const n = b.mass.size();
+			for(std::size_t i = 0; i < n; i++)
+			{
+				float ax = 0, ay = 0, az = 0;
+				for(std::size_t j = 0; j < n; j++)
+				{
+					float const dx = b.x[j] - b.x[i];
+					float const dy = b.y[j] - b.y[i];
+					float const dz = b.z[j] - b.z[i];
+					float const r2 = dx * dx + dy * dy + dz * dz + softening;
+					float const r = std::sqrt(r2);
+					float const s = g * b.mass[j] / (r2 * r);
+					ax += s * dx;
+					ay += s * dy;
+					az += s * dz;
+				}
+				b.ax[i] = ax;
+				b.ay[i] = ay;
+				b.az[i] = az;
+			}
+			for(std::size_t i = 0; i < n; i++)
+			{
+				b.vx[i] += b.ax[i] * dt;
+				b.vy[i] += b.ay[i] * dt;
+				b.vz[i] += b.az[i] * dt;
+				b.x[i] += b.vx[i] * dt;
+				b.y[i] += b.vy[i] * dt;
+				b.z[i] += b.vz[i] * dt;
+			}
+		}
+
+		struct Chain
+		{
+			std::vector<float> x, y;
+			std::vector<float> vx, vy;
+			std::vector<float> fx, fy;
+			std::vector<float> mass;
+			float rest;
+			float stiffness;
+			float damping;
+
+			void resize(std::size_t const n)
+			{
+				for(auto* v : {&x, &y, &vx, &vy, &fx, &fy, &mass})
+				{
+					v->resize(n);
+				}
+			}
+		};
+
+		inline void SpringStep(Chain& c, float const dt)
+		{
+			float const gravity = c_gravity;
+			std::size_t const n = c.mass.size();
+			for(std::size_t i = 0; i < n; i++)
+			{
+				c.fx[i] = 0;
+				c.fy[i] = -gravity * (c.mass[i] * 0.001f);
+			}
+			for(std::size_t i = 0; i + 1 < n; i++)
+			{
+				float const dx = c.x[i + 1] - c.x[i];
+				float const dy = c.y[i + 1] - c.y[i];
+				float const length = std::sqrt(dx * dx + dy * dy);
+				float const closing = ((c.vx[i + 1] - c.vx[i]) * dx + (c.vy[i + 1] - c.vy[i]) * dy) / length;
+				float const tension = c.stiffness * (length - c.rest) + c.damping * closing;
+				float const fx = tension * (dx / length);
+				float const fy = tension * (dy / length);
+				c.fx[i] += fx;
+				c.fy[i] += fy;
+				c.fx[i + 1] -= fx;
+				c.fy[i + 1] -= fy;
+			}
+			for(std::size_t i = 1; i < n; i++)
+			{
+				float const inverse = 1.0f / (c.mass[i] * 0.001f);
+				c.vx[i] += c.fx[i] * inverse * dt;
+				c.vy[i] += c.fy[i] * inverse * dt;
+				c.x[i] += c.vx[i] * dt;
+				c.y[i] += c.vy[i] * dt;
+			}
+		}
+	}
+}
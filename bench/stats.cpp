@@ -0,0 +1,32 @@
+#include <vector>
+
+#include "../mesistats.h"
+#include "bench.h"
+
+Bench_Case(bench_statistics) {
+	constexpr std::size_t count = 1 << 20;
+	std::vector<Mesi::Kelvin> samples;
+	for(std::size_t i = 0; i < count; i++)
+	{
+		samples.push_back(Mesi::Kelvin(250.f + float(i % 997) * 0.1f));
+	}
+
+	Bench::Run("Statistics::add, one sample at a time", count, [&] {
+		Mesi::Statistics<Mesi::Kelvin> stats;
+		for(auto const& s : samples)
+		{
+			stats.add(s);
+		}
+		Bench::DoNotOptimize(stats);
+	});
+	Bench::Run("Statistics::add, one batch", count, [&] {
+		Mesi::Statistics<Mesi::Kelvin> stats;
+		stats.add(samples);
+		Bench::DoNotOptimize(stats);
+	});
+	Bench::Run("QuantileSketch::add", count, [&] {
+		Mesi::QuantileSketch<Mesi::Kelvin> sketch;
+		sketch.add(samples);
+		Bench::DoNotOptimize(sketch);
+	});
+}
@@ -0,0 +1,83 @@
+#!/bin/sh
+# Compiles kernels.cpp, disassembles it, and checks that each mesi_<name>
+# kernel has exactly the instructions of its raw_<name> partner. Prints a
+# diff for each pair that differs and exits with 1 if any do.
+#
+# Kernels with the same instructions in a different order are reported, but
+# only fail with STRICT=1: a struct local (like a Mesi accumulator) can be
+# scheduled differently from a plain one by the compiler, whatever its
+# operators do.
+#
+# Usage: [STRICT=1] compare.sh <compiler> [flags...]
+
+set -e
+
+CXX=$1
+shift
+ROOT=$(cd "$(dirname "$0")" && pwd)
+OBJDUMP=${OBJDUMP:-objdump}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# Each function in its own section, so jump targets are relative to it
+$CXX -std=c++14 -ffunction-sections "$@" -c "$ROOT/kernels.cpp" -o "$WORK/kernels.o"
+
+# One file per function, holding its instructions without addresses,
+# symbol annotations or comments, and the relocations they use
+$OBJDUMP -dr --no-show-raw-insn -C "$WORK/kernels.o" | awk -v dir="$WORK" '
+	/^[0-9a-f]+ <.*>:$/ {
+		name = $0
+		sub(/^[0-9a-f]+ </, "", name)
+		sub(/\(.*$/, "", name)
+		file = dir "/" name ".s"
+		next
+	}
+	file == "" { next }
+	/^\t\t\t *[0-9a-f]+: R_/ {
+		sub(/^\t\t\t *[0-9a-f]+: /, "")
+		gsub(/\t/, " ")
+		print "        " $0 > file
+		next
+	}
+	/^ *[0-9a-f]+:\t/ {
+		sub(/^ *[0-9a-f]+:\t/, "")
+		sub(/ *#.*$/, "")
+		sub(/ <.*>$/, "")
+		gsub(/ +/, " ")
+		print "    " $0 > file
+	}
+'
+
+failures=0
+reordered=0
+pairs=0
+for mesi in "$WORK"/mesi_*.s; do
+	name=$(basename "$mesi" .s)
+	name=${name#mesi_}
+	raw=$WORK/raw_$name.s
+	pairs=$((pairs + 1))
+	if [ ! -f "$raw" ]; then
+		printf '  %-28s no raw_%s to compare with\n' "$name" "$name"
+		failures=$((failures + 1))
+	elif cmp -s "$mesi" "$raw"; then
+		printf '  %-28s same (%d instructions)\n' "$name" "$(grep -vc '^        ' "$mesi")"
+	elif [ -z "$STRICT" ] && [ "$(sort "$mesi")" = "$(sort "$raw")" ]; then
+		printf '  %-28s same instructions in a different order\n' "$name"
+		reordered=$((reordered + 1))
+		diff -u --label "mesi_$name" --label "raw_$name" "$mesi" "$raw" | sed 's/^/      /' || true
+	else
+		printf '  %-28s DIFFERENT\n' "$name"
+		diff -u --label "mesi_$name" --label "raw_$name" "$mesi" "$raw" | sed 's/^/      /' || true
+		failures=$((failures + 1))
+	fi
+done
+
+if [ "$failures" -ne 0 ]; then
+	echo "  $failures of $pairs kernels differ with $CXX $*"
+	exit 1
+fi
+if [ "$reordered" -ne 0 ]; then
+	echo "  All $pairs kernels match with $CXX $*, $reordered in a different order"
+else
+	echo "  All $pairs kernels match with $CXX $*"
+fi
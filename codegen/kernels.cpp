@@ -0,0 +1,141 @@
+/*
+ * Pairs of kernels, mesi_<name> using Mesi types and raw_<name> doing the
+ * same with the storage type, which compare.sh checks compile to the same
+ * instructions. Every mesi_ kernel needs a raw_ partner.
+ */
+#include <cstddef>
+
+#include "../mesitype.h"
+
+using namespace Mesi::Literals;
+using Mesi::Meters;
+using Mesi::Seconds;
+using Speed = decltype(Meters{} / Seconds{});
+using MetersD = Mesi::Type<double, 1, 0, 0>;
+using Count = Mesi::Type<int, 0, 0, 0, 0, 0, 1>;
+
+/*
+ * Arithmetic operators
+ */
+Meters mesi_add(Meters a, Meters b) { return a + b; }
+float raw_add(float a, float b) { return a + b; }
+
+Meters mesi_subtract(Meters a, Meters b) { return a - b; }
+float raw_subtract(float a, float b) { return a - b; }
+
+Mesi::MetersSq mesi_multiply(Meters a, Meters b) { return a * b; }
+float raw_multiply(float a, float b) { return a * b; }
+
+Speed mesi_divide(Meters a, Seconds b) { return a / b; }
+float raw_divide(float a, float b) { return a / b; }
+
+Meters mesi_negate(Meters a) { return -a; }
+float raw_negate(float a) { return -a; }
+
+MetersD mesi_add_double(MetersD a, MetersD b) { return a + b; }
+double raw_add_double(double a, double b) { return a + b; }
+
+Count mesi_multiply_int(Count a, Count b) { return a * b.val; }
+int raw_multiply_int(int a, int b) { return a * b; }
+
+void mesi_add_assign(Meters* a, Meters b) { *a += b; }
+void raw_add_assign(float* a, float b) { *a += b; }
+
+/*
+ * Scalar overloads
+ */
+Meters mesi_scale_left(float k, Meters a) { return k * a; }
+float raw_scale_left(float k, float a) { return k * a; }
+
+Meters mesi_scale_right(Meters a, float k) { return a * k; }
+float raw_scale_right(float a, float k) { return a * k; }
+
+Meters mesi_divide_by_scalar(Meters a, float k) { return a / k; }
+float raw_divide_by_scalar(float a, float k) { return a / k; }
+
+Meters mesi_scale_by_unitless(Meters a, Mesi::Scalar k) { return a * k; }
+float raw_scale_by_unitless(float a, float k) { return a * k; }
+
+/*
+ * Comparisons
+ */
+bool mesi_less(Meters a, Meters b) { return a < b; }
+bool raw_less(float a, float b) { return a < b; }
+
+bool mesi_greater(Meters a, Meters b) { return a > b; }
+bool raw_greater(float a, float b) { return a > b; }
+
+bool mesi_less_equal(Meters a, Meters b) { return a <= b; }
+bool raw_less_equal(float a, float b) { return a <= b; }
+
+bool mesi_greater_equal(Meters a, Meters b) { return a >= b; }
+bool raw_greater_equal(float a, float b) { return a >= b; }
+
+bool mesi_not_equal(Meters a, Meters b) { return a != b; }
+bool raw_not_equal(float a, float b) { return a != b; }
+
+bool mesi_less_double(MetersD a, MetersD b) { return a < b; }
+bool raw_less_double(double a, double b) { return a < b; }
+
+/*
+ * Literals
+ */
+Meters mesi_add_literal(Meters a) { return a + 1.5_m; }
+float raw_add_literal(float a) { return a + 1.5f; }
+
+Speed mesi_literal_speed(Meters a) { return a / 2_s; }
+float raw_literal_speed(float a) { return a / 2.f; }
+
+/*
+ * Conversions between prefixes with integer powers of ten
+ */
+Meters mesi_kilo_to_base(Mesi::Kilo<Meters> a) { return Meters(a); }
+float raw_kilo_to_base(float a) { return a * 1000.f; }
+
+Mesi::Milli<Meters> mesi_base_to_milli(Meters a) { return Mesi::Milli<Meters>(a); }
+float raw_base_to_milli(float a) { return a * 1000.f; }
+
+Meters mesi_milli_to_base(Mesi::Milli<Meters> a) { return Meters(a); }
+float raw_milli_to_base(float a) { return a * 0.001f; }
+
+Mesi::Micro<Meters> mesi_milli_to_micro(Mesi::Milli<Meters> a) { return Mesi::Micro<Meters>(a); }
+float raw_milli_to_micro(float a) { return a * 1000.f; }
+
+/*
+ * Loops, which must vectorise the same way
+ */
+Meters mesi_sum(Meters const* a, std::size_t n)
+{
+	Meters total(0);
+	for(std::size_t i = 0; i < n; i++)
+	{
+		total += a[i];
+	}
+	return total;
+}
+
+float raw_sum(float const* a, std::size_t n)
+{
+	float total = 0;
+	for(std::size_t i = 0; i < n; i++)
+	{
+		total += a[i];
+	}
+	return total;
+}
+
+void mesi_integrate(Meters* __restrict position, Speed const* __restrict velocity, Seconds dt, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; i++)
+	{
+		position[i] += velocity[i] * dt;
+	}
+}
+
+void raw_integrate(float* __restrict position, float const* __restrict velocity, float dt, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; i++)
+	{
+		position[i] += velocity[i] * dt;
+	}
+}
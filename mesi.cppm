@@ -0,0 +1,58 @@
+/*
+ * C++20 module interface for mesitype.h and mesimath.h:
+ *
+ *     import mesi;
+ *
+ * The named units (Newtons through Henry) and the decltype chains behind
+ * them are resolved once, when this interface is compiled, rather than in
+ * every translation unit that uses them. MESI_LITERAL_TYPE can't be set by
+ * importers; define it when compiling this file instead.
+ */
+module;
+#include <cmath>
+#include <cstdint>
+#include <ratio>
+#include <string>
+#include <type_traits>
+
+export module mesi;
+
+#define MESI_EXPORT export
+#include "mesitype.h"
+#include "mesimath.h"
+
+/*
+ * Complete the common units here so importers don't instantiate them again
+ */
+#define MESI_INSTANTIATE(name) static_assert(sizeof(Mesi::name) == sizeof(Mesi::name::BaseType), "Failed to instantiate " #name);
+MESI_INSTANTIATE(Scalar)
+MESI_INSTANTIATE(Meters)
+MESI_INSTANTIATE(Seconds)
+MESI_INSTANTIATE(Kilograms)
+MESI_INSTANTIATE(Amperes)
+MESI_INSTANTIATE(Kelvin)
+MESI_INSTANTIATE(Moles)
+MESI_INSTANTIATE(Candela)
+MESI_INSTANTIATE(Minutes)
+MESI_INSTANTIATE(Hours)
+MESI_INSTANTIATE(Grams)
+MESI_INSTANTIATE(Tonnes)
+MESI_INSTANTIATE(Newtons)
+MESI_INSTANTIATE(NewtonsSq)
+MESI_INSTANTIATE(MetersSq)
+MESI_INSTANTIATE(MetersCu)
+MESI_INSTANTIATE(SecondsSq)
+MESI_INSTANTIATE(KilogramsSq)
+MESI_INSTANTIATE(Hertz)
+MESI_INSTANTIATE(Pascals)
+MESI_INSTANTIATE(Joules)
+MESI_INSTANTIATE(Watts)
+MESI_INSTANTIATE(Coulombs)
+MESI_INSTANTIATE(Volts)
+MESI_INSTANTIATE(Farads)
+MESI_INSTANTIATE(Ohms)
+MESI_INSTANTIATE(Siemens)
+MESI_INSTANTIATE(Webers)
+MESI_INSTANTIATE(Tesla)
+MESI_INSTANTIATE(Henry)
+#undef MESI_INSTANTIATE
@@ -0,0 +1,214 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include "mesicore.h"
+
+namespace Mesi {
+	/**
+	 * @brief Lock-free atomic storage for a Mesi quantity
+	 *
+	 * @param Quantity the Mesi type that is stored
+	 *
+	 * Mirrors std::atomic, but only accepts values of Quantity, so
+	 * fetch_add() can't accumulate Coulombs into Joules. std::atomic only
+	 * supports fetch_add on integers before C++20, so for floating-point
+	 * base types it is implemented as a compare-and-swap loop.
+	 */
+	template<typename Quantity>
+	class Atomic
+	{
+	public:
+		using ValueType = Quantity;
+		using BaseType = typename Quantity::BaseType;
+
+		Atomic() = default;
+
+		constexpr explicit Atomic(Quantity const& value)
+			:p_value(value.val)
+		{}
+
+		Atomic(Atomic const&) = delete;
+		Atomic& operator=(Atomic const&) = delete;
+
+		bool is_lock_free() const
+		{
+			return p_value.is_lock_free();
+		}
+
+		Quantity load(std::memory_order order = std::memory_order_seq_cst) const
+		{
+			return Quantity(p_value.load(order));
+		}
+
+		void store(Quantity const& value, std::memory_order order = std::memory_order_seq_cst)
+		{
+			p_value.store(value.val, order);
+		}
+
+		Quantity exchange(Quantity const& value, std::memory_order order = std::memory_order_seq_cst)
+		{
+			return Quantity(p_value.exchange(value.val, order));
+		}
+
+		/**
+		 * Replaces the value with desired if it equals expected, otherwise
+		 * loads the current value into expected. May fail spuriously.
+		 */
+		bool compare_exchange_weak(Quantity& expected, Quantity const& desired,
+			std::memory_order success = std::memory_order_seq_cst,
+			std::memory_order failure = std::memory_order_seq_cst)
+		{
+			return p_value.compare_exchange_weak(expected.val, desired.val, success, failure);
+		}
+
+		/**
+		 * Replaces the value with desired if it equals expected, otherwise
+		 * loads the current value into expected
+		 */
+		bool compare_exchange_strong(Quantity& expected, Quantity const& desired,
+			std::memory_order success = std::memory_order_seq_cst,
+			std::memory_order failure = std::memory_order_seq_cst)
+		{
+			return p_value.compare_exchange_strong(expected.val, desired.val, success, failure);
+		}
+
+		/**
+		 * Adds value and returns the previous value
+		 */
+		Quantity fetch_add(Quantity const& value, std::memory_order order = std::memory_order_seq_cst)
+		{
+			return Quantity(add(value.val, order, std::is_integral<BaseType>()));
+		}
+
+		/**
+		 * Subtracts value and returns the previous value
+		 */
+		Quantity fetch_sub(Quantity const& value, std::memory_order order = std::memory_order_seq_cst)
+		{
+			return Quantity(add(BaseType(-value.val), order, std::is_integral<BaseType>()));
+		}
+
+		Quantity operator+=(Quantity const& value)
+		{
+			return fetch_add(value) + value;
+		}
+
+		Quantity operator-=(Quantity const& value)
+		{
+			return fetch_sub(value) - value;
+		}
+
+	private:
+		BaseType add(BaseType value, std::memory_order order, std::true_type)
+		{
+			return p_value.fetch_add(value, order);
+		}
+
+		BaseType add(BaseType value, std::memory_order order, std::false_type)
+		{
+			BaseType old = p_value.load(std::memory_order_relaxed);
+			while(!p_value.compare_exchange_weak(old, BaseType(old + value), order, std::memory_order_relaxed))
+			{}
+			return old;
+		}
+
+		std::atomic<BaseType> p_value;
+	};
+
+	namespace _internal {
+		/**
+		 * A small number identifying the calling thread, assigned in the
+		 * order threads first ask for it
+		 */
+		inline std::size_t ThreadIndex()
+		{
+			static std::atomic<std::size_t> s_next(0);
+			// Constant-initialised, so reading it needs no guard check
+			static thread_local std::size_t t_index = ~std::size_t(0);
+			if(t_index == ~std::size_t(0))
+			{
+				t_index = s_next.fetch_add(1, std::memory_order_relaxed);
+			}
+			return t_index;
+		}
+	}
+
+	/**
+	 * @brief Counter for a quantity that many threads add to at once
+	 *
+	 * @param Quantity the Mesi type that is accumulated
+	 * @param t_shards the number of separately updated copies
+	 *
+	 * Each thread adds to one of t_shards copies, each on its own cache
+	 * line, so threads don't contend for a single line; load() sums the
+	 * shards. Threads are spread over the shards in the order they first
+	 * use a counter, so with at most t_shards threads no two share one.
+	 *
+	 * Additions are only ordered within a shard, so load() taken while
+	 * other threads are still adding may not match any single point in
+	 * time. Note that C++14 doesn't guarantee the alignment of
+	 * over-aligned types allocated with new, which only affects speed.
+	 */
+	template<typename Quantity, std::size_t t_shards = 16>
+	class ShardedCounter
+	{
+		static_assert(t_shards > 0, "A counter needs at least one shard");
+
+	public:
+		using ValueType = Quantity;
+
+		ShardedCounter()
+		{
+			reset();
+		}
+
+		ShardedCounter(ShardedCounter const&) = delete;
+		ShardedCounter& operator=(ShardedCounter const&) = delete;
+
+		void add(Quantity const& value, std::memory_order order = std::memory_order_relaxed)
+		{
+			p_shards[_internal::ThreadIndex() % t_shards].value.fetch_add(value, order);
+		}
+
+		void sub(Quantity const& value, std::memory_order order = std::memory_order_relaxed)
+		{
+			p_shards[_internal::ThreadIndex() % t_shards].value.fetch_sub(value, order);
+		}
+
+		/**
+		 * The sum of all shards
+		 */
+		Quantity load(std::memory_order order = std::memory_order_seq_cst) const
+		{
+			Quantity sum(typename Quantity::BaseType(0));
+			for(auto const& shard : p_shards)
+			{
+				sum += shard.value.load(order);
+			}
+			return sum;
+		}
+
+		/**
+		 * Sets every shard to zero. Additions made at the same time may be
+		 * lost.
+		 */
+		void reset()
+		{
+			for(auto& shard : p_shards)
+			{
+				shard.value.store(Quantity(typename Quantity::BaseType(0)), std::memory_order_relaxed);
+			}
+		}
+
+	private:
+		static constexpr std::size_t c_cache_line = 64;
+
+		struct alignas(c_cache_line) Shard
+		{
+			Atomic<Quantity> value;
+		};
+
+		Shard p_shards[t_shards];
+	};
+}
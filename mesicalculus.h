@@ -0,0 +1,612 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "mesicore.h"
+#include "mesiparallel.h"
+#include "mesispan.h"
+
+/*
+ * Numerical integration and differentiation of sampled quantities, e.g.
+ * power over time:
+ *
+ *     std::vector<Watts> power = ...;
+ *     std::vector<Seconds> times = ...;
+ *     Joules energy = Mesi::trapezoid(power, times);
+ *
+ * Samples are passed as any contiguous containers (std::vector, arrays,
+ * Spans), with their inputs either as a container of the same length, for
+ * uneven spacing, or as a single spacing. Result types come from the Mesi
+ * operators: the integral of Y over X has the type of Y * X, and the
+ * derivative the type of Y / X.
+ *
+ * The loops are written so compilers can vectorise them. Inputs large
+ * enough to be worth it are split across threads (needs -pthread); pass
+ * `threads` to choose how many, 0 choosing automatically and 1 disabling
+ * threading. Cumulative integrals are prefix sums, which are computed
+ * per chunk then offset by the totals of the chunks before, so results can
+ * differ from a serial sum by rounding.
+ */
+namespace Mesi {
+	namespace _internal {
+		template<typename Y, typename X>
+		using IntegralType = decltype(std::declval<Y>() * std::declval<X>());
+
+		template<typename Y, typename X>
+		using DerivativeType = decltype(std::declval<Y>() / std::declval<X>());
+
+		/**
+		 * Replaces data with its inclusive prefix sum and returns the total.
+		 * A serial sum is a chain of dependent additions, so long inputs
+		 * are split into lanes that are summed in step, interleaved so the
+		 * additions overlap, then each lane is offset by the totals of the
+		 * lanes before it.
+		 */
+		template<typename T>
+		T PrefixSum(T* data, std::size_t n)
+		{
+			constexpr std::size_t c_lanes = 8;
+			if(n < c_lanes * 64)
+			{
+				T sum = T(0);
+				for(std::size_t i = 0; i < n; i++)
+				{
+					sum += data[i];
+					data[i] = sum;
+				}
+				return sum;
+			}
+			// The last lane also takes the remainder
+			std::size_t const len = n / c_lanes;
+			T sums[c_lanes] = {};
+			for(std::size_t j = 0; j < len; j++)
+			{
+				for(std::size_t lane = 0; lane < c_lanes; lane++)
+				{
+					sums[lane] += data[lane * len + j];
+					data[lane * len + j] = sums[lane];
+				}
+			}
+			for(std::size_t i = c_lanes * len; i < n; i++)
+			{
+				sums[c_lanes - 1] += data[i];
+				data[i] = sums[c_lanes - 1];
+			}
+			T offset = T(0);
+			for(std::size_t lane = 1; lane < c_lanes; lane++)
+			{
+				offset += sums[lane - 1];
+				std::size_t const end = lane + 1 < c_lanes ? (lane + 1) * len : n;
+				for(std::size_t i = lane * len; i < end; i++)
+				{
+					data[i] += offset;
+				}
+			}
+			return offset + sums[c_lanes - 1];
+		}
+
+		/**
+		 * Sums f(i) over [begin, end), in several accumulators so that
+		 * compilers can vectorise it without reassociating
+		 */
+		template<typename T, typename F>
+		T Sum(std::size_t begin, std::size_t end, F const& f)
+		{
+			constexpr std::size_t c_lanes = 8;
+			T sums[c_lanes] = {};
+			std::size_t i = begin;
+			for(; i + c_lanes <= end; i += c_lanes)
+			{
+				for(std::size_t lane = 0; lane < c_lanes; lane++)
+				{
+					sums[lane] += f(i + lane);
+				}
+			}
+			for(; i < end; i++)
+			{
+				sums[0] += f(i);
+			}
+			T sum = T(0);
+			for(std::size_t lane = 0; lane < c_lanes; lane++)
+			{
+				sum += sums[lane];
+			}
+			return sum;
+		}
+
+		/*
+		 * The area of each interval, by rule and spacing: interior(i) is
+		 * the area from point i to point i + 1 for any interval but the
+		 * last, and last(i) the area of the last, so the loops over the
+		 * interior have no branches. Each holds copies of the pointers, so
+		 * compilers can see they don't change.
+		 */
+
+		template<typename R, typename YB, typename XB>
+		struct TrapezoidAreas
+		{
+			YB const* y;
+			XB const* x;
+
+			R interior(std::size_t i) const
+			{
+				return R(0.5) * (R(x[i + 1]) - R(x[i])) * (R(y[i]) + R(y[i + 1]));
+			}
+
+			R last(std::size_t i) const
+			{
+				return interior(i);
+			}
+		};
+
+		template<typename R, typename YB>
+		struct UniformTrapezoidAreas
+		{
+			YB const* y;
+			R half_dx;
+
+			R interior(std::size_t i) const
+			{
+				return half_dx * (R(y[i]) + R(y[i + 1]));
+			}
+
+			R last(std::size_t i) const
+			{
+				return interior(i);
+			}
+		};
+
+		/**
+		 * The area under the quadratic through points i, i + 1 and i + 2
+		 * between the first two, for spacings h0 and h1. With the points in
+		 * reverse order it gives the area between the last two.
+		 */
+		template<typename R>
+		inline R QuadraticArea(R y0, R y1, R y2, R h0, R h1)
+		{
+			R const h0_h = h0 / (h0 + h1);
+			R const h0h0_hh1 = h0_h * (h0 / h1);
+			return h0 / R(6) * ((R(3) - h0_h) * y0 + (R(3) + h0h0_hh1 + h0_h) * y1 - h0h0_hh1 * y2);
+		}
+
+		/**
+		 * Each interval uses the next point as its third, except the last,
+		 * which uses the one before
+		 */
+		template<typename R, typename YB, typename XB>
+		struct SimpsonAreas
+		{
+			YB const* y;
+			XB const* x;
+
+			R interior(std::size_t i) const
+			{
+				return QuadraticArea(R(y[i]), R(y[i + 1]), R(y[i + 2]),
+					R(x[i + 1]) - R(x[i]), R(x[i + 2]) - R(x[i + 1]));
+			}
+
+			R last(std::size_t i) const
+			{
+				return i == 0
+					? TrapezoidAreas<R, YB, XB>{y, x}.interior(i)
+					: QuadraticArea(R(y[i + 1]), R(y[i]), R(y[i - 1]),
+						R(x[i + 1]) - R(x[i]), R(x[i]) - R(x[i - 1]));
+			}
+		};
+
+		template<typename R, typename YB>
+		struct UniformSimpsonAreas
+		{
+			YB const* y;
+			R dx_12;
+
+			R interior(std::size_t i) const
+			{
+				return dx_12 * (R(5) * R(y[i]) + R(8) * R(y[i + 1]) - R(y[i + 2]));
+			}
+
+			R last(std::size_t i) const
+			{
+				return i == 0
+					? dx_12 * R(6) * (R(y[0]) + R(y[1]))
+					: dx_12 * (R(5) * R(y[i + 1]) + R(8) * R(y[i]) - R(y[i - 1]));
+			}
+		};
+
+		/**
+		 * The total area of intervals [0, intervals)
+		 */
+		template<typename R, typename Areas>
+		R Integrate(Areas const areas, std::size_t intervals, unsigned threads)
+		{
+			threads = ThreadsFor(intervals, threads);
+			std::vector<R> totals(threads);
+			ParallelChunks(intervals, threads, [&](unsigned chunk, std::size_t begin, std::size_t end) {
+				std::size_t const interior_end = end < intervals ? end : intervals - 1;
+				totals[chunk] = Sum<R>(begin, interior_end, [&](std::size_t i) { return areas.interior(i); })
+					+ (end == intervals ? areas.last(intervals - 1) : R(0));
+			});
+			R total = R(0);
+			for(R t : totals)
+			{
+				total += t;
+			}
+			return total;
+		}
+
+		/**
+		 * out[0] = 0 and out[i + 1] = out[i] + the area of interval i. Each thread fills
+		 * in and sums its chunk, then the chunks are offset by the totals
+		 * of the chunks before them.
+		 */
+		template<typename R, typename Areas>
+		void IntegrateCumulative(Areas const areas, std::size_t intervals, R* out, unsigned threads)
+		{
+			out[0] = R(0);
+			if(intervals == 0)
+			{
+				return;
+			}
+			threads = ThreadsFor(intervals, threads);
+			std::vector<R> offsets(threads);
+			ParallelChunks(intervals, threads, [&](unsigned chunk, std::size_t begin, std::size_t end) {
+				R* const dst = out + 1;
+				std::size_t const interior_end = end < intervals ? end : intervals - 1;
+				for(std::size_t i = begin; i < interior_end; i++)
+				{
+					dst[i] = areas.interior(i);
+				}
+				if(end == intervals)
+				{
+					dst[intervals - 1] = areas.last(intervals - 1);
+				}
+				offsets[chunk] = PrefixSum(dst + begin, end - begin);
+			});
+			if(threads <= 1)
+			{
+				return;
+			}
+			R offset = R(0);
+			for(R& o : offsets)
+			{
+				R const total = o;
+				o = offset;
+				offset += total;
+			}
+			ParallelChunks(intervals, threads, [&](unsigned chunk, std::size_t begin, std::size_t end) {
+				R* const dst = out + 1;
+				R const o = offsets[chunk];
+				for(std::size_t i = begin; i < end; i++)
+				{
+					dst[i] += o;
+				}
+			});
+		}
+
+		/**
+		 * The result of an operation on samples ys at inputs xs, for the
+		 * overloads taking the inputs as a container, or nothing for the
+		 * overloads taking a spacing or samples that aren't in a container.
+		 * Only worked out for the matching overload, as the operators don't
+		 * accept containers.
+		 */
+		template<template<typename, typename> class Result, typename Ys, typename Xs, typename = void>
+		struct SampledResult {};
+
+		template<template<typename, typename> class Result, typename Ys, typename Xs>
+		struct SampledResult<Result, Ys, Xs, typename std::enable_if<!HasBaseType<Xs>::value,
+			decltype(void(std::declval<ElementType<Ys>>()), void(std::declval<ElementType<Xs>>()))>::type>
+		{
+			using Type = Result<ElementType<Ys>, ElementType<Xs>>;
+		};
+
+		/**
+		 * The result of an operation on samples ys spaced dx apart, or
+		 * nothing for a container of inputs or samples that aren't in a
+		 * container
+		 */
+		template<template<typename, typename> class Result, typename Ys, typename X, typename = void>
+		struct SpacedResult {};
+
+		template<template<typename, typename> class Result, typename Ys, typename X>
+		struct SpacedResult<Result, Ys, X, typename std::enable_if<HasBaseType<X>::value,
+			decltype(void(std::declval<ElementType<Ys>>()))>::type>
+		{
+			using Type = Result<ElementType<Ys>, X>;
+		};
+
+		template<typename Ys, typename Xs>
+		using IfSampled = typename SampledResult<IntegralType, Ys, Xs>::Type;
+
+		template<typename Ys, typename X>
+		using IfSpaced = typename SpacedResult<IntegralType, Ys, X>::Type;
+
+		template<typename R, typename Outs>
+		inline typename R::BaseType* CheckedOutput(Outs& out)
+		{
+			static_assert(std::is_same<ElementType<Outs>, R>::value,
+				"The output must have the type of the integral or derivative");
+			return BaseData(out);
+		}
+	}
+
+	/**
+	 * The integral of y over x by the trapezoid rule, for samples y at
+	 * increasing x
+	 */
+	template<typename Ys, typename Xs>
+	auto trapezoid(Ys const& y, Xs const& x, unsigned threads = 0) -> _internal::IfSampled<Ys, Xs>
+	{
+		using Result = _internal::IfSampled<Ys, Xs>;
+		using R = typename Result::BaseType;
+		std::size_t const n = _internal::CommonSize(y, x);
+		if(n < 2)
+		{
+			return Result(R(0));
+		}
+		auto const areas = _internal::TrapezoidAreas<R, typename _internal::ElementType<Ys>::BaseType, typename _internal::ElementType<Xs>::BaseType>{
+			_internal::BaseData(y), _internal::BaseData(x)};
+		return Result(_internal::Integrate<R>(areas, n - 1, threads));
+	}
+
+	/**
+	 * The integral of y over x by the trapezoid rule, for samples y spaced
+	 * dx apart
+	 */
+	template<typename Ys, typename X>
+	auto trapezoid(Ys const& y, X const& dx, unsigned threads = 0) -> _internal::IfSpaced<Ys, X>
+	{
+		using Result = _internal::IfSpaced<Ys, X>;
+		using R = typename Result::BaseType;
+		if(_internal::Size(y) < 2)
+		{
+			return Result(R(0));
+		}
+		auto const areas = _internal::UniformTrapezoidAreas<R, typename _internal::ElementType<Ys>::BaseType>{
+			_internal::BaseData(y), R(0.5) * R(dx.val)};
+		return Result(_internal::Integrate<R>(areas, _internal::Size(y) - 1, threads));
+	}
+
+	/**
+	 * The integral of y over x by Simpson's rule, for samples y at
+	 * increasing x. Each interval is integrated under the quadratic through
+	 * its ends and the next point, so it is exact for quadratics however
+	 * the samples are spaced and however many there are. Two samples are
+	 * integrated by the trapezoid rule.
+	 */
+	template<typename Ys, typename Xs>
+	auto simpson(Ys const& y, Xs const& x, unsigned threads = 0) -> _internal::IfSampled<Ys, Xs>
+	{
+		using Result = _internal::IfSampled<Ys, Xs>;
+		using R = typename Result::BaseType;
+		std::size_t const n = _internal::CommonSize(y, x);
+		if(n < 2)
+		{
+			return Result(R(0));
+		}
+		auto const areas = _internal::SimpsonAreas<R, typename _internal::ElementType<Ys>::BaseType, typename _internal::ElementType<Xs>::BaseType>{
+			_internal::BaseData(y), _internal::BaseData(x)};
+		return Result(_internal::Integrate<R>(areas, n - 1, threads));
+	}
+
+	/**
+	 * The integral of y over x by Simpson's rule, for samples y spaced dx
+	 * apart
+	 */
+	template<typename Ys, typename X>
+	auto simpson(Ys const& y, X const& dx, unsigned threads = 0) -> _internal::IfSpaced<Ys, X>
+	{
+		using Result = _internal::IfSpaced<Ys, X>;
+		using R = typename Result::BaseType;
+		if(_internal::Size(y) < 2)
+		{
+			return Result(R(0));
+		}
+		auto const areas = _internal::UniformSimpsonAreas<R, typename _internal::ElementType<Ys>::BaseType>{
+			_internal::BaseData(y), R(dx.val) / R(12)};
+		return Result(_internal::Integrate<R>(areas, _internal::Size(y) - 1, threads));
+	}
+
+	/**
+	 * Writes the integral of y from the first sample to each sample, by the
+	 * trapezoid rule, to out, which must be as long as y and have the type
+	 * of y * x
+	 */
+	template<typename Ys, typename Xs, typename Outs>
+	auto cumulative_trapezoid(Ys const& y, Xs const& x, Outs&& out, unsigned threads = 0)
+		-> decltype(void(std::declval<_internal::IfSampled<Ys, Xs>>()))
+	{
+		using R = typename _internal::IfSampled<Ys, Xs>::BaseType;
+		std::size_t const n = _internal::CommonSize(y, x, out);
+		if(n == 0)
+		{
+			return;
+		}
+		auto const areas = _internal::TrapezoidAreas<R, typename _internal::ElementType<Ys>::BaseType, typename _internal::ElementType<Xs>::BaseType>{
+			_internal::BaseData(y), _internal::BaseData(x)};
+		_internal::IntegrateCumulative(areas, n - 1, _internal::CheckedOutput<_internal::IfSampled<Ys, Xs>>(out), threads);
+	}
+
+	template<typename Ys, typename X, typename Outs>
+	auto cumulative_trapezoid(Ys const& y, X const& dx, Outs&& out, unsigned threads = 0)
+		-> decltype(void(std::declval<_internal::IfSpaced<Ys, X>>()))
+	{
+		using R = typename _internal::IfSpaced<Ys, X>::BaseType;
+		std::size_t const n = _internal::CommonSize(y, out);
+		if(n == 0)
+		{
+			return;
+		}
+		auto const areas = _internal::UniformTrapezoidAreas<R, typename _internal::ElementType<Ys>::BaseType>{
+			_internal::BaseData(y), R(0.5) * R(dx.val)};
+		_internal::IntegrateCumulative(areas, n - 1, _internal::CheckedOutput<_internal::IfSpaced<Ys, X>>(out), threads);
+	}
+
+	/**
+	 * Writes the integral of y from the first sample to each sample, by
+	 * Simpson's rule as for simpson(), to out, which must be as long as y
+	 * and have the type of y * x
+	 */
+	template<typename Ys, typename Xs, typename Outs>
+	auto cumulative_simpson(Ys const& y, Xs const& x, Outs&& out, unsigned threads = 0)
+		-> decltype(void(std::declval<_internal::IfSampled<Ys, Xs>>()))
+	{
+		using R = typename _internal::IfSampled<Ys, Xs>::BaseType;
+		std::size_t const n = _internal::CommonSize(y, x, out);
+		if(n == 0)
+		{
+			return;
+		}
+		auto const areas = _internal::SimpsonAreas<R, typename _internal::ElementType<Ys>::BaseType, typename _internal::ElementType<Xs>::BaseType>{
+			_internal::BaseData(y), _internal::BaseData(x)};
+		_internal::IntegrateCumulative(areas, n - 1, _internal::CheckedOutput<_internal::IfSampled<Ys, Xs>>(out), threads);
+	}
+
+	template<typename Ys, typename X, typename Outs>
+	auto cumulative_simpson(Ys const& y, X const& dx, Outs&& out, unsigned threads = 0)
+		-> decltype(void(std::declval<_internal::IfSpaced<Ys, X>>()))
+	{
+		using R = typename _internal::IfSpaced<Ys, X>::BaseType;
+		std::size_t const n = _internal::CommonSize(y, out);
+		if(n == 0)
+		{
+			return;
+		}
+		auto const areas = _internal::UniformSimpsonAreas<R, typename _internal::ElementType<Ys>::BaseType>{
+			_internal::BaseData(y), R(dx.val) / R(12)};
+		_internal::IntegrateCumulative(areas, n - 1, _internal::CheckedOutput<_internal::IfSpaced<Ys, X>>(out), threads);
+	}
+
+	namespace _internal {
+		/**
+		 * Second-order finite differences: central in the interior, one-sided
+		 * at the ends, weighted for uneven spacing, so exact for quadratics
+		 */
+		template<typename R, typename YB, typename XB>
+		struct Differences
+		{
+			YB const* y;
+			XB const* x;
+
+			R interior(std::size_t i) const
+			{
+				R const h0 = R(x[i]) - R(x[i - 1]);
+				R const h1 = R(x[i + 1]) - R(x[i]);
+				return (h0 * h0 * (R(y[i + 1]) - R(y[i])) + h1 * h1 * (R(y[i]) - R(y[i - 1]))) / (h0 * h1 * (h0 + h1));
+			}
+
+			R first() const
+			{
+				R const h0 = R(x[1]) - R(x[0]);
+				R const h1 = R(x[2]) - R(x[1]);
+				return -(R(2) * h0 + h1) / (h0 * (h0 + h1)) * R(y[0])
+					+ (h0 + h1) / (h0 * h1) * R(y[1])
+					- h0 / (h1 * (h0 + h1)) * R(y[2]);
+			}
+
+			R last(std::size_t n) const
+			{
+				R const h0 = R(x[n - 2]) - R(x[n - 3]);
+				R const h1 = R(x[n - 1]) - R(x[n - 2]);
+				return h1 / (h0 * (h0 + h1)) * R(y[n - 3])
+					- (h0 + h1) / (h0 * h1) * R(y[n - 2])
+					+ (h0 + R(2) * h1) / (h1 * (h0 + h1)) * R(y[n - 1]);
+			}
+
+			R slope() const
+			{
+				return (R(y[1]) - R(y[0])) / (R(x[1]) - R(x[0]));
+			}
+		};
+
+		template<typename R, typename YB>
+		struct UniformDifferences
+		{
+			YB const* y;
+			R inv_2dx;
+
+			R interior(std::size_t i) const
+			{
+				return (R(y[i + 1]) - R(y[i - 1])) * inv_2dx;
+			}
+
+			R first() const
+			{
+				return (R(-3) * R(y[0]) + R(4) * R(y[1]) - R(y[2])) * inv_2dx;
+			}
+
+			R last(std::size_t n) const
+			{
+				return (R(y[n - 3]) - R(4) * R(y[n - 2]) + R(3) * R(y[n - 1])) * inv_2dx;
+			}
+
+			R slope() const
+			{
+				return (R(y[1]) - R(y[0])) * R(2) * inv_2dx;
+			}
+		};
+
+		template<typename R, typename Differences>
+		void Differentiate(Differences const d, std::size_t n, R* out, unsigned threads)
+		{
+			if(n < 2)
+			{
+				for(std::size_t i = 0; i < n; i++)
+				{
+					out[i] = R(0);
+				}
+				return;
+			}
+			if(n == 2)
+			{
+				out[0] = out[1] = d.slope();
+				return;
+			}
+			out[0] = d.first();
+			out[n - 1] = d.last(n);
+			ParallelChunks(n - 2, ThreadsFor(n - 2, threads), [&](unsigned, std::size_t begin, std::size_t end) {
+				for(std::size_t i = begin + 1; i < end + 1; i++)
+				{
+					out[i] = d.interior(i);
+				}
+			});
+		}
+
+		template<typename Ys, typename Xs>
+		using IfSampledDerivative = typename SampledResult<DerivativeType, Ys, Xs>::Type;
+
+		template<typename Ys, typename X>
+		using IfSpacedDerivative = typename SpacedResult<DerivativeType, Ys, X>::Type;
+	}
+
+	/**
+	 * Writes the derivative of y with respect to x at each sample to out,
+	 * which must be as long as y and have the type of y / x. Uses
+	 * second-order differences, so is exact for quadratics; two samples
+	 * give their slope.
+	 */
+	template<typename Ys, typename Xs, typename Outs>
+	auto gradient(Ys const& y, Xs const& x, Outs&& out, unsigned threads = 0)
+		-> decltype(void(std::declval<_internal::IfSampledDerivative<Ys, Xs>>()))
+	{
+		using Result = _internal::IfSampledDerivative<Ys, Xs>;
+		using R = typename Result::BaseType;
+		std::size_t const n = _internal::CommonSize(y, x, out);
+		auto const d = _internal::Differences<R, typename _internal::ElementType<Ys>::BaseType, typename _internal::ElementType<Xs>::BaseType>{
+			_internal::BaseData(y), _internal::BaseData(x)};
+		_internal::Differentiate(d, n, _internal::CheckedOutput<Result>(out), threads);
+	}
+
+	template<typename Ys, typename X, typename Outs>
+	auto gradient(Ys const& y, X const& dx, Outs&& out, unsigned threads = 0)
+		-> decltype(void(std::declval<_internal::IfSpacedDerivative<Ys, X>>()))
+	{
+		using Result = _internal::IfSpacedDerivative<Ys, X>;
+		using R = typename Result::BaseType;
+		std::size_t const n = _internal::CommonSize(y, out);
+		auto const d = _internal::UniformDifferences<R, typename _internal::ElementType<Ys>::BaseType>{
+			_internal::BaseData(y), R(1) / (R(2) * R(dx.val))};
+		_internal::Differentiate(d, n, _internal::CheckedOutput<Result>(out), threads);
+	}
+}
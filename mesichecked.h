@@ -0,0 +1,585 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/*
+ * This header can be included before mesicore.h, so that MESI_LITERAL_TYPE
+ * can be set to a Checked type for the named units, e.g.
+ *
+ *     #define MESI_LITERAL_TYPE Mesi::DebugChecked<float>
+ *     #include "mesichecked.h"
+ *
+ * so mesicore.h is only included at the end.
+ */
+
+/*
+ * Selects whether DebugChecked<T> is Checked<T> (1) or plain T (0). Follows
+ * NDEBUG unless set explicitly.
+ */
+#ifndef MESI_CHECKED
+#	ifdef NDEBUG
+#		define MESI_CHECKED 0
+#	else
+#		define MESI_CHECKED 1
+#	endif
+#endif
+
+#if defined(__GNUC__)
+#	define MESI_COLD __attribute__((cold, noinline))
+#else
+#	define MESI_COLD
+#endif
+
+namespace Mesi {
+	/**
+	 * The operations Checked values count failures for
+	 */
+	enum class CheckedOperation
+	{
+		Add,
+		Subtract,
+		Multiply,
+		Divide,
+		Negate,
+		Convert,
+		Function,
+		Count
+	};
+
+	/**
+	 * The kinds of failure Checked values detect
+	 */
+	enum class CheckedError
+	{
+		NaN,
+		Infinity,
+		Overflow,
+		DivideByZero,
+		Count
+	};
+
+	/**
+	 * @brief Failures seen by Checked arithmetic on one thread
+	 *
+	 * Counts are kept per operation and kind of failure. The first failure
+	 * is kept in full: the operation, its operands (as doubles), and the
+	 * label of the innermost CheckedScope active at the time.
+	 */
+	struct CheckedReport
+	{
+		uint64_t counts[int(CheckedOperation::Count)][int(CheckedError::Count)];
+
+		bool has_failed;
+		CheckedOperation first_operation;
+		CheckedError first_error;
+		double first_left;
+		double first_right;
+		char const* first_scope;
+
+		uint64_t count(CheckedOperation operation, CheckedError error) const
+		{
+			return counts[int(operation)][int(error)];
+		}
+
+		uint64_t count(CheckedError error) const
+		{
+			uint64_t n = 0;
+			for(int i = 0; i < int(CheckedOperation::Count); i++)
+			{
+				n += counts[i][int(error)];
+			}
+			return n;
+		}
+
+		uint64_t total() const
+		{
+			uint64_t n = 0;
+			for(int i = 0; i < int(CheckedError::Count); i++)
+			{
+				n += count(CheckedError(i));
+			}
+			return n;
+		}
+	};
+
+	namespace _internal {
+		/*
+		 * Zero-initialised, so access needs no guard check
+		 */
+		inline CheckedReport& ThreadCheckedReport()
+		{
+			static thread_local CheckedReport s_report;
+			return s_report;
+		}
+
+		inline char const*& ThreadCheckedScope()
+		{
+			static thread_local char const* s_scope;
+			return s_scope;
+		}
+
+		/**
+		 * Kept out of line, so the checks only cost a compare and branch
+		 */
+		MESI_COLD inline void RecordCheckedFailure(CheckedOperation operation, CheckedError error, double left, double right)
+		{
+			CheckedReport& report = ThreadCheckedReport();
+			report.counts[int(operation)][int(error)]++;
+			if(!report.has_failed)
+			{
+				report.has_failed = true;
+				report.first_operation = operation;
+				report.first_error = error;
+				report.first_left = left;
+				report.first_right = right;
+				report.first_scope = ThreadCheckedScope();
+			}
+		}
+
+		/**
+		 * Whether x is neither infinite nor NaN, usable in constant
+		 * expressions unlike std::isfinite
+		 */
+		template<typename T>
+		constexpr bool IsFinite(T const x)
+		{
+			return (x - x) == (x - x);
+		}
+
+		/**
+		 * The arithmetic of Checked, in result type R
+		 */
+		template<typename R, bool = std::is_integral<R>::value, bool = std::is_signed<R>::value>
+		struct CheckedArithmetic;
+
+		/**
+		 * Floating point: reports NaN or infinite results, unless an operand
+		 * was already NaN or infinite, so only the origin of a bad value is
+		 * reported rather than everywhere it spreads to
+		 */
+		template<typename R, bool t_signed>
+		struct CheckedArithmetic<R, false, t_signed>
+		{
+			static constexpr R check(R const r, R const a, R const b, CheckedOperation operation)
+			{
+				return (IsFinite(r) || !IsFinite(a) || !IsFinite(b))
+					? r
+					: (RecordCheckedFailure(operation, r != r ? CheckedError::NaN : CheckedError::Infinity, double(a), double(b)), r);
+			}
+
+			static constexpr R add(R const a, R const b) { return check(a + b, a, b, CheckedOperation::Add); }
+			static constexpr R subtract(R const a, R const b) { return check(a - b, a, b, CheckedOperation::Subtract); }
+			static constexpr R multiply(R const a, R const b) { return check(a * b, a, b, CheckedOperation::Multiply); }
+
+			static constexpr R divide(R const a, R const b)
+			{
+				return (b == R(0) && IsFinite(a))
+					? (RecordCheckedFailure(CheckedOperation::Divide, CheckedError::DivideByZero, double(a), double(b)), a / b)
+					: check(a / b, a, b, CheckedOperation::Divide);
+			}
+
+			static constexpr R negate(R const a) { return -a; }
+		};
+
+		/**
+		 * Signed integers: reports overflow and division by zero. Results
+		 * that overflow wrap around rather than being undefined.
+		 */
+		template<typename R>
+		struct CheckedArithmetic<R, true, true>
+		{
+			using U = typename std::make_unsigned<R>::type;
+			static constexpr R c_max = std::numeric_limits<R>::max();
+			static constexpr R c_min = std::numeric_limits<R>::min();
+
+			static constexpr R fail(R const r, R const a, R const b, CheckedOperation operation, CheckedError error)
+			{
+				return RecordCheckedFailure(operation, error, double(a), double(b)), r;
+			}
+
+			static constexpr R add(R const a, R const b)
+			{
+				return ((b > 0 && a > c_max - b) || (b < 0 && a < c_min - b))
+					? fail(R(U(a) + U(b)), a, b, CheckedOperation::Add, CheckedError::Overflow)
+					: R(a + b);
+			}
+
+			static constexpr R subtract(R const a, R const b)
+			{
+				return ((b < 0 && a > c_max + b) || (b > 0 && a < c_min + b))
+					? fail(R(U(a) - U(b)), a, b, CheckedOperation::Subtract, CheckedError::Overflow)
+					: R(a - b);
+			}
+
+			static constexpr R multiply(R const a, R const b)
+			{
+				return (a > 0 ? (b > 0 ? a > c_max / b : b < c_min / a)
+				              : (b > 0 ? a < c_min / b : (a != 0 && b < c_max / a)))
+					? fail(R(U(a) * U(b)), a, b, CheckedOperation::Multiply, CheckedError::Overflow)
+					: R(a * b);
+			}
+
+			static constexpr R divide(R const a, R const b)
+			{
+				return b == 0
+					? fail(R(0), a, b, CheckedOperation::Divide, CheckedError::DivideByZero)
+					: (a == c_min && b == -1)
+						? fail(c_min, a, b, CheckedOperation::Divide, CheckedError::Overflow)
+						: R(a / b);
+			}
+
+			static constexpr R negate(R const a)
+			{
+				return a == c_min ? fail(c_min, a, 0, CheckedOperation::Negate, CheckedError::Overflow) : R(-a);
+			}
+		};
+
+		/**
+		 * Unsigned integers: reports wrap-around and division by zero
+		 */
+		template<typename R>
+		struct CheckedArithmetic<R, true, false>
+		{
+			static constexpr R c_max = std::numeric_limits<R>::max();
+
+			static constexpr R fail(R const r, R const a, R const b, CheckedOperation operation, CheckedError error)
+			{
+				return RecordCheckedFailure(operation, error, double(a), double(b)), r;
+			}
+
+			static constexpr R add(R const a, R const b)
+			{
+				return a > R(c_max - b) ? fail(R(a + b), a, b, CheckedOperation::Add, CheckedError::Overflow) : R(a + b);
+			}
+
+			static constexpr R subtract(R const a, R const b)
+			{
+				return a < b ? fail(R(a - b), a, b, CheckedOperation::Subtract, CheckedError::Overflow) : R(a - b);
+			}
+
+			static constexpr R multiply(R const a, R const b)
+			{
+				return (a != 0 && b > R(c_max / a)) ? fail(R(a * b), a, b, CheckedOperation::Multiply, CheckedError::Overflow) : R(a * b);
+			}
+
+			static constexpr R divide(R const a, R const b)
+			{
+				return b == 0 ? fail(R(0), a, b, CheckedOperation::Divide, CheckedError::DivideByZero) : R(a / b);
+			}
+
+			static constexpr R negate(R const a)
+			{
+				return a != 0 ? fail(R(R(0) - a), a, 0, CheckedOperation::Negate, CheckedError::Overflow) : a;
+			}
+		};
+
+		/**
+		 * Converts between arithmetic types, reporting values that don't
+		 * fit. Out of range floating-point values are clamped when
+		 * converted to integers, as the plain conversion is undefined.
+		 */
+		template<typename To, typename From,
+			bool = std::is_integral<To>::value, bool = std::is_integral<From>::value>
+		struct CheckedConversion
+		{
+			// Floating point to floating point
+			static constexpr To apply(From const v)
+			{
+				return (IsFinite(v) && !IsFinite(To(v)))
+					? (RecordCheckedFailure(CheckedOperation::Convert, CheckedError::Overflow, double(v), 0), To(v))
+					: To(v);
+			}
+		};
+
+		template<typename To, typename From>
+		struct CheckedConversion<To, From, false, true>
+		{
+			// Integer to floating point always fits, if inexactly
+			static constexpr To apply(From const v)
+			{
+				return To(v);
+			}
+		};
+
+		template<typename To, typename From>
+		struct CheckedConversion<To, From, true, false>
+		{
+			// Floating point to integer
+			static constexpr To apply(From const v)
+			{
+				return v != v
+					? (RecordCheckedFailure(CheckedOperation::Convert, CheckedError::NaN, double(v), 0), To(0))
+					: !(v > From(std::numeric_limits<To>::min()) - 1)
+						? (RecordCheckedFailure(CheckedOperation::Convert, IsFinite(v) ? CheckedError::Overflow : CheckedError::Infinity, double(v), 0), std::numeric_limits<To>::min())
+						: !(v < From(std::numeric_limits<To>::max()) + 1)
+							? (RecordCheckedFailure(CheckedOperation::Convert, IsFinite(v) ? CheckedError::Overflow : CheckedError::Infinity, double(v), 0), std::numeric_limits<To>::max())
+							: To(v);
+			}
+		};
+
+		template<typename To, typename From>
+		struct CheckedConversion<To, From, true, true>
+		{
+			// Integer to integer, comparing without mixing signedness
+			static constexpr bool fits(From const v)
+			{
+				return (v < From(0))
+					? (std::is_signed<To>::value && intmax_t(v) >= intmax_t(std::numeric_limits<To>::min()))
+					: uintmax_t(v) <= uintmax_t(std::numeric_limits<To>::max());
+			}
+
+			static constexpr To apply(From const v)
+			{
+				return fits(v) ? To(v) : (RecordCheckedFailure(CheckedOperation::Convert, CheckedError::Overflow, double(v), 0), To(v));
+			}
+		};
+	}
+
+	/**
+	 * @brief Arithmetic type that reports NaN, infinity and overflow
+	 *
+	 * @param T the arithmetic type that is wrapped
+	 *
+	 * A drop-in storage type for Mesi types, e.g. Type<Checked<float>, 1, 0,
+	 * 0>, for finding where bad values first appear. Arithmetic,
+	 * conversions and the maths functions below check their results and
+	 * record failures in thread-local counters (see CheckedFailures()); the
+	 * values themselves behave as for T, except that overflowing integers
+	 * wrap rather than being undefined.
+	 *
+	 * Use DebugChecked<T> to only check in debug builds: with checks
+	 * disabled it is plain T, so there is no overhead.
+	 */
+	template<typename T>
+	struct Checked
+	{
+		static_assert(std::is_arithmetic<T>::value, "Checked only wraps arithmetic types");
+
+		using ValueType = T;
+
+		T val;
+
+		Checked() = default;
+
+		/**
+		 * Converts from any arithmetic type, checking that the value fits
+		 */
+		template<typename S, typename = typename std::enable_if<std::is_arithmetic<S>::value>::type>
+		constexpr Checked(S const v)
+			:val(_internal::CheckedConversion<T, S>::apply(v))
+		{}
+
+		template<typename S>
+		constexpr explicit Checked(Checked<S> const& v)
+			:val(_internal::CheckedConversion<T, S>::apply(v.val))
+		{}
+
+		/**
+		 * Converts to any arithmetic type, checking that the value fits
+		 */
+		template<typename S, typename = typename std::enable_if<std::is_arithmetic<S>::value>::type>
+		constexpr explicit operator S() const
+		{
+			return _internal::CheckedConversion<S, T>::apply(val);
+		}
+
+		constexpr Checked operator-() const { return Checked(_internal::CheckedArithmetic<T>::negate(val)); }
+		constexpr Checked operator+() const { return *this; }
+
+		template<typename S> constexpr Checked& operator+=(S const& rhs) { return *this = Checked(*this + rhs); }
+		template<typename S> constexpr Checked& operator-=(S const& rhs) { return *this = Checked(*this - rhs); }
+		template<typename S> constexpr Checked& operator*=(S const& rhs) { return *this = Checked(*this * rhs); }
+		template<typename S> constexpr Checked& operator/=(S const& rhs) { return *this = Checked(*this / rhs); }
+	};
+
+	/**
+	 * Checked<T> when MESI_CHECKED is enabled, otherwise plain T
+	 */
+	template<typename T>
+	using DebugChecked = typename std::conditional<MESI_CHECKED, Checked<T>, T>::type;
+
+	/**
+	 * The failures recorded on the calling thread
+	 */
+	inline CheckedReport const& CheckedFailures()
+	{
+		return _internal::ThreadCheckedReport();
+	}
+
+	/**
+	 * Clears the failures recorded on the calling thread
+	 */
+	inline void ResetCheckedFailures()
+	{
+		_internal::ThreadCheckedReport() = CheckedReport();
+	}
+
+	/**
+	 * @brief Labels the failures recorded on this thread while it exists
+	 *
+	 * The label of the innermost scope is stored with the first failure, to
+	 * narrow down where it happened. The label must outlive the report, so
+	 * is usually a string literal.
+	 */
+	class CheckedScope
+	{
+	public:
+		explicit CheckedScope(char const* label)
+			:p_previous(_internal::ThreadCheckedScope())
+		{
+			_internal::ThreadCheckedScope() = label;
+		}
+
+		~CheckedScope()
+		{
+			_internal::ThreadCheckedScope() = p_previous;
+		}
+
+		CheckedScope(CheckedScope const&) = delete;
+		CheckedScope& operator=(CheckedScope const&) = delete;
+
+	private:
+		char const* p_previous;
+	};
+
+	namespace _internal {
+		template<typename T>
+		constexpr T const& CheckedValue(T const& v) { return v; }
+
+		template<typename T>
+		constexpr T const& CheckedValue(Checked<T> const& v) { return v.val; }
+
+		template<typename T>
+		struct IsChecked : std::false_type {};
+
+		template<typename T>
+		struct IsChecked<Checked<T>> : std::true_type {};
+
+		/**
+		 * Enabled when at least one of A and B is Checked and the other is
+		 * Checked or arithmetic. Used as a default template argument, so it
+		 * is checked before the return type is deduced.
+		 */
+		template<typename A, typename B, typename R>
+		using CheckedOperands = typename std::enable_if<
+			(IsChecked<A>::value || IsChecked<B>::value) &&
+			(IsChecked<A>::value || std::is_arithmetic<A>::value) &&
+			(IsChecked<B>::value || std::is_arithmetic<B>::value),
+			R>::type;
+	}
+
+#define CHECKED_OPERATOR(op, name) \
+	template<typename A, typename B, typename = _internal::CheckedOperands<A, B, void>> \
+	constexpr auto operator op(A const& left, B const& right) \
+		-> Checked<decltype(_internal::CheckedValue(left) op _internal::CheckedValue(right))> \
+	{ \
+		using R = decltype(_internal::CheckedValue(left) op _internal::CheckedValue(right)); \
+		return Checked<R>(_internal::CheckedArithmetic<R>::name(R(_internal::CheckedValue(left)), R(_internal::CheckedValue(right)))); \
+	}
+
+	CHECKED_OPERATOR(+, add)
+	CHECKED_OPERATOR(-, subtract)
+	CHECKED_OPERATOR(*, multiply)
+	CHECKED_OPERATOR(/, divide)
+#undef CHECKED_OPERATOR
+
+#define CHECKED_COMPARISON(op) \
+	template<typename A, typename B, typename = _internal::CheckedOperands<A, B, void>> \
+	constexpr bool operator op(A const& left, B const& right) \
+	{ \
+		return _internal::CheckedValue(left) op _internal::CheckedValue(right); \
+	}
+
+	CHECKED_COMPARISON(==)
+	CHECKED_COMPARISON(!=)
+	CHECKED_COMPARISON(<)
+	CHECKED_COMPARISON(<=)
+	CHECKED_COMPARISON(>)
+	CHECKED_COMPARISON(>=)
+#undef CHECKED_COMPARISON
+
+	/*
+	 * Maths functions, found by argument-dependent lookup. Results are
+	 * checked like the floating-point operators: only a NaN or infinity
+	 * from finite arguments is reported.
+	 */
+#define CHECKED_FUNCTION_1(name) \
+	template<typename T> \
+	auto name(Checked<T> const& x) \
+	{ \
+		using std::name; \
+		auto const r = name(x.val); \
+		using R = typename std::remove_const<decltype(r)>::type; \
+		return Checked<R>(_internal::CheckedArithmetic<R>::check(r, R(x.val), R(0), CheckedOperation::Function)); \
+	}
+#define CHECKED_FUNCTION_2(name) \
+	template<typename T, typename U> \
+	auto name(Checked<T> const& x, Checked<U> const& y) \
+	{ \
+		using std::name; \
+		auto const r = name(x.val, y.val); \
+		using R = typename std::remove_const<decltype(r)>::type; \
+		return Checked<R>(_internal::CheckedArithmetic<R>::check(r, R(x.val), R(y.val), CheckedOperation::Function)); \
+	}
+
+	CHECKED_FUNCTION_1(abs)
+	CHECKED_FUNCTION_1(fabs)
+	CHECKED_FUNCTION_1(ceil)
+	CHECKED_FUNCTION_1(floor)
+	CHECKED_FUNCTION_1(trunc)
+	CHECKED_FUNCTION_1(round)
+	CHECKED_FUNCTION_1(sqrt)
+	CHECKED_FUNCTION_1(cbrt)
+	CHECKED_FUNCTION_1(exp)
+	CHECKED_FUNCTION_1(exp2)
+	CHECKED_FUNCTION_1(log)
+	CHECKED_FUNCTION_1(log2)
+	CHECKED_FUNCTION_1(log10)
+	CHECKED_FUNCTION_1(sin)
+	CHECKED_FUNCTION_1(cos)
+	CHECKED_FUNCTION_1(tan)
+	CHECKED_FUNCTION_1(asin)
+	CHECKED_FUNCTION_1(acos)
+	CHECKED_FUNCTION_1(atan)
+	CHECKED_FUNCTION_1(sinh)
+	CHECKED_FUNCTION_1(cosh)
+	CHECKED_FUNCTION_1(tanh)
+	CHECKED_FUNCTION_2(pow)
+	CHECKED_FUNCTION_2(atan2)
+	CHECKED_FUNCTION_2(hypot)
+	CHECKED_FUNCTION_2(fmin)
+	CHECKED_FUNCTION_2(fmax)
+#undef CHECKED_FUNCTION_1
+#undef CHECKED_FUNCTION_2
+
+	/*
+	 * Result types for Mesi types stored as Checked values. The defaults
+	 * can't be used, as they call std::pow directly.
+	 */
+	template<typename T, typename U>
+	struct TypeOperations;
+
+#define CHECKED_TYPE_OPERATIONS(A, B, TA, TB) \
+	struct TypeOperations<A, B> \
+	{ \
+		using MultiplyResult = Checked<decltype(TA{} * TB{})>; \
+		using DivideResult = Checked<decltype(TA{} / TB{})>; \
+		using AddResult = Checked<decltype(TA{} + TB{})>; \
+		using SubtractResult = Checked<decltype(TA{} - TB{})>; \
+		using PowerResult = Checked<decltype(std::pow(TA{}, TB{}))>; \
+	};
+
+	template<typename T, typename U>
+	CHECKED_TYPE_OPERATIONS(Checked<T>, Checked<U>, T, U)
+	template<typename T, typename U>
+	CHECKED_TYPE_OPERATIONS(Checked<T>, U, T, U)
+	template<typename T, typename U>
+	CHECKED_TYPE_OPERATIONS(T, Checked<U>, T, U)
+#undef CHECKED_TYPE_OPERATIONS
+}
+
+#undef MESI_COLD
+
+#include "mesicore.h"
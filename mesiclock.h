@@ -0,0 +1,407 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ratio>
+#include <type_traits>
+#include "mesicore.h"
+
+/*
+ * Whether the processor's time-stamp counter can be read directly
+ */
+#if (defined(__GNUC__) || defined(_MSC_VER)) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#	define MESI_HAS_TSC 1
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	else
+#		include <x86intrin.h>
+#	endif
+#else
+#	define MESI_HAS_TSC 0
+#endif
+
+/*
+ * Timing with Mesi time types: conversions to and from std::chrono, clocks
+ * whose durations are quantities, and a scoped timer recording into a
+ * lock-free histogram:
+ *
+ *     Mesi::TimeHistogram latencies;
+ *     {
+ *         Mesi::ScopedTimer<> timer(latencies);
+ *         handle(request);
+ *     }
+ *     Mesi::Nano<Mesi::Seconds> p99 = latencies.quantile(0.99);
+ */
+namespace Mesi {
+	/**
+	 * The Mesi time type with storage Rep and scale Period, e.g. Milli<Type<
+	 * long long, 0, 1, 0>> for std::chrono::milliseconds
+	 */
+	template<typename Rep, typename Period>
+	using ChronoType = Type<Rep, 0, 1, 0, 0, 0, 0, 0, Period>;
+
+	namespace _internal {
+		template<typename Q>
+		struct ChronoPeriod
+		{
+			static_assert(std::is_same<typename Q::MeterExponent, std::ratio<0>>::value &&
+				std::is_same<typename Q::SecondExponent, std::ratio<1>>::value &&
+				std::is_same<typename Q::KilogramExponent, std::ratio<0>>::value &&
+				std::is_same<typename Q::AmpereExponent, std::ratio<0>>::value &&
+				std::is_same<typename Q::KelvinExponent, std::ratio<0>>::value &&
+				std::is_same<typename Q::MoleExponent, std::ratio<0>>::value &&
+				std::is_same<typename Q::CandelaExponent, std::ratio<0>>::value,
+				"Only times convert to std::chrono durations");
+
+			using Scale = typename Q::ScaleInfo;
+			using Ten = typename Scale::power_of_ten;
+			static_assert(Scale::exponent_denominator == 1 && Ten::den == 1,
+				"Only rational scales have a std::ratio period");
+
+			using Type = std::ratio_multiply<typename Scale::ratio, typename std::conditional<(Ten::num < 0),
+				std::ratio<1, Exp<10, (Ten::num < 0 ? -Ten::num : 0)>::value>,
+				std::ratio<Exp<10, (Ten::num > 0 ? Ten::num : 0)>::value, 1>>::type>;
+		};
+
+		/**
+		 * The highest set bit of a non-zero value
+		 */
+		inline unsigned HighestBit(std::uint64_t const v)
+		{
+#if defined(__GNUC__)
+			return 63u - unsigned(__builtin_clzll(static_cast<unsigned long long>(v)));
+#else
+			unsigned bit = 0;
+			while(v >> bit >> 1)
+			{
+				bit++;
+			}
+			return bit;
+#endif
+		}
+	}
+
+	/**
+	 * The Mesi time type with the same storage and scale as a std::chrono
+	 * duration, holding the same count, so no arithmetic is done
+	 */
+	template<typename Rep, typename Period>
+	constexpr ChronoType<Rep, Period> from_chrono(std::chrono::duration<Rep, Period> const& duration)
+	{
+		return ChronoType<Rep, Period>(duration.count());
+	}
+
+	/**
+	 * The std::chrono duration with the same storage and scale as a Mesi
+	 * time, e.g. std::chrono::duration<float, std::milli> for
+	 * Milli<Seconds>, holding the same count. Scales with roots or
+	 * fractional powers of ten have no std::ratio period and fail to
+	 * compile.
+	 */
+	template<typename Q>
+	constexpr std::chrono::duration<typename Q::BaseType, typename _internal::ChronoPeriod<Q>::Type> to_chrono(Q const& time)
+	{
+		return std::chrono::duration<typename Q::BaseType, typename _internal::ChronoPeriod<Q>::Type>(time.val);
+	}
+
+	/**
+	 * Whole nanoseconds, as measured by the clocks below
+	 */
+	using ClockDuration = Nano<Type<std::int64_t, 0, 1, 0>>;
+
+	/**
+	 * @brief std::chrono::steady_clock with Mesi durations
+	 *
+	 * ticks() are nanoseconds since an arbitrary point, read with
+	 * clock_gettime(CLOCK_MONOTONIC) on Linux, which takes about 20 ns.
+	 */
+	struct SteadyClock
+	{
+		using Duration = ClockDuration;
+
+		static std::uint64_t ticks()
+		{
+			return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+
+		static Duration elapsed(std::uint64_t const from, std::uint64_t const to)
+		{
+			return Duration(std::int64_t(to - from));
+		}
+
+		static Duration now()
+		{
+			return elapsed(0, ticks());
+		}
+	};
+
+#if MESI_HAS_TSC
+	/**
+	 * @brief The processor's time-stamp counter, with Mesi durations
+	 *
+	 * ticks() reads the counter with one instruction, which takes a few
+	 * nanoseconds and doesn't wait for earlier instructions to finish.
+	 * Ticks are converted to nanoseconds at a rate measured against
+	 * SteadyClock over c_calibration the first time elapsed() is called.
+	 *
+	 * This assumes an invariant counter, running at a constant rate and in
+	 * step across cores, as on x86 processors of the last decade. Ticks
+	 * read on different cores are only comparable if it is.
+	 */
+	struct TscClock
+	{
+		using Duration = ClockDuration;
+
+		static constexpr std::chrono::milliseconds c_calibration{10};
+
+		static std::uint64_t ticks()
+		{
+			return std::uint64_t(__rdtsc());
+		}
+
+		static Duration elapsed(std::uint64_t const from, std::uint64_t const to)
+		{
+			return Duration(std::int64_t(double(std::int64_t(to - from)) * nanosecondsPerTick()));
+		}
+
+		static Duration now()
+		{
+			return elapsed(0, ticks());
+		}
+
+		static double nanosecondsPerTick()
+		{
+			static double const s_rate = [] {
+				std::uint64_t const start = SteadyClock::ticks();
+				std::uint64_t const first = ticks();
+				std::uint64_t end;
+				do
+				{
+					end = SteadyClock::ticks();
+				}
+				while(end - start < std::uint64_t(std::chrono::nanoseconds(c_calibration).count()));
+				std::uint64_t const last = ticks();
+				return double(end - start) / double(last - first);
+			}();
+			return s_rate;
+		}
+	};
+
+	constexpr std::chrono::milliseconds TscClock::c_calibration;
+
+	/**
+	 * The cheapest clock to read on this platform
+	 */
+	using ProfileClock = TscClock;
+#else
+	using ProfileClock = SteadyClock;
+#endif
+
+	/**
+	 * @brief Histogram of durations that many threads record into at once
+	 *
+	 * Buckets are spaced logarithmically, c_sub_buckets to each doubling,
+	 * so any duration from a nanosecond to centuries falls in one whose
+	 * bounds are within 12.5% of each other. Each bucket is an atomic
+	 * counter incremented without ordering, so recording never locks or
+	 * retries; quantile() and count() taken while other threads record may
+	 * not match any single point in time.
+	 *
+	 * Durations can be any Mesi time with a std::ratio period (see
+	 * to_chrono()), and are truncated to whole nanoseconds. Negative
+	 * durations count as zero.
+	 */
+	class TimeHistogram
+	{
+	public:
+		using Duration = ClockDuration;
+
+		static constexpr std::size_t c_sub_buckets = 8;
+		static constexpr unsigned c_sub_bits = 3;
+		/** Enough for every duration of up to 2^63 nanoseconds */
+		static constexpr std::size_t c_buckets = (63 - c_sub_bits + 1) * c_sub_buckets;
+
+		TimeHistogram()
+		{
+			reset();
+		}
+
+		TimeHistogram(TimeHistogram const&) = delete;
+		TimeHistogram& operator=(TimeHistogram const&) = delete;
+
+		template<typename Q>
+		void record(Q const& duration)
+		{
+			std::int64_t const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(to_chrono(duration)).count();
+			std::uint64_t const v = ns > 0 ? std::uint64_t(ns) : 0;
+			p_counts[bucketOf(v)].fetch_add(1, std::memory_order_relaxed);
+			p_total.fetch_add(v, std::memory_order_relaxed);
+		}
+
+		/**
+		 * The number of durations recorded
+		 */
+		std::uint64_t count() const
+		{
+			std::uint64_t sum = 0;
+			for(auto const& c : p_counts)
+			{
+				sum += c.load(std::memory_order_relaxed);
+			}
+			return sum;
+		}
+
+		/**
+		 * The sum of the durations recorded
+		 */
+		Duration total() const
+		{
+			return Duration(std::int64_t(p_total.load(std::memory_order_relaxed)));
+		}
+
+		Duration mean() const
+		{
+			std::uint64_t const n = count();
+			return Duration(n ? std::int64_t(p_total.load(std::memory_order_relaxed) / n) : 0);
+		}
+
+		/**
+		 * The upper bound of the bucket holding the q-th quantile, e.g. q =
+		 * 0.99 for the duration that 99% of those recorded didn't exceed, or
+		 * zero if nothing is recorded
+		 */
+		Duration quantile(double const q) const
+		{
+			std::uint64_t counts[c_buckets];
+			std::uint64_t n = 0;
+			for(std::size_t i = 0; i < c_buckets; i++)
+			{
+				counts[i] = p_counts[i].load(std::memory_order_relaxed);
+				n += counts[i];
+			}
+			double const wanted = q * double(n);
+			std::uint64_t seen = 0;
+			for(std::size_t i = 0; i < c_buckets; i++)
+			{
+				seen += counts[i];
+				if(counts[i] && double(seen) >= wanted)
+				{
+					return upperBound(i);
+				}
+			}
+			return Duration(0);
+		}
+
+		/**
+		 * The number of durations in a bucket
+		 */
+		std::uint64_t countIn(std::size_t const bucket) const
+		{
+			return p_counts[bucket].load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * The shortest duration in a bucket
+		 */
+		static Duration lowerBound(std::size_t const bucket)
+		{
+			if(bucket < c_sub_buckets)
+			{
+				return Duration(std::int64_t(bucket));
+			}
+			unsigned const shift = unsigned(bucket / c_sub_buckets) - 1;
+			return Duration(std::int64_t((c_sub_buckets + bucket % c_sub_buckets) << shift));
+		}
+
+		/**
+		 * The longest duration in a bucket
+		 */
+		static Duration upperBound(std::size_t const bucket)
+		{
+			if(bucket + 1 == c_buckets)
+			{
+				return Duration(INT64_MAX);
+			}
+			return Duration(lowerBound(bucket + 1).val - 1);
+		}
+
+		/**
+		 * The bucket a number of nanoseconds falls in: the first c_sub_buckets
+		 * hold one value each, and each later doubling is split into
+		 * c_sub_buckets by the bits after the highest
+		 */
+		static std::size_t bucketOf(std::uint64_t const ns)
+		{
+			if(ns < c_sub_buckets)
+			{
+				return std::size_t(ns);
+			}
+			unsigned const shift = _internal::HighestBit(ns) - c_sub_bits;
+			return (shift + 1) * c_sub_buckets + std::size_t(ns >> shift) - c_sub_buckets;
+		}
+
+		/**
+		 * Empties every bucket. Durations recorded at the same time may be
+		 * lost.
+		 */
+		void reset()
+		{
+			for(auto& c : p_counts)
+			{
+				c.store(0, std::memory_order_relaxed);
+			}
+			p_total.store(0, std::memory_order_relaxed);
+		}
+
+	private:
+		std::atomic<std::uint64_t> p_counts[c_buckets];
+		std::atomic<std::uint64_t> p_total;
+	};
+
+	constexpr std::size_t TimeHistogram::c_sub_buckets;
+	constexpr unsigned TimeHistogram::c_sub_bits;
+	constexpr std::size_t TimeHistogram::c_buckets;
+
+	/**
+	 * @brief Records the time from its construction to its destruction
+	 *
+	 * @param Clock SteadyClock, TscClock or any type with the same members
+	 *
+	 * Reads the clock once at each end and converts only the difference to
+	 * nanoseconds, so the cost is two clock reads and one histogram update.
+	 */
+	template<typename Clock = ProfileClock>
+	class ScopedTimer
+	{
+	public:
+		using Duration = typename Clock::Duration;
+
+		explicit ScopedTimer(TimeHistogram& histogram)
+			:p_histogram(histogram), p_start(Clock::ticks())
+		{}
+
+		ScopedTimer(ScopedTimer const&) = delete;
+		ScopedTimer& operator=(ScopedTimer const&) = delete;
+
+		~ScopedTimer()
+		{
+			p_histogram.record(elapsed());
+		}
+
+		/**
+		 * The time since construction
+		 */
+		Duration elapsed() const
+		{
+			return Clock::elapsed(p_start, Clock::ticks());
+		}
+
+	private:
+		TimeHistogram& p_histogram;
+		std::uint64_t const p_start;
+	};
+}
+
+#undef MESI_HAS_TSC
@@ -0,0 +1,202 @@
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <type_traits>
+#include "mesicore.h"
+#include "mesispan.h"
+
+/*
+ * Complex quantities, e.g. for AC circuit analysis:
+ *
+ *     using ComplexVolts = Mesi::Type<std::complex<float>, 2, -3, 1, -1>;
+ *     using ComplexAmperes = Mesi::Type<std::complex<float>, 0, 0, 0, 1>;
+ *     auto impedance = voltage / current;            // complex Ohms
+ *     Mesi::Ohms size = Mesi::magnitude(impedance);  // real Ohms
+ *     Mesi::Scalar lag = Mesi::phase(impedance);     // radians
+ *
+ * Any std::complex can be used as a storage type with mesicore.h alone;
+ * this header adds the real-valued accessors, scale conversions in the
+ * real type, and batch products and quotients. Complex quantities can only
+ * be compared for equality.
+ */
+namespace Mesi {
+	template<typename T>
+	struct RealType<std::complex<T>>
+	{
+		using Type = T;
+	};
+
+	namespace _internal {
+		template<typename T>
+		struct IsComplex : std::false_type {};
+
+		template<typename T>
+		struct IsComplex<std::complex<T>> : std::true_type {};
+
+		/**
+		 * The real quantity with the units of complex quantity Q, or no type
+		 * if Q isn't complex, which removes the functions below from
+		 * overload resolution
+		 */
+		template<typename Q, bool = IsComplex<typename Q::BaseType>::value>
+		struct RealQuantity {};
+
+		template<typename Q>
+		struct RealQuantity<Q, true>
+		{
+			using Type = typename Restored<Q, typename RealType<typename Q::BaseType>::Type>::Type;
+		};
+
+		template<typename Q>
+		using IfComplex = typename RealQuantity<Q>::Type;
+
+		/**
+		 * (a + bi)(c + di) over n interleaved complex numbers. Each part is
+		 * written as its own expression so compilers can vectorise the
+		 * loop, pairing the parts with shuffles. Infinities and NaNs aren't
+		 * treated specially, as std::complex's operators must (as with
+		 * -fcx-limited-range).
+		 */
+		template<typename R>
+		void ComplexMultiply(R const* a, R const* b, R* out, std::size_t const n)
+		{
+			for(std::size_t i = 0; i < n; i++)
+			{
+				R const ar = a[2 * i];
+				R const ai = a[2 * i + 1];
+				R const br = b[2 * i];
+				R const bi = b[2 * i + 1];
+				out[2 * i] = ar * br - ai * bi;
+				out[2 * i + 1] = ar * bi + ai * br;
+			}
+		}
+
+		/**
+		 * (a + bi) / (c + di) as (a + bi)(c - di) / (c^2 + d^2), without
+		 * the rescaling std::complex does, so |c + di| must be below the
+		 * square root of the largest R (about 1.8e19 for float)
+		 */
+		template<typename R>
+		void ComplexDivide(R const* a, R const* b, R* out, std::size_t const n)
+		{
+			for(std::size_t i = 0; i < n; i++)
+			{
+				R const ar = a[2 * i];
+				R const ai = a[2 * i + 1];
+				R const br = b[2 * i];
+				R const bi = b[2 * i + 1];
+				R const scale = R(1) / (br * br + bi * bi);
+				out[2 * i] = (ar * br + ai * bi) * scale;
+				out[2 * i + 1] = (ai * br - ar * bi) * scale;
+			}
+		}
+
+		/**
+		 * The real and imaginary parts of contiguous complex quantities, which
+		 * std::complex guarantees are laid out as an array of two
+		 */
+		template<typename Container>
+		auto ComplexParts(Container& c)
+		{
+			using Real = typename RealType<typename ElementType<Container>::BaseType>::Type;
+			using Part = typename std::conditional<std::is_const<typename std::remove_pointer<decltype(BaseData(c))>::type>::value,
+				Real const, Real>::type;
+			return reinterpret_cast<Part*>(BaseData(c));
+		}
+
+		template<typename Result, typename Outs>
+		void CheckComplexOutput()
+		{
+			static_assert(std::is_same<ElementType<Outs>, Result>::value,
+				"The output must have the type of the product or quotient");
+		}
+	}
+
+	/**
+	 * The magnitude of a complex quantity, as a real quantity with the same
+	 * units
+	 */
+	template<typename Q>
+	_internal::IfComplex<Q> magnitude(Q const& z)
+	{
+		return _internal::IfComplex<Q>(std::abs(z.val));
+	}
+
+	/**
+	 * The phase of a complex quantity in radians, from -pi to pi
+	 */
+	template<typename Q>
+	typename _internal::IfComplex<Q>::ScalarType phase(Q const& z)
+	{
+		return typename _internal::IfComplex<Q>::ScalarType(std::arg(z.val));
+	}
+
+	template<typename Q>
+	constexpr _internal::IfComplex<Q> real(Q const& z)
+	{
+		return _internal::IfComplex<Q>(z.val.real());
+	}
+
+	template<typename Q>
+	constexpr _internal::IfComplex<Q> imag(Q const& z)
+	{
+		return _internal::IfComplex<Q>(z.val.imag());
+	}
+
+	/**
+	 * The squared magnitude, which is cheaper than the magnitude
+	 */
+	template<typename Q>
+	typename _internal::IfComplex<Q>::template Pow<std::ratio<2>> norm(Q const& z)
+	{
+		return typename _internal::IfComplex<Q>::template Pow<std::ratio<2>>(std::norm(z.val));
+	}
+
+	template<typename Q>
+	auto conj(Q const& z) -> decltype(void(std::declval<_internal::IfComplex<Q>>()), Q())
+	{
+		return Q(std::conj(z.val));
+	}
+
+	/**
+	 * The complex quantity with the given real magnitude and phase in
+	 * radians
+	 */
+	template<typename T, typename t_m, typename t_s, typename t_kg, typename t_A, typename t_K, typename t_mol, typename t_cd, typename t_scale>
+	RationalTypeReduced<std::complex<T>, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale> polar(
+		RationalTypeReduced<T, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale> const& magnitude,
+		typename RationalTypeReduced<T, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale>::ScalarType const& phase)
+	{
+		return RationalTypeReduced<std::complex<T>, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale>(std::polar(magnitude.val, phase.val));
+	}
+
+	/**
+	 * out[i] = a[i] * b[i] over containers of complex quantities, e.g. the
+	 * voltages across an impedance at each frequency of a sweep. out must
+	 * hold the product type, and only the common length is written.
+	 */
+	template<typename As, typename Bs, typename Outs>
+	auto multiply(As const& a, Bs const& b, Outs&& out)
+		-> decltype(void(std::declval<_internal::IfComplex<_internal::ElementType<As>>>()),
+			void(std::declval<_internal::IfComplex<_internal::ElementType<Bs>>>()))
+	{
+		_internal::CheckComplexOutput<decltype(_internal::ElementType<As>() * _internal::ElementType<Bs>()), Outs>();
+		_internal::ComplexMultiply(_internal::ComplexParts(a), _internal::ComplexParts(b), _internal::ComplexParts(out),
+			_internal::CommonSize(a, b, out));
+	}
+
+	/**
+	 * out[i] = a[i] / b[i] over containers of complex quantities, e.g. the
+	 * impedances at each frequency of a sweep. See _internal::ComplexDivide
+	 * for its range.
+	 */
+	template<typename As, typename Bs, typename Outs>
+	auto divide(As const& a, Bs const& b, Outs&& out)
+		-> decltype(void(std::declval<_internal::IfComplex<_internal::ElementType<As>>>()),
+			void(std::declval<_internal::IfComplex<_internal::ElementType<Bs>>>()))
+	{
+		_internal::CheckComplexOutput<decltype(_internal::ElementType<As>() / _internal::ElementType<Bs>()), Outs>();
+		_internal::ComplexDivide(_internal::ComplexParts(a), _internal::ComplexParts(b), _internal::ComplexParts(out),
+			_internal::CommonSize(a, b, out));
+	}
+}
@@ -0,0 +1,570 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <ratio>
+#include <type_traits>
+#include <vector>
+#include "mesicore.h"
+#include "mesispan.h"
+
+namespace Mesi {
+	namespace _internal {
+		/**
+		 * Writes bits most-significant first into a vector of 64-bit words
+		 */
+		class BitWriter
+		{
+		public:
+			explicit BitWriter(std::size_t header_words)
+				:p_words(header_words, 0), p_bit(header_words * 64)
+			{}
+
+			/**
+			 * Appends the low `bits` bits of value, for bits in [1, 64]
+			 */
+			void write(uint64_t value, int bits)
+			{
+				if(bits < 64)
+				{
+					value &= (uint64_t(1) << bits) - 1;
+				}
+				int const used = int(p_bit & 63);
+				if(used == 0)
+				{
+					p_words.push_back(0);
+				}
+				int const free = 64 - used;
+				if(bits <= free)
+				{
+					p_words.back() |= value << (free - bits);
+				}
+				else
+				{
+					p_words.back() |= value >> (bits - free);
+					p_words.push_back(value << (64 - (bits - free)));
+				}
+				p_bit += uint64_t(bits);
+			}
+
+			std::vector<uint64_t>& words() { return p_words; }
+			std::vector<uint64_t> const& words() const { return p_words; }
+
+		private:
+			std::vector<uint64_t> p_words;
+			uint64_t p_bit;
+		};
+
+		/**
+		 * Reads bits written by BitWriter
+		 */
+		class BitReader
+		{
+		public:
+			/**
+			 * Reads words[0, size) from bit `bit` on
+			 */
+			BitReader(uint64_t const* words, std::size_t size, uint64_t bit)
+				:p_words(words), p_bit(bit), p_end(uint64_t(size) * 64), p_overrun(bit > p_end)
+			{}
+
+			/**
+			 * Reads `bits` bits, for bits in [1, 64]. With t_checked, returns 0
+			 * and marks the reader overrun if fewer are left; without, the
+			 * caller must know they are there.
+			 */
+			template<bool t_checked>
+			uint64_t read(int bits)
+			{
+				if(t_checked && (p_overrun || p_end - p_bit < uint64_t(bits)))
+				{
+					p_overrun = true;
+					return 0;
+				}
+				uint64_t const word = p_bit >> 6;
+				int const used = int(p_bit & 63);
+				uint64_t ret = p_words[word] << used;
+				if(used + bits > 64)
+				{
+					ret |= p_words[word + 1] >> (64 - used);
+				}
+				p_bit += uint64_t(bits);
+				return ret >> (64 - bits);
+			}
+
+			template<bool t_checked>
+			bool readBit()
+			{
+				if(t_checked && (p_overrun || p_bit == p_end))
+				{
+					p_overrun = true;
+					return false;
+				}
+				bool const ret = (p_words[p_bit >> 6] >> (63 - (p_bit & 63))) & 1;
+				p_bit++;
+				return ret;
+			}
+
+			/**
+			 * Counts 1 bits before the next 0, reading at most `max` bits
+			 */
+			template<bool t_checked>
+			int readOnes(int max)
+			{
+				int n = 0;
+				while(n < max && readBit<t_checked>())
+				{
+					n++;
+				}
+				return n;
+			}
+
+			/**
+			 * Bits left before the end of the words
+			 */
+			uint64_t remaining() const { return p_overrun ? 0 : p_end - p_bit; }
+
+			/**
+			 * Whether a read went past the end of the words, or the data was
+			 * otherwise found to be corrupt
+			 */
+			bool overrun() const { return p_overrun; }
+
+			void fail() { p_overrun = true; }
+
+		private:
+			uint64_t const* p_words;
+			uint64_t p_bit;
+			uint64_t p_end;
+			bool p_overrun;
+		};
+
+		template<int t_bits>
+		struct UnsignedOfSize;
+		template<> struct UnsignedOfSize<32> { using type = uint32_t; };
+		template<> struct UnsignedOfSize<64> { using type = uint64_t; };
+
+		inline int LeadingZeros(uint64_t x) { return x ? __builtin_clzll(x) : 64; }
+		inline int TrailingZeros(uint64_t x) { return x ? __builtin_ctzll(x) : 64; }
+
+		/**
+		 * Packs two values that must fit in 32 bits into one header word
+		 */
+		template<intmax_t a, intmax_t b>
+		struct HeaderPair
+		{
+			static_assert(a >= INT32_MIN && a <= INT32_MAX && b >= INT32_MIN && b <= INT32_MAX,
+				"Scales and exponents must fit in 32 bits to be stored in a block header");
+			static constexpr uint64_t value = (uint64_t(uint32_t(int32_t(a))) << 32) | uint64_t(uint32_t(int32_t(b)));
+		};
+
+		/**
+		 * Header words describing a scale
+		 */
+		template<typename t_scale>
+		struct ScaleSignature
+		{
+			static constexpr std::size_t size = 3;
+			static void write(uint64_t* out)
+			{
+				out[0] = HeaderPair<t_scale::ratio::num, t_scale::ratio::den>::value;
+				out[1] = HeaderPair<t_scale::exponent_denominator, 0>::value;
+				out[2] = HeaderPair<t_scale::power_of_ten::num, t_scale::power_of_ten::den>::value;
+			}
+		};
+
+		/**
+		 * Header words describing the dimensions and scale of a Mesi type
+		 */
+		template<typename Q>
+		struct TypeSignature
+		{
+			static constexpr std::size_t size = 7 + ScaleSignature<typename Q::ScaleInfo>::size;
+			static void write(uint64_t* out)
+			{
+				out[0] = HeaderPair<Q::MeterExponent::num, Q::MeterExponent::den>::value;
+				out[1] = HeaderPair<Q::SecondExponent::num, Q::SecondExponent::den>::value;
+				out[2] = HeaderPair<Q::KilogramExponent::num, Q::KilogramExponent::den>::value;
+				out[3] = HeaderPair<Q::AmpereExponent::num, Q::AmpereExponent::den>::value;
+				out[4] = HeaderPair<Q::KelvinExponent::num, Q::KelvinExponent::den>::value;
+				out[5] = HeaderPair<Q::MoleExponent::num, Q::MoleExponent::den>::value;
+				out[6] = HeaderPair<Q::CandelaExponent::num, Q::CandelaExponent::den>::value;
+				ScaleSignature<typename Q::ScaleInfo>::write(out + 7);
+			}
+		};
+
+		/**
+		 * Whether Q has the dimensions of time
+		 */
+		template<typename Q>
+		struct IsTime
+		{
+			static constexpr bool value =
+				Q::MeterExponent::num == 0 && Q::SecondExponent::num == 1 && Q::SecondExponent::den == 1 &&
+				Q::KilogramExponent::num == 0 && Q::AmpereExponent::num == 0 && Q::KelvinExponent::num == 0 &&
+				Q::MoleExponent::num == 0 && Q::CandelaExponent::num == 0;
+		};
+
+		/**
+		 * Layout of the block header shared by the encoder and decoder
+		 */
+		template<typename Quantity, typename Time>
+		struct TimeSeriesHeader
+		{
+			static constexpr uint64_t magic = 0x4d4553495453ull; // "MESITS"
+			static constexpr uint64_t version = 1;
+			static constexpr int value_bits = int(sizeof(typename Quantity::BaseType) * 8);
+
+			static constexpr std::size_t count_word = 1;
+			static constexpr std::size_t value_signature_word = 2;
+			static constexpr std::size_t time_signature_word = value_signature_word + TypeSignature<Quantity>::size;
+			static constexpr std::size_t size = time_signature_word + ScaleSignature<typename Time::ScaleInfo>::size;
+
+			static uint64_t firstWord()
+			{
+				return (magic << 8 | version) << 8 | uint64_t(value_bits);
+			}
+
+			static void write(uint64_t* out)
+			{
+				out[0] = firstWord();
+				out[count_word] = 0;
+				TypeSignature<Quantity>::write(out + value_signature_word);
+				ScaleSignature<typename Time::ScaleInfo>::write(out + time_signature_word);
+			}
+
+			static bool matches(uint64_t const* in)
+			{
+				uint64_t expected[size];
+				write(expected);
+				return in[0] == expected[0] && std::memcmp(in + value_signature_word, expected + value_signature_word, (size - value_signature_word) * sizeof(uint64_t)) == 0;
+			}
+		};
+	}
+
+	/**
+	 * Nanoseconds stored as 64-bit integers, the default timestamp type for
+	 * compressed time series
+	 */
+	using NanosecondTimestamps = Nano<Type<int64_t, 0, 1, 0>>;
+
+	/**
+	 * @brief Compresses a stream of timestamped quantities (Gorilla encoding)
+	 *
+	 * @param Quantity the Mesi type of the values, with a float or double
+	 *        storage type
+	 * @param Time the Mesi type of the timestamps, which must be a time with
+	 *        an integral storage type
+	 *
+	 * Timestamps are stored as delta-of-deltas, so regularly sampled streams
+	 * cost about one bit per timestamp. Values are XORed with their
+	 * predecessor and only the changed bits are stored, so slowly changing
+	 * values compress well.
+	 *
+	 * The block starts with a header holding the dimensions and scales of
+	 * both types, so a TimeSeriesDecoder can check it is decoding into the
+	 * same types. Samples can be appended at any time; words() is always a
+	 * complete, decodable block.
+	 */
+	template<typename Quantity, typename Time = NanosecondTimestamps>
+	class TimeSeriesEncoder
+	{
+		using Header = _internal::TimeSeriesHeader<Quantity, Time>;
+		using Bits = typename _internal::UnsignedOfSize<Header::value_bits>::type;
+		static constexpr int c_value_bits = Header::value_bits;
+		static constexpr int c_field_bits = c_value_bits == 64 ? 6 : 5;
+
+	public:
+		static_assert(std::is_floating_point<typename Quantity::BaseType>::value, "Values must be stored as float or double");
+		static_assert(std::is_integral<typename Time::BaseType>::value, "Timestamps must have an integral storage type");
+		static_assert(_internal::IsTime<Time>::value, "Timestamps must be times");
+
+		TimeSeriesEncoder()
+			:p_writer(Header::size), p_count(0),
+			p_previous_time(0), p_previous_delta(0), p_previous_value(0),
+			p_leading(c_value_bits), p_trailing(0)
+		{
+			Header::write(p_writer.words().data());
+		}
+
+		void append(Time const& time, Quantity const& value)
+		{
+			int64_t const t = int64_t(time.val);
+			Bits v;
+			std::memcpy(&v, &value.val, sizeof(v));
+
+			if(p_count == 0)
+			{
+				p_writer.write(uint64_t(t), 64);
+				p_writer.write(v, c_value_bits);
+			}
+			else
+			{
+				int64_t const delta = t - p_previous_time;
+				appendTimestamp(delta - p_previous_delta);
+				appendValue(v ^ p_previous_value);
+				p_previous_delta = delta;
+			}
+
+			p_previous_time = t;
+			p_previous_value = v;
+			p_count++;
+			p_writer.words()[Header::count_word] = p_count;
+		}
+
+		void append(Span<Time const> times, Span<Quantity const> values)
+		{
+			std::size_t const n = times.size() < values.size() ? times.size() : values.size();
+			for(std::size_t i = 0; i < n; i++)
+			{
+				append(times[i], values[i]);
+			}
+		}
+
+		uint64_t count() const { return p_count; }
+
+		/**
+		 * The encoded block, including its header
+		 */
+		Span<uint64_t const> words() const { return p_writer.words(); }
+
+		std::size_t sizeInBytes() const { return p_writer.words().size() * sizeof(uint64_t); }
+
+	private:
+		/**
+		 * Variable length code for a delta-of-delta: a prefix of ones
+		 * selects the size of the field that follows
+		 */
+		void appendTimestamp(int64_t dod)
+		{
+			if(dod == 0)
+			{
+				p_writer.write(0, 1);
+			}
+			else if(dod >= -63 && dod <= 64)
+			{
+				p_writer.write(0x2, 2);
+				p_writer.write(uint64_t(dod), 7);
+			}
+			else if(dod >= -255 && dod <= 256)
+			{
+				p_writer.write(0x6, 3);
+				p_writer.write(uint64_t(dod), 9);
+			}
+			else if(dod >= -2047 && dod <= 2048)
+			{
+				p_writer.write(0xe, 4);
+				p_writer.write(uint64_t(dod), 12);
+			}
+			else
+			{
+				p_writer.write(0xf, 4);
+				p_writer.write(uint64_t(dod), 64);
+			}
+		}
+
+		/**
+		 * A zero XOR is a single 0 bit. Otherwise the meaningful bits are
+		 * stored, reusing the previous leading/trailing zero window when
+		 * they fit inside it.
+		 */
+		void appendValue(Bits x)
+		{
+			if(x == 0)
+			{
+				p_writer.write(0, 1);
+				return;
+			}
+			int const leading = _internal::LeadingZeros(x) - (64 - c_value_bits);
+			int const trailing = _internal::TrailingZeros(x);
+			if(leading >= p_leading && trailing >= p_trailing)
+			{
+				p_writer.write(0x2, 2);
+				p_writer.write(x >> p_trailing, c_value_bits - p_leading - p_trailing);
+			}
+			else
+			{
+				int const meaningful = c_value_bits - leading - trailing;
+				p_writer.write(0x3, 2);
+				p_writer.write(uint64_t(leading), c_field_bits);
+				p_writer.write(uint64_t(meaningful - 1), c_field_bits);
+				p_writer.write(x >> trailing, meaningful);
+				p_leading = leading;
+				p_trailing = trailing;
+			}
+		}
+
+		_internal::BitWriter p_writer;
+		uint64_t p_count;
+		int64_t p_previous_time;
+		int64_t p_previous_delta;
+		Bits p_previous_value;
+		int p_leading;
+		int p_trailing;
+	};
+
+	/**
+	 * @brief Decodes blocks written by TimeSeriesEncoder
+	 *
+	 * The decoder must be instantiated with the same types as the encoder;
+	 * valid() reports whether the block header matches them. Samples are
+	 * decoded in order, in as many calls to decode() as needed.
+	 */
+	template<typename Quantity, typename Time = NanosecondTimestamps>
+	class TimeSeriesDecoder
+	{
+		using Header = _internal::TimeSeriesHeader<Quantity, Time>;
+		using Bits = typename _internal::UnsignedOfSize<Header::value_bits>::type;
+		static constexpr int c_value_bits = Header::value_bits;
+		static constexpr int c_field_bits = c_value_bits == 64 ? 6 : 5;
+
+	public:
+		explicit TimeSeriesDecoder(Span<uint64_t const> block)
+			:p_valid(block.size() >= Header::size && Header::matches(block.data())),
+			p_reader(block.data(), block.size(), Header::size * 64),
+			p_count(p_valid ? block[Header::count_word] : 0), p_decoded(0),
+			p_previous_time(0), p_previous_delta(0), p_previous_value(0),
+			p_leading(0), p_trailing(0)
+		{
+			// The first sample takes 64 + c_value_bits bits and each later one
+			// at least two, so a larger count than that can't be right
+			uint64_t const bits = p_reader.remaining();
+			uint64_t const first = 64 + c_value_bits;
+			if(p_count > 0 && (bits < first || p_count - 1 > (bits - first) / 2))
+			{
+				p_valid = false;
+				p_count = 0;
+			}
+		}
+
+		/**
+		 * Whether the block was written for the same Quantity and Time types,
+		 * and, so far, decodes within its length. A truncated or corrupt
+		 * block makes this false once decoding reaches the damage.
+		 */
+		bool valid() const { return p_valid && !p_reader.overrun(); }
+
+		/**
+		 * Samples not yet decoded
+		 */
+		uint64_t remaining() const { return p_count - p_decoded; }
+
+		/**
+		 * Decodes the next samples into times and values, returning how many
+		 * were decoded. Stops early, and decodes nothing more, if the block
+		 * turns out to be truncated or corrupt.
+		 */
+		std::size_t decode(Span<Time> times, Span<Quantity> values)
+		{
+			std::size_t n = times.size() < values.size() ? times.size() : values.size();
+			n = n < remaining() ? n : std::size_t(remaining());
+			using TimeBase = typename Time::BaseType;
+			using ValueBase = typename Quantity::BaseType;
+			Time* time_out = times.data();
+			Quantity* value_out = values.data();
+
+			for(std::size_t i = 0; i < n; i++)
+			{
+				// Reads are only bounds-checked near the end of the block
+				if(p_reader.remaining() >= c_max_sample_bits)
+				{
+					decodeSample<false>();
+				}
+				else
+				{
+					decodeSample<true>();
+				}
+				if(p_reader.overrun())
+				{
+					p_count = p_decoded;
+					return i;
+				}
+				ValueBase v;
+				std::memcpy(&v, &p_previous_value, sizeof(v));
+				time_out[i] = Time(TimeBase(p_previous_time));
+				value_out[i] = Quantity(v);
+				p_decoded++;
+			}
+			return n;
+		}
+
+	private:
+		/**
+		 * The most bits one sample can take: the longest timestamp code and
+		 * a value with a new window, or the first sample
+		 */
+		static constexpr uint64_t c_max_sample_bits = (4 + 64) + (2 + 2 * c_field_bits + c_value_bits);
+
+		template<bool t_checked>
+		void decodeSample()
+		{
+			if(p_decoded == 0)
+			{
+				p_previous_time = int64_t(p_reader.template read<t_checked>(64));
+				p_previous_value = Bits(p_reader.template read<t_checked>(c_value_bits));
+			}
+			else
+			{
+				p_previous_delta += readTimestamp<t_checked>();
+				p_previous_time += p_previous_delta;
+				p_previous_value ^= readValue<t_checked>();
+			}
+		}
+
+		template<bool t_checked>
+		int64_t readTimestamp()
+		{
+			switch(p_reader.template readOnes<t_checked>(4))
+			{
+				case 0: return 0;
+				case 1: return SignExtend(p_reader.template read<t_checked>(7), 7);
+				case 2: return SignExtend(p_reader.template read<t_checked>(9), 9);
+				case 3: return SignExtend(p_reader.template read<t_checked>(12), 12);
+				default: return int64_t(p_reader.template read<t_checked>(64));
+			}
+		}
+
+		template<bool t_checked>
+		Bits readValue()
+		{
+			if(!p_reader.template readBit<t_checked>())
+			{
+				return 0;
+			}
+			if(p_reader.template readBit<t_checked>())
+			{
+				p_leading = int(p_reader.template read<t_checked>(c_field_bits));
+				int const meaningful = int(p_reader.template read<t_checked>(c_field_bits)) + 1;
+				if(p_leading + meaningful > c_value_bits)
+				{
+					p_reader.fail();
+					p_leading = p_trailing = 0;
+					return 0;
+				}
+				p_trailing = c_value_bits - p_leading - meaningful;
+			}
+			return Bits(p_reader.template read<t_checked>(c_value_bits - p_leading - p_trailing) << p_trailing);
+		}
+
+		/**
+		 * Interprets the low `bits` bits of x as a two's complement number.
+		 * Fields store values in [-(2^(bits-1) - 1), 2^(bits-1)], so the
+		 * top of the range wraps round to a positive value.
+		 */
+		static int64_t SignExtend(uint64_t x, int bits)
+		{
+			int64_t const half = int64_t(1) << (bits - 1);
+			int64_t const v = int64_t(x);
+			return v > half ? v - (half << 1) : v;
+		}
+
+		bool p_valid;
+		_internal::BitReader p_reader;
+		uint64_t p_count;
+		uint64_t p_decoded;
+		int64_t p_previous_time;
+		int64_t p_previous_delta;
+		Bits p_previous_value;
+		int p_leading;
+		int p_trailing;
+	};
+}
@@ -0,0 +1,1444 @@
+#pragma once
+
+#include <cstdint>
+#include <ratio>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Defined as `export` by mesi.cppm when building the C++20 module
+ */
+#ifndef MESI_EXPORT
+#	define MESI_EXPORT
+#endif
+
+/*
+ * Whether the compiler can tell constant evaluation apart, so the maths
+ * functions can avoid libm calls at compile time. Every version of g++
+ * and MSVC with the builtin predates __has_builtin.
+ */
+#if defined(__has_builtin)
+#	if __has_builtin(__builtin_is_constant_evaluated)
+#		define MESI_HAS_CONSTANT_EVALUATED 1
+#	endif
+#endif
+#if !defined(MESI_HAS_CONSTANT_EVALUATED) && ((defined(__GNUC__) && __GNUC__ >= 9 && !defined(__clang__)) || (defined(_MSC_VER) && _MSC_VER >= 1925))
+#	define MESI_HAS_CONSTANT_EVALUATED 1
+#endif
+
+MESI_EXPORT namespace Mesi {
+	namespace _internal {
+		/**
+		 * Multiply two values, raising a compile-time error on overflow
+		 */
+		template<intmax_t a, intmax_t b>
+		struct Mul
+		{
+			static_assert(a == 0 || b == 0 ||
+				(a > 0 ? (b > 0 ? a <= INTMAX_MAX / b : b >= INTMAX_MIN / a)
+				       : (b > 0 ? a >= INTMAX_MIN / b : b >= INTMAX_MAX / a)),
+				"a*b must not overflow");
+			static constexpr intmax_t value = a*b;
+		};
+
+		/**
+		 * Raises base to the pow-th power by repeated squaring, so the
+		 * recursion is only log2(pow) levels deep, raising a compile-time
+		 * error on overflow
+		 */
+		template<intmax_t base, intmax_t pow>
+		struct Exp : public Mul<Mul<Exp<base, pow/2>::value, Exp<base, pow/2>::value>::value, (pow % 2) ? base : 1> {};
+
+		/**
+		 * Ends of the recursion
+		 */
+		template<intmax_t base>
+		struct Exp<base, 1>
+		{
+			static constexpr intmax_t value = base;
+		};
+
+		template<intmax_t base>
+		struct Exp<base, 0>
+		{
+			static constexpr intmax_t value = 1;
+		};
+
+		/**
+		 * Type to hold scaling information for Mesi types.
+		 *
+		 * The full scaling factor is t_ratio^(1/t_exponent_denominator) * 10^t_power_of_ten,
+		 * with t_ratio and t_power_of_ten being std::ratio<>s
+		 */
+		template<typename t_ratio, intmax_t t_exponent_denominator, typename t_power_of_ten>
+		struct Scale
+		{
+			static_assert(t_exponent_denominator > 0, "The exponent denominator must be positive");
+		private:
+			template<typename T, typename p>
+			struct PowerOfTenValue
+			{
+				static T value()
+				{
+					static T v = pow(T(10), T(p::num)/T(p::den));
+					return v;
+				}
+			};
+
+			template<typename T, intmax_t num>
+			struct PowerOfTenValue<T, std::ratio<num,1>>
+			{
+			private:
+				/*
+				 * Negative powers divide once by the positive power, which is
+				 * exact while it fits in T's mantissa, so e.g. milli gives the
+				 * closest T to 0.001 rather than accumulating three roundings
+				 */
+				static constexpr T calculate_value() {
+					T ret = 1;
+					for(intmax_t i = 0; i < num || i < -num; i++)
+					{
+						ret *= T(10);
+					}
+					return num < 0 ? T(T(1) / ret) : ret;
+				}
+			public:
+				static constexpr T value()
+				{
+					constexpr T v = calculate_value();
+					return v;
+				}
+			};
+			template<typename T, typename r, intmax_t e>
+			struct RatioValue
+			{
+				static T value()
+				{
+					static T v = pow(T(r::num)/T(r::den), T(1)/T(e));
+					return v;
+				}
+			};
+			template<typename T, typename r>
+			struct RatioValue<T, r, 1>
+			{
+				static constexpr T value()
+				{
+					constexpr T v = T(r::num)/T(r::den);
+					return v;
+				}
+			};
+			template<typename T, typename ratio, intmax_t exponent_denominator, typename power_of_ten>
+			static constexpr T calculate_value()
+			{
+				return RatioValue<T, ratio, exponent_denominator>::value() * PowerOfTenValue<T, power_of_ten>::value();
+			}
+		public:
+			using ratio = t_ratio;
+			using power_of_ten = t_power_of_ten;
+			static constexpr intmax_t exponent_denominator = t_exponent_denominator;
+			
+			/**
+			 * Calculates the full scaling factor as type T, possibly as a
+			 * constexpr.  This can only be constexpr if exponent_denominator
+			 * is 1 and power_of_ten an integer, because otherwise the
+			 * non-constexpr pow() has to be used.
+			 */
+			template<typename T>
+			static constexpr T value()
+			{
+				return calculate_value<T, ratio, exponent_denominator, power_of_ten>();
+			}
+
+			/**
+			 * The inverse of the type, i.e. 1/Scale
+			 */
+			using Inverse = Scale<std::ratio<ratio::den, ratio::num>, exponent_denominator, std::ratio<-power_of_ten::num, power_of_ten::den>>;
+			
+		};
+
+		/**
+		 * Convenience definition for a scaling factor of 1
+		 */
+		using ScaleOne = Scale<std::ratio<1,1>, 1, std::ratio<0,1>>;
+		
+		/**
+		 * std::ratio<2,2> is not the same as std::ratio<1,1>. We can use this
+		 * template to reduce the ratio before using it as a template argument.
+		 */
+		template<typename t>
+		struct RatioSimplify
+		{
+			using ratio = std::ratio<t::num,t::den>;
+		};
+
+		/**
+		 * Greatest common divisor of |a| and |b|
+		 */
+		constexpr intmax_t Gcd(intmax_t a, intmax_t b)
+		{
+			a = a < 0 ? -a : a;
+			b = b < 0 ? -b : b;
+			while(b != 0)
+			{
+				intmax_t const t = a % b;
+				a = b;
+				b = t;
+			}
+			return a;
+		}
+
+		/**
+		 * Compares base^exp with limit, for positive base and limit,
+		 * returning -1, 0 or 1. Computed by repeated squaring, and stops as
+		 * soon as the power exceeds the limit so it can't overflow.
+		 */
+		constexpr int ComparePower(intmax_t base, intmax_t exp, intmax_t limit)
+		{
+			intmax_t ret = 1;
+			while(exp > 0)
+			{
+				if(exp % 2)
+				{
+					if(ret > limit / base)
+					{
+						return 1;
+					}
+					ret *= base;
+				}
+				exp /= 2;
+				if(exp > 0)
+				{
+					// Another factor of at least base^2 is still to come
+					if(base > limit / base)
+					{
+						return 1;
+					}
+					base *= base;
+				}
+			}
+			return ret < limit ? -1 : (ret == limit ? 0 : 1);
+		}
+
+		/**
+		 * The r-th root of base if it is an integer, or 0 otherwise. Found
+		 * by binary search, so this takes O(log(base)) steps.
+		 */
+		constexpr intmax_t IntegerRoot(intmax_t base, intmax_t r)
+		{
+			if(base < 2)
+			{
+				return base == 1 ? 1 : 0;
+			}
+			intmax_t lo = 1;
+			intmax_t hi = base;
+			while(lo < hi)
+			{
+				intmax_t const mid = lo + (hi - lo + 1) / 2;
+				if(ComparePower(mid, r, base) <= 0)
+				{
+					lo = mid;
+				}
+				else
+				{
+					hi = mid - 1;
+				}
+			}
+			return ComparePower(lo, r, base) == 0 ? lo : 0;
+		}
+
+		/**
+		 * Computes t_s1^t_p1 * t_s2^t_p2 for two scales and two std::ratio
+		 * powers, giving the result as a simplified Scale.
+		 *
+		 * Scales are broken down into a product of bases raised to rational
+		 * exponents, times a rational power of ten, and all the arithmetic
+		 * is done on the exponents, so only the final simplified ratio has
+		 * to fit in intmax_t. Factors below c_small_prime_limit are found by
+		 * trial division; anything left over is kept as a large base, and
+		 * large bases are split on their common divisors until they are
+		 * coprime. Each is then replaced by its smallest integer root, so the
+		 * exponent denominators tell exactly which roots can be taken.
+		 *
+		 * The simplified form has the smallest possible exponent
+		 * denominator, and no factors of ten left in the ratio, e.g.
+		 * (9/4)^(1/2) -> 3/2 and (40)^(1/2) -> 2^(1/2) * 10^(1/2).
+		 */
+		template<typename t_s1, typename t_p1, typename t_s2, typename t_p2>
+		struct ScaleCombine
+		{
+		private:
+			/**
+			 * Helper struct to do the actual calculations in its constructor
+			 */
+			struct Helper
+			{
+				static constexpr int c_capacity = 64;
+				static constexpr intmax_t c_small_prime_limit = 100;
+
+				constexpr Helper()
+				: p_base{}, p_exp_num{}, p_exp_den{}, p_count(0),
+				p_num(1), p_den(1), p_exp_den_out(1), p_ten_num(0), p_ten_den(1),
+				p_zero(false), p_negative(false), p_divide_by_zero(false), p_negative_root(false), p_overflow(false)
+				{
+					addScale(t_s1::ratio::num, t_s1::ratio::den, t_s1::exponent_denominator, t_s1::power_of_ten::num, t_s1::power_of_ten::den, t_p1::num, t_p1::den);
+					addScale(t_s2::ratio::num, t_s2::ratio::den, t_s2::exponent_denominator, t_s2::power_of_ten::num, t_s2::power_of_ten::den, t_p2::num, t_p2::den);
+					if(p_zero || p_divide_by_zero)
+					{
+						p_negative = false;
+						p_ten_num = 0;
+						p_ten_den = 1;
+						return;
+					}
+					makeCoprime();
+					reducePowers();
+					extractTens();
+					build();
+				}
+
+				intmax_t p_base[c_capacity];
+				intmax_t p_exp_num[c_capacity];
+				intmax_t p_exp_den[c_capacity];
+				int p_count;
+
+				intmax_t p_num;
+				intmax_t p_den;
+				intmax_t p_exp_den_out;
+				intmax_t p_ten_num;
+				intmax_t p_ten_den;
+				bool p_zero;
+				bool p_negative;
+				bool p_divide_by_zero;
+				bool p_negative_root;
+				bool p_overflow;
+
+				/**
+				 * Adds (num/den)^(pow/exp_den) * 10^(ten*pow)
+				 */
+				constexpr void addScale(intmax_t num, intmax_t den, intmax_t exp_den, intmax_t ten_num, intmax_t ten_den, intmax_t pow_num, intmax_t pow_den)
+				{
+					if(pow_num == 0)
+					{
+						return;
+					}
+					addTen(ten_num * pow_num, ten_den * pow_den);
+					if(num == 0)
+					{
+						(pow_num > 0 ? p_zero : p_divide_by_zero) = true;
+						return;
+					}
+					intmax_t const g = Gcd(pow_num, pow_den * exp_den);
+					intmax_t const a = pow_num / g;
+					intmax_t const b = pow_den * exp_den / g;
+					if(num < 0)
+					{
+						if(b % 2 == 0)
+						{
+							p_negative_root = true;
+						}
+						if(a % 2 != 0)
+						{
+							p_negative = !p_negative;
+						}
+						num = -num;
+					}
+					addInteger(num, a, b);
+					addInteger(den, -a, b);
+				}
+
+				constexpr void addTen(intmax_t num, intmax_t den)
+				{
+					intmax_t const n = p_ten_num * den + num * p_ten_den;
+					intmax_t const d = p_ten_den * den;
+					intmax_t const g = Gcd(n, d);
+					p_ten_num = g ? n / g : 0;
+					p_ten_den = g ? d / g : 1;
+				}
+
+				/**
+				 * Adds n^(a/b), splitting off small prime factors
+				 */
+				constexpr void addInteger(intmax_t n, intmax_t a, intmax_t b)
+				{
+					for(intmax_t d = 2; d < c_small_prime_limit && n > 1; d++)
+					{
+						intmax_t k = 0;
+						while(n % d == 0)
+						{
+							n /= d;
+							k++;
+						}
+						if(k)
+						{
+							addFactor(d, k * a, b);
+						}
+					}
+					if(n > 1)
+					{
+						addFactor(n, a, b);
+					}
+				}
+
+				/**
+				 * Adds base^(a/b), merging it with an existing equal base
+				 */
+				constexpr void addFactor(intmax_t base, intmax_t a, intmax_t b)
+				{
+					for(int i = 0; i < p_count; i++)
+					{
+						if(p_base[i] == base)
+						{
+							intmax_t const n = p_exp_num[i] * b + a * p_exp_den[i];
+							intmax_t const d = p_exp_den[i] * b;
+							intmax_t const g = Gcd(n, d);
+							p_exp_num[i] = g ? n / g : 0;
+							p_exp_den[i] = g ? d / g : 1;
+							return;
+						}
+					}
+					if(p_count == c_capacity)
+					{
+						p_overflow = true;
+						return;
+					}
+					intmax_t const g = Gcd(a, b);
+					p_base[p_count] = base;
+					p_exp_num[p_count] = a / g;
+					p_exp_den[p_count] = b / g;
+					p_count++;
+				}
+
+				constexpr bool live(int i) const
+				{
+					return p_base[i] > 1 && p_exp_num[i] != 0;
+				}
+
+				/**
+				 * Splits bases on their common divisors until they are all
+				 * coprime: x^a * y^b = (x/g)^a * (y/g)^b * g^(a+b)
+				 */
+				constexpr void makeCoprime()
+				{
+					bool changed = true;
+					while(changed && !p_overflow)
+					{
+						changed = false;
+						for(int i = 0; i < p_count; i++)
+						{
+							for(int j = i + 1; j < p_count; j++)
+							{
+								if(!live(i) || !live(j))
+								{
+									continue;
+								}
+								intmax_t const g = Gcd(p_base[i], p_base[j]);
+								if(g > 1)
+								{
+									p_base[i] /= g;
+									p_base[j] /= g;
+									intmax_t const n = p_exp_num[i] * p_exp_den[j] + p_exp_num[j] * p_exp_den[i];
+									intmax_t const d = p_exp_den[i] * p_exp_den[j];
+									addFactor(g, n, d);
+									changed = true;
+								}
+							}
+						}
+					}
+				}
+
+				/**
+				 * Replaces large bases that are perfect powers by their
+				 * roots, e.g. 10201^(1/2) -> 101. Large bases have no factors
+				 * below c_small_prime_limit, so only low roots are possible.
+				 */
+				constexpr void reducePowers()
+				{
+					for(int i = 0; i < p_count; i++)
+					{
+						for(intmax_t k = 9; k >= 2 && live(i) && p_base[i] >= c_small_prime_limit; k--)
+						{
+							intmax_t const r = IntegerRoot(p_base[i], k);
+							if(r)
+							{
+								intmax_t const g = Gcd(p_exp_num[i] * k, p_exp_den[i]);
+								p_base[i] = r;
+								p_exp_num[i] = p_exp_num[i] * k / g;
+								p_exp_den[i] = p_exp_den[i] / g;
+							}
+						}
+					}
+				}
+
+				constexpr int find(intmax_t base) const
+				{
+					for(int i = 0; i < p_count; i++)
+					{
+						if(p_base[i] == base && live(i))
+						{
+							return i;
+						}
+					}
+					return -1;
+				}
+
+				/**
+				 * Moves matching powers of 2 and 5 into the power of ten
+				 */
+				constexpr void extractTens()
+				{
+					int const i2 = find(2);
+					int const i5 = find(5);
+					if(i2 < 0 || i5 < 0 || (p_exp_num[i2] > 0) != (p_exp_num[i5] > 0))
+					{
+						return;
+					}
+					// The exponent of 2 or 5 closest to zero
+					bool const two_closer = (p_exp_num[i2] > 0) == (p_exp_num[i2] * p_exp_den[i5] < p_exp_num[i5] * p_exp_den[i2]);
+					intmax_t const n = two_closer ? p_exp_num[i2] : p_exp_num[i5];
+					intmax_t const d = two_closer ? p_exp_den[i2] : p_exp_den[i5];
+					addTen(n, d);
+					addFactor(2, -n, d);
+					addFactor(5, -n, d);
+				}
+
+				constexpr intmax_t multiply(intmax_t a, intmax_t b)
+				{
+					if(a > INTMAX_MAX / b)
+					{
+						p_overflow = true;
+						return 1;
+					}
+					return a * b;
+				}
+
+				/**
+				 * Combines the factors into ratio^(1/exp_den)
+				 */
+				constexpr void build()
+				{
+					for(int i = 0; i < p_count; i++)
+					{
+						if(live(i))
+						{
+							p_exp_den_out = multiply(p_exp_den_out / Gcd(p_exp_den_out, p_exp_den[i]), p_exp_den[i]);
+						}
+					}
+					for(int i = 0; i < p_count && !p_overflow; i++)
+					{
+						if(!live(i))
+						{
+							continue;
+						}
+						intmax_t k = p_exp_num[i] * (p_exp_den_out / p_exp_den[i]);
+						intmax_t& target = k > 0 ? p_num : p_den;
+						for(k = k < 0 ? -k : k; k > 0 && !p_overflow; k--)
+						{
+							target = multiply(target, p_base[i]);
+						}
+					}
+					if(p_overflow)
+					{
+						p_num = 1;
+						p_den = 1;
+						p_exp_den_out = 1;
+					}
+				}
+			};
+
+			/**
+			 * Evaluated once and shared by everything below
+			 */
+			static constexpr Helper c_helper = Helper();
+
+			static_assert(!c_helper.p_divide_by_zero, "A scale of zero can't be inverted");
+			static_assert(!c_helper.p_negative_root, "Can't take an even root of a negative scale");
+			static_assert(!c_helper.p_overflow, "The simplified scale does not fit in intmax_t");
+		public:
+			using Scale = _internal::Scale<
+				typename RatioSimplify<std::ratio<c_helper.p_zero ? 0 : (c_helper.p_negative ? -c_helper.p_num : c_helper.p_num), c_helper.p_den>>::ratio,
+				c_helper.p_exp_den_out,
+				std::ratio<c_helper.p_ten_num, c_helper.p_ten_den>
+				>;
+		};
+
+		/**
+		 * Simplifies a scale by reducing any roots where possible, e.g.
+		 * (9/4)^(1/2) -> (3/2)
+		 */
+		template<typename t_s>
+		struct ScaleSimplify
+		{
+			using Scale = typename ScaleCombine<t_s, std::ratio<1,1>, ScaleOne, std::ratio<0,1>>::Scale;
+		};
+
+		/**
+		 * Multiplies two scaling factors and simplifies the result
+		 */
+		template<typename t_s1, typename t_s2>
+		struct ScaleMultiply
+		{
+			using Scale = typename ScaleCombine<t_s1, std::ratio<1,1>, t_s2, std::ratio<1,1>>::Scale;
+		};
+
+		/**
+		 * Divides two scaling factors and simplifies the result
+		 */
+		template<typename t_s1, typename t_s2>
+		struct ScaleDivide
+		{
+			using Scale = typename ScaleCombine<t_s1, std::ratio<1,1>, t_s2, std::ratio<-1,1>>::Scale;
+		};
+
+		/**
+		 * Raises a scaling factor to a rational power
+		 */
+		template<typename t_scale, typename t_power>
+		struct ScalePower
+		{
+			using Scale = typename ScaleCombine<t_scale, t_power, ScaleOne, std::ratio<0,1>>::Scale;
+		};
+
+		/**
+		 * Raises a value to a non-negative integer power by repeated
+		 * squaring, so x^t_pow costs O(log(t_pow)) multiplications
+		 */
+		template<typename T, intmax_t t_pow>
+		struct IntegerPower
+		{
+			static_assert(t_pow >= 0, "Negative powers must be handled by the caller");
+
+			static constexpr T apply(T const x)
+			{
+				T const half = IntegerPower<T, t_pow / 2>::apply(x);
+				return (t_pow % 2) ? T(half * half * x) : T(half * half);
+			}
+		};
+
+		template<typename T>
+		struct IntegerPower<T, 1>
+		{
+			static constexpr T apply(T const x)
+			{
+				return x;
+			}
+		};
+
+		template<typename T>
+		struct IntegerPower<T, 0>
+		{
+			static constexpr T apply(T const)
+			{
+				return T(1);
+			}
+		};
+
+		/**
+		 * Unqualified calls to the maths functions, so that overloads for
+		 * other storage types are found by argument dependent lookup when a
+		 * template is instantiated, even if (like std::complex's) they were
+		 * declared after this header
+		 */
+		namespace Lookup {
+			using std::cbrt;
+			using std::pow;
+
+			template<typename T, typename U>
+			using PowResult = decltype(pow(std::declval<T>(), std::declval<U>()));
+
+			/**
+			 * cbrt(x), or pow(x, 1/3) for types without a cbrt, like
+			 * std::complex
+			 */
+			template<typename T>
+			auto CbrtOrPow(T const x, int) -> decltype(T(cbrt(x)))
+			{
+				return T(cbrt(x));
+			}
+
+			template<typename T>
+			T CbrtOrPow(T const x, long)
+			{
+				return T(pow(x, T(1)/T(3)));
+			}
+		}
+
+		/**
+		 * True while the caller is being evaluated at compile time, where
+		 * libm can't be called. Always false if the compiler can't tell,
+		 * which leaves the maths functions only usable at run time.
+		 */
+		constexpr bool IsConstantEvaluated()
+		{
+#if MESI_HAS_CONSTANT_EVALUATED
+			return __builtin_is_constant_evaluated();
+#else
+			return false;
+#endif
+		}
+
+		/**
+		 * The t_den-th root of x by Newton's method, for compile time use.
+		 * x is scaled by powers of 2^t_den into [1, 2^t_den), which puts its
+		 * root in [1, 2), and the iteration descends from 2 until it stops
+		 * descending. Working in long double means the result normally
+		 * rounds to the same float or double as the libm functions give.
+		 */
+		template<intmax_t t_den>
+		constexpr long double ConstexprRoot(long double x)
+		{
+			// NaN, infinities and zeroes are their own roots
+			if(!(x - x == 0) || x == 0)
+			{
+				return x < 0 && t_den % 2 == 0 ? std::numeric_limits<long double>::quiet_NaN() : x;
+			}
+			if(x < 0)
+			{
+				return t_den % 2 == 0 ? std::numeric_limits<long double>::quiet_NaN() : -ConstexprRoot<t_den>(-x);
+			}
+			long double const step = IntegerPower<long double, t_den>::apply(2);
+			long double scale = 1;
+			for(; x >= step; x /= step)
+			{
+				scale *= 2;
+			}
+			for(; x < 1; x *= step)
+			{
+				scale /= 2;
+			}
+			long double y = 2;
+			for(;;)
+			{
+				long double const next = ((t_den - 1) * y + x / IntegerPower<long double, t_den - 1>::apply(y)) / t_den;
+				if(!(next < y))
+				{
+					break;
+				}
+				y = next;
+			}
+			return y * scale;
+		}
+
+		/**
+		 * The sign of m^2 - x, exactly: m^2 is split into its rounded value
+		 * and the rounding error (Dekker's product), and as the two are close
+		 * the difference from x is exact.
+		 */
+		constexpr int CompareSquare(long double const m, long double const x)
+		{
+			long double const splitter = IntegerPower<long double, (std::numeric_limits<long double>::digits + 1) / 2>::apply(2) + 1;
+			long double const hi = m * splitter - (m * splitter - m);
+			long double const lo = m - hi;
+			long double const square = m * m;
+			long double const error = ((hi * hi - square) + 2 * hi * lo) + lo * lo;
+			long double const difference = (square - x) + error;
+			return difference < 0 ? -1 : difference > 0 ? 1 : 0;
+		}
+
+		/**
+		 * The square root of x rounded to T, like the sqrt instructions give.
+		 * Rounding ConstexprRoot's long double result to T can round twice
+		 * when it falls next to a value halfway between two T, so the root is
+		 * compared to that halfway value exactly, when long double has room
+		 * for it.
+		 */
+		template<typename T>
+		constexpr T ConstexprSqrt(long double const x)
+		{
+			long double const y = ConstexprRoot<2>(x);
+			T const r = T(y);
+			if(std::numeric_limits<long double>::digits <= std::numeric_limits<T>::digits || !(r - r == 0) || !(r > 0))
+			{
+				return r;
+			}
+			// Half the spacing of T on the side of r that y is on
+			long double half = std::numeric_limits<T>::epsilon() / 2;
+			long double normalised = r;
+			for(; normalised >= 2; normalised /= 2)
+			{
+				half *= 2;
+			}
+			for(; normalised < 1; normalised *= 2)
+			{
+				half /= 2;
+			}
+			if(y < r)
+			{
+				half = normalised == 1 ? -half / 2 : -half;
+			}
+			int const side = CompareSquare(r + half, x);
+			return (half > 0 && side < 0) || (half < 0 && side > 0) ? T(r + 2 * half) : r;
+		}
+
+		/**
+		 * Compile time roots of arithmetic types, see ConstexprRoot. Integer
+		 * roots are truncated, as converting the libm result would do, but
+		 * corrected so that perfect powers give exact results. Other storage
+		 * types have no compile time form and use the run time one.
+		 */
+		template<typename T, intmax_t t_den,
+			bool t_arithmetic = std::is_arithmetic<T>::value,
+			bool t_integral = std::is_integral<T>::value>
+		struct ConstantRoot
+		{
+			static constexpr T apply(T const x)
+			{
+				return t_den == 2 ? ConstexprSqrt<T>(static_cast<long double>(x)) : T(ConstexprRoot<t_den>(static_cast<long double>(x)));
+			}
+		};
+
+		template<typename T, intmax_t t_den>
+		struct ConstantRoot<T, t_den, true, true>
+		{
+			static constexpr T apply(T const x)
+			{
+				return x < 0 ? T(-magnitude(-static_cast<long double>(x))) : T(magnitude(static_cast<long double>(x)));
+			}
+
+		private:
+			static constexpr long double magnitude(long double const x)
+			{
+				long double const root = static_cast<long double>(static_cast<uintmax_t>(ConstexprRoot<t_den>(x)));
+				return IntegerPower<long double, t_den>::apply(root + 1) <= x ? root + 1
+					: IntegerPower<long double, t_den>::apply(root) > x ? root - 1
+					: root;
+			}
+		};
+
+		template<typename T, intmax_t t_den>
+		struct UnitRoot;
+
+		template<typename T, intmax_t t_den, bool t_integral>
+		struct ConstantRoot<T, t_den, false, t_integral>
+		{
+			static T apply(T const x)
+			{
+				return UnitRoot<T, t_den>::run(x);
+			}
+		};
+
+		/**
+		 * Takes the t_den-th root of a value. Roots with a cheaper or more
+		 * exact form than pow() are specialised below, the rest fall back to
+		 * pow(). Note cbrt() is used for its exactness on perfect cubes and
+		 * negative bases rather than speed, as some libms implement it no
+		 * faster than pow().
+		 *
+		 * Unqualified calls are used throughout so that storage types other
+		 * than the built-in ones can provide their own overloads. During
+		 * constant evaluation ConstantRoot is used instead.
+		 */
+		template<typename T, intmax_t t_den>
+		struct UnitRoot
+		{
+			static constexpr bool has_shortcut = false;
+
+			static constexpr T apply(T const x)
+			{
+				return IsConstantEvaluated() ? ConstantRoot<T, t_den>::apply(x) : run(x);
+			}
+
+			static T run(T const x)
+			{
+				using std::pow;
+				return T(pow(x, T(1)/T(t_den)));
+			}
+		};
+
+		template<typename T>
+		struct UnitRoot<T, 1>
+		{
+			static constexpr bool has_shortcut = true;
+
+			static constexpr T apply(T const x)
+			{
+				return x;
+			}
+		};
+
+		template<typename T>
+		struct UnitRoot<T, 2>
+		{
+			static constexpr bool has_shortcut = true;
+
+			static constexpr T apply(T const x)
+			{
+				return IsConstantEvaluated() ? ConstantRoot<T, 2>::apply(x) : run(x);
+			}
+
+			static T run(T const x)
+			{
+				using std::sqrt;
+				return T(sqrt(x));
+			}
+		};
+
+		template<typename T>
+		struct UnitRoot<T, 3>
+		{
+			static constexpr bool has_shortcut = true;
+
+			static constexpr T apply(T const x)
+			{
+				return IsConstantEvaluated() ? ConstantRoot<T, 3>::apply(x) : run(x);
+			}
+
+			static T run(T const x)
+			{
+				return Lookup::CbrtOrPow(x, 0);
+			}
+		};
+
+		template<typename T>
+		struct UnitRoot<T, 4>
+		{
+			static constexpr bool has_shortcut = true;
+
+			static constexpr T apply(T const x)
+			{
+				return UnitRoot<T, 2>::apply(UnitRoot<T, 2>::apply(x));
+			}
+		};
+
+		/**
+		 * Raises a value to the rational power t_num/t_den, choosing the
+		 * cheapest evaluation at compile time:
+		 *  - negative powers take the reciprocal of the positive power,
+		 *  - x^(q + r/d) becomes x^q * (d-th root of x)^r when the d-th root
+		 *    has a shortcut (see UnitRoot), with the integer parts done by
+		 *    IntegerPower,
+		 *  - anything else falls back to pow(), except during constant
+		 *    evaluation, where the root is taken by UnitRoot as above.
+		 */
+		template<typename T, intmax_t t_num, intmax_t t_den,
+			bool t_negative = (t_num < 0),
+			bool t_has_shortcut = UnitRoot<T, t_den>::has_shortcut>
+		struct RationalPower
+		{
+			static constexpr T apply(T const x)
+			{
+				return IsConstantEvaluated() ? RationalPower<T, t_num, t_den, false, true>::apply(x) : run(x);
+			}
+
+			static T run(T const x)
+			{
+				using std::pow;
+				return T(pow(x, T(t_num)/T(t_den)));
+			}
+		};
+
+		template<typename T, intmax_t t_num, intmax_t t_den, bool t_has_shortcut>
+		struct RationalPower<T, t_num, t_den, true, t_has_shortcut>
+		{
+			static constexpr T apply(T const x)
+			{
+				return T(T(1) / RationalPower<T, -t_num, t_den>::apply(x));
+			}
+		};
+
+		template<typename T, intmax_t t_num, intmax_t t_den>
+		struct RationalPower<T, t_num, t_den, false, true>
+		{
+			static constexpr T apply(T const x)
+			{
+				constexpr intmax_t whole = t_num / t_den;
+				constexpr intmax_t remainder = t_num % t_den;
+				if(remainder == 0)
+				{
+					return IntegerPower<T, whole>::apply(x);
+				}
+				T const root = IntegerPower<T, remainder>::apply(UnitRoot<T, t_den>::apply(x));
+				if(whole == 0)
+				{
+					return root;
+				}
+				return T(IntegerPower<T, whole>::apply(x) * root);
+			}
+		};
+
+		/**
+		 * Builds the unit strings returned by getUnit. Only declared here so
+		 * that the core doesn't need <string>; the definition is in
+		 * mesiformat.h.
+		 */
+		template<typename Type>
+		struct UnitFormatter;
+	}
+/* Utility macro for applying another macro to all known units, for internal use only */
+#define ALL_UNITS(op) op(m) op(s) op(kg) op(A) op(K) op(mol) op(cd)
+
+	template<typename T, typename U>
+	struct TypeOperationsDefaults
+	{
+		using MultiplyResult = decltype(T{}*U{});
+		using DivideResult = decltype(T{}/U{});
+		using AddResult = decltype(T{}+U{});
+		using SubtractResult = decltype(T{}-U{});
+		using PowerResult = _internal::Lookup::PowResult<T, U>;
+	};
+
+	/**
+	 * The real number type of storage type T, in which scale factors are
+	 * computed. Specialised for std::complex in mesicomplex.h.
+	 */
+	template<typename T>
+	struct RealType
+	{
+		using Type = T;
+	};
+
+	template<typename T, typename U>
+	struct TypeOperations : public TypeOperationsDefaults<T, U>
+	{
+	};
+
+	/**
+	 * @brief Main class to store SI types
+	 *
+	 * @param T storage type parameter
+	 * @param t_m number of dimensions of meters as a rational number, e.g., t_m == std::ratio<2,1> => m^2
+	 * @param t_s similar to t_m, but seconds
+	 * @param t_kg similar to t_m, but kilograms
+	 * @param t_A similar to t_m, but amperes
+	 * @param t_K similar to t_m, but Kelvin
+	 * @param t_mol similar to t_m, but moles
+	 * @param t_cd similar to t_m, but candela
+	 * @param t_scale defines a scaling factor, e.g. Scale<std::ratio<6,1>, 1,
+	 *        std::ratio<1,1>> for a scaling factor of 60.
+	 *
+	 * This class is to enforce compile-time checking, and where possible,
+	 * compile-time calculation of SI values using constexpr.
+	 *
+	 * Note: MESI_LITERAL_TYPE may be defined to set the storage type
+	 * used by the operator literal overloads
+	 *
+	 * Note: t_scale should be reduced to its simplest form, with the exponent
+	 * denominator as low as possible and no powers of ten remaining in the
+	 * ratio. To achieve this, please consider using RationalType instead of
+	 * handling RationalTypeReduced directly.
+	 *
+	 * @author Jameson Thatcher (a.k.a. SirEel)
+	 *
+	 */
+	template<typename T,
+		typename t_m, typename t_s, typename t_kg, typename t_A, typename t_K, typename t_mol, typename t_cd,
+		typename t_scale>
+	struct RationalTypeReduced
+	{
+		using BaseType = T;
+		using MeterExponent = t_m;
+		using SecondExponent = t_s;
+		using KilogramExponent = t_kg;
+		using AmpereExponent = t_A;
+		using KelvinExponent = t_K;
+		using MoleExponent = t_mol;
+		using CandelaExponent = t_cd;
+		using ScaleInfo = t_scale;
+
+	private:
+		using Zero = std::ratio<0,1>;
+		using One = std::ratio<1,1>;
+	public:
+		using ScalarType = RationalTypeReduced<T, Zero, Zero, Zero, Zero, Zero, Zero, Zero, _internal::ScaleOne>;
+
+		template<typename t_scale_ratio, intmax_t t_scale_exponent_denominator, typename t_scale_10_to_the>
+		using Scale = RationalTypeReduced<T, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, typename _internal::ScaleMultiply<t_scale, _internal::Scale<t_scale_ratio, t_scale_exponent_denominator, t_scale_10_to_the>>::Scale>;
+
+		template<intmax_t t_scale_by>
+		using Multiply = Scale<std::ratio<t_scale_by, 1>, 1, std::ratio<0,1>>;
+
+		template<intmax_t t_scale_by>
+		using Divide = Scale<std::ratio<1, t_scale_by>, 1, std::ratio<0,1>>;
+
+		template<intmax_t t_pow>
+		using ScaleByTenToThe = Scale<std::ratio<1,1>, 1, std::ratio<t_pow,1>>;
+
+		template<typename t_pow>
+		using Pow = RationalTypeReduced<T,
+			  std::ratio_multiply<t_m, t_pow>,
+			  std::ratio_multiply<t_s, t_pow>,
+			  std::ratio_multiply<t_kg, t_pow>,
+			  std::ratio_multiply<t_A, t_pow>,
+			  std::ratio_multiply<t_K, t_pow>,
+			  std::ratio_multiply<t_mol, t_pow>,
+			  std::ratio_multiply<t_cd, t_pow>,
+			  typename _internal::ScalePower<t_scale, t_pow>::Scale>;
+
+		T val;
+
+		/*
+		 * The default and copy constructors are left to the compiler so that,
+		 * for trivially copyable T, this type is trivially copyable too. That
+		 * lets it be passed in registers, copied with memcpy and laid over
+		 * buffers of T (see view_as in mesispan.h).
+		 */
+		RationalTypeReduced() = default;
+
+		constexpr explicit RationalTypeReduced(T const in)
+			:val(in)
+		{}
+
+		RationalTypeReduced(RationalTypeReduced const& in) = default;
+
+		template<typename U>
+		constexpr RationalTypeReduced(RationalTypeReduced<U, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale> const& in)
+			:val(in.val)
+		{}
+
+		explicit operator T() const {
+			return val;
+		}
+
+		template<typename t_scale2>
+		explicit constexpr operator RationalTypeReduced<T, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale2>() const {
+			using Scale = typename _internal::ScaleDivide<t_scale, t_scale2>::Scale;
+			T nv = val * Scale::template value<typename RealType<T>::Type>();
+
+			return RationalTypeReduced<T, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale2>(nv);
+		}
+
+		/**
+		 * getUnit will get a SI-style unit string for this class. This needs
+		 * mesiformat.h (included by mesitype.h, but not by mesicore.h).
+		 */
+		template<typename t_formatter = _internal::UnitFormatter<RationalTypeReduced>>
+		static auto getUnit() -> decltype(t_formatter::format()) {
+			return t_formatter::format();
+		}
+
+		constexpr RationalTypeReduced& operator+=(
+			RationalTypeReduced const& rhs
+		) {
+			return (*this) = (*this) + rhs;
+		}
+
+		constexpr RationalTypeReduced& operator-=(
+			RationalTypeReduced const& rhs
+		) {
+			return (*this) = (*this) - rhs;
+		}
+
+		constexpr RationalTypeReduced& operator*=(T const& rhs) {
+			return (*this) = (*this) * rhs;
+		}
+
+		constexpr RationalTypeReduced& operator/=(T const& rhs) {
+			return (*this) = (*this) / rhs;
+		}
+
+		constexpr RationalTypeReduced& operator*=(ScalarType const& rhs) {
+			return (*this) = (*this) * rhs;
+		}
+
+		constexpr RationalTypeReduced& operator/=(ScalarType const& rhs) {
+			return (*this) = (*this) / rhs;
+		}
+	};
+
+	template<typename T, typename t_m, typename t_s, typename t_kg, typename t_A, typename t_K, typename t_mol, typename t_cd, typename t_ratio, intmax_t t_exponent_denominator, typename t_power_of_ten>
+	using RationalType = RationalTypeReduced<T, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, typename _internal::ScaleSimplify<typename _internal::Scale<t_ratio, t_exponent_denominator, t_power_of_ten>>::Scale>;
+
+	namespace _internal {
+		/**
+		 * The same quantity as Q, stored as T, e.g. the real part of a
+		 * complex quantity
+		 */
+		template<typename Q, typename T>
+		struct Restored;
+
+		template<typename Q, typename T, typename t_m, typename t_s, typename t_kg, typename t_A, typename t_K, typename t_mol, typename t_cd, typename t_scale>
+		struct Restored<RationalTypeReduced<Q, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale>, T>
+		{
+			using Type = RationalTypeReduced<T, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale>;
+		};
+	}
+
+#define TYPE_A_FULL_PARAMS typename t_m, typename t_s, typename t_kg, typename t_A, typename t_K, typename t_mol, typename t_cd, typename t_scale
+#define TYPE_A_PARAMS t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale
+#define TYPE_B_FULL_PARAMS typename t_m2, typename t_s2, typename t_kg2, typename t_A2, typename t_K2, typename t_mol2, typename t_cd2, typename t_scale2
+#define TYPE_B_PARAMS t_m2, t_s2, t_kg2, t_A2, t_K2, t_mol2, t_cd2, t_scale2
+	/*
+	 * Arithmatic operators for combining SI values.
+	 */
+	template<typename T, typename U, TYPE_A_FULL_PARAMS>
+	constexpr auto operator+(
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& left,
+		RationalTypeReduced<U, TYPE_A_PARAMS> const& right
+	) {
+		return RationalTypeReduced<typename TypeOperations<T,U>::AddResult, TYPE_A_PARAMS>(left.val + right.val);
+	}
+
+	template<typename T, typename U, TYPE_A_FULL_PARAMS>
+	constexpr auto operator-(
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& left,
+		RationalTypeReduced<U, TYPE_A_PARAMS> const& right
+	) {
+		return RationalTypeReduced<typename TypeOperations<T,U>::SubtractResult, TYPE_A_PARAMS>(left.val - right.val);
+	}
+
+	template<typename T, typename U, TYPE_A_FULL_PARAMS, TYPE_B_FULL_PARAMS>
+	constexpr auto operator*(
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& left,
+		RationalTypeReduced<U, TYPE_B_PARAMS> const& right
+	) {
+		using Scale = typename _internal::ScaleMultiply<t_scale, t_scale2>::Scale;
+#define ADD_FRAC(TP) using TP = std::ratio_add<t_##TP, t_##TP##2>;
+		ALL_UNITS(ADD_FRAC)
+#undef ADD_FRAC
+		return RationalTypeReduced<typename TypeOperations<T,U>::MultiplyResult, m, s, kg, A, K, mol, cd, Scale>(left.val * right.val);
+	}
+
+	template<typename T, typename U, TYPE_A_FULL_PARAMS, TYPE_B_FULL_PARAMS>
+	constexpr auto operator/(
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& left,
+		RationalTypeReduced<U, TYPE_B_PARAMS> const& right
+	) {
+		using Scale = typename _internal::ScaleDivide<t_scale, t_scale2>::Scale;
+#define SUB_FRAC(TP) using TP = std::ratio_subtract<t_##TP, t_##TP##2>;
+		ALL_UNITS(SUB_FRAC)
+#undef SUB_FRAC
+		return RationalTypeReduced<typename TypeOperations<T,U>::DivideResult, m, s, kg, A, K, mol, cd, Scale>(left.val / right.val);
+	}
+
+	/*
+	 * Unary operators, to help with literals (and general usage!)
+	 */
+
+	template<typename T, TYPE_A_FULL_PARAMS>
+	constexpr auto operator-(
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& op
+	) {
+		return RationalTypeReduced<T, TYPE_A_PARAMS>(-op.val);
+	}
+
+	template<typename T, TYPE_A_FULL_PARAMS>
+	constexpr auto operator+(
+			RationalTypeReduced<T, TYPE_A_PARAMS> const& op
+	) {
+		return RationalTypeReduced<T, TYPE_A_PARAMS>(op);
+	}
+
+	/*
+	 * Scalers by non-SI values (allows things like 2 * 3._m
+	 */
+
+	template<typename T, TYPE_A_FULL_PARAMS, typename S>
+	constexpr auto operator*(
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& left,
+		S const& right
+	) {
+		return RationalTypeReduced<typename TypeOperations<T,S>::MultiplyResult, TYPE_A_PARAMS>(left.val * right);
+	}
+
+	template<typename T, TYPE_A_FULL_PARAMS, typename S>
+	constexpr auto operator*(
+		S const & left,
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& right
+	) {
+		return right * left;
+	}
+
+	template<typename T, TYPE_A_FULL_PARAMS, typename S>
+	constexpr auto operator/(
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& left,
+		S const& right
+	) {
+		using Scalar = typename RationalTypeReduced<typename TypeOperations<T,S>::DivideResult, TYPE_A_PARAMS>::ScalarType;
+		return left / Scalar(T(right));
+	}
+
+	template<typename T, TYPE_A_FULL_PARAMS, typename S>
+	constexpr auto operator/(
+		S const & left,
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& right
+	) {
+		using Scalar = typename RationalTypeReduced<typename TypeOperations<S,T>::DivideResult, TYPE_A_PARAMS>::ScalarType;
+		return Scalar(T(left)) / right;
+	}
+
+	/*
+	 * Comparison operators. The orderings only exist for storage types that
+	 * can be ordered, so e.g. complex quantities can only be compared for
+	 * equality.
+	 */
+	template<typename T, typename U, TYPE_A_FULL_PARAMS>
+	constexpr bool operator==(
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& left,
+		RationalTypeReduced<U, TYPE_A_PARAMS> const& right
+	) {
+		return left.val == right.val;
+	}
+
+	template<typename T, typename U, TYPE_A_FULL_PARAMS>
+	constexpr auto operator<(
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& left,
+		RationalTypeReduced<U, TYPE_A_PARAMS> const& right
+	) -> decltype(bool(left.val < right.val)) {
+		return left.val < right.val;
+	}
+
+	template<typename T, typename U, TYPE_A_FULL_PARAMS>
+	constexpr bool operator!=(
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& left,
+		RationalTypeReduced<U, TYPE_A_PARAMS> const& right
+	) {
+		return left.val != right.val;
+	}
+
+	template<typename T, typename U, TYPE_A_FULL_PARAMS>
+	constexpr auto operator<=(
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& left,
+		RationalTypeReduced<U, TYPE_A_PARAMS> const& right
+	) -> decltype(bool(left.val <= right.val)) {
+		return left.val <= right.val;
+	}
+
+	template<typename T, typename U, TYPE_A_FULL_PARAMS>
+	constexpr auto operator>(
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& left,
+		RationalTypeReduced<U, TYPE_A_PARAMS> const& right
+	) -> decltype(bool(right.val < left.val)) {
+		return right < left;
+	}
+
+	template<typename T, typename U, TYPE_A_FULL_PARAMS>
+	constexpr auto operator>=(
+		RationalTypeReduced<T, TYPE_A_PARAMS> const& left,
+		RationalTypeReduced<U, TYPE_A_PARAMS> const& right
+	) -> decltype(bool(left.val >= right.val)) {
+		return left.val >= right.val;
+	}
+
+	/**
+	 * Raises a value to the rational power t_pow_ratio. The evaluation
+	 * strategy (multiplication chain, sqrt/cbrt, reciprocal or pow()) is
+	 * picked at compile time, see _internal::RationalPower. Constant
+	 * evaluation avoids libm, so compile time constants can be raised too.
+	 */
+	template<typename t_pow_ratio, typename T, TYPE_A_FULL_PARAMS>
+	constexpr auto pow(RationalTypeReduced<T, TYPE_A_PARAMS> v)
+	{
+		return typename RationalTypeReduced<T, TYPE_A_PARAMS>::template Pow<t_pow_ratio>(_internal::RationalPower<T, t_pow_ratio::num, t_pow_ratio::den>::apply(T(v.val)));
+	}
+
+#undef TYPE_A_FULL_PARAMS
+#undef TYPE_A_PARAMS
+#undef TYPE_B_FULL_PARAMS
+#undef TYPE_B_PARAMS
+#undef ALL_UNITS
+
+	/*
+	 * Readable names for common types
+	 */
+
+	template<typename T, intmax_t t_m, intmax_t t_s, intmax_t t_kg, intmax_t t_A=0, intmax_t t_K=0, intmax_t t_mol=0, intmax_t t_cd=0, typename t_ratio = std::ratio<1,1>, intmax_t t_exponent_denominator=1, typename t_power_of_ten = std::ratio<0,1>>
+	using Type = RationalType<T, std::ratio<t_m, 1>, std::ratio<t_s, 1>, std::ratio<t_kg, 1>, std::ratio<t_A, 1>, std::ratio<t_K, 1>, std::ratio<t_mol, 1>, std::ratio<t_cd, 1>, t_ratio, t_exponent_denominator, t_power_of_ten>;
+
+#ifndef MESI_LITERAL_TYPE
+#	define MESI_LITERAL_TYPE float
+#endif
+
+	template<intmax_t t_power, typename T>
+	using Prefix = typename T::template ScaleByTenToThe<t_power>;
+
+	template<typename T> using Deca  = Prefix<1, T>;
+	template<typename T> using Hecto = Prefix<2, T>;
+	template<typename T> using Kilo  = Prefix<3, T>;
+	template<typename T> using Mega  = Prefix<6, T>;
+	template<typename T> using Giga  = Prefix<9, T>;
+	template<typename T> using Tera  = Prefix<12, T>;
+	template<typename T> using Peta  = Prefix<15, T>;
+	template<typename T> using Exa   = Prefix<18, T>;
+	template<typename T> using Zetta = Prefix<21, T>;
+	template<typename T> using Yotta = Prefix<24, T>;
+
+	template<typename T> using Deci  = Prefix<-1, T>;
+	template<typename T> using Centi = Prefix<-2, T>;
+	template<typename T> using Milli = Prefix<-3, T>;
+	template<typename T> using Micro = Prefix<-6, T>;
+	template<typename T> using Nano  = Prefix<-9, T>;
+	template<typename T> using Pico  = Prefix<-12, T>;
+	template<typename T> using Femto = Prefix<-15, T>;
+	template<typename T> using Atto  = Prefix<-18, T>;
+	template<typename T> using Zepto = Prefix<-21, T>;
+	template<typename T> using Yocto = Prefix<-24, T>;
+
+	using Scalar    = Type<MESI_LITERAL_TYPE, 0, 0, 0>;
+	using Meters    = Type<MESI_LITERAL_TYPE, 1, 0, 0>;
+	using Seconds   = Type<MESI_LITERAL_TYPE, 0, 1, 0>;
+	using Kilograms = Type<MESI_LITERAL_TYPE, 0, 0, 1>;
+	using Amperes   = Type<MESI_LITERAL_TYPE, 0, 0, 0, 1>;
+	using Kelvin    = Type<MESI_LITERAL_TYPE, 0, 0, 0, 0, 1>;
+	using Moles     = Type<MESI_LITERAL_TYPE, 0, 0, 0, 0, 0, 1>;
+	using Candela   = Type<MESI_LITERAL_TYPE, 0, 0, 0, 0, 0, 0, 1>;
+	using Minutes   = Seconds::Multiply<60>;
+	using Hours     = Minutes::Multiply<60>;
+	using Grams     = Milli<Kilograms>;
+	using Tonnes    = Kilo<Kilograms>;
+	using Newtons   = decltype(Meters{} * Kilograms{} / Seconds{} / Seconds{});
+	using NewtonsSq = decltype(Newtons{} * Newtons{});
+	using MetersSq  = decltype(Meters{} * Meters{});
+	using MetersCu  = decltype(Meters{} * MetersSq{});
+	using SecondsSq = decltype(Seconds{} * Seconds{});
+	using KilogramsSq = decltype(Kilograms{} * Kilograms{});
+	using Hertz     = decltype(Scalar{} / Seconds{});
+	using Pascals   = decltype(Newtons{} / MetersSq{});
+	using Joules    = decltype(Newtons{} * Meters{});
+	using Watts     = decltype(Joules{} / Seconds{});
+	using Coulombs  = decltype(Amperes{} * Seconds{});
+	using Volts     = decltype(Watts{} / Amperes{});
+	using Farads    = decltype(Coulombs{} / Volts{});
+	using Ohms      = decltype(Volts{} / Amperes{});
+	using Siemens   = decltype(Amperes{} / Volts{});
+	using Webers    = decltype(Volts{} * Seconds{});
+	using Tesla     = decltype(Webers{} / MetersSq{});
+	using Henry     = decltype(Webers{} / Amperes{});
+
+	static_assert(std::is_trivially_copyable<Meters>::value && std::is_trivially_copyable<Henry>::value,
+		"Mesi types must be trivially copyable when their base type is");
+	static_assert(std::is_standard_layout<Meters>::value && sizeof(Meters) == sizeof(Meters::BaseType),
+		"Mesi types must have the same layout as their base type");
+
+	namespace Literals {
+	/*
+	 * Literal operators, to allow quick creation of basic types
+	 * Note that this defaults to the type set below, if no other is set
+	 * before calling!
+	 *
+	 * These are all lowercase, as identifiers beginning with
+	 * _[A-Z] are reserved.
+	 */
+#define LITERAL_TYPE(T, SUFFIX) \
+			constexpr auto operator "" SUFFIX(long double arg) { return T(arg); } \
+			constexpr auto operator "" SUFFIX(unsigned long long arg) { return T(arg); }
+
+		LITERAL_TYPE(Mesi::Meters, _m)
+		LITERAL_TYPE(Mesi::MetersSq, _m2)
+		LITERAL_TYPE(Mesi::MetersCu, _m3)
+		LITERAL_TYPE(Mesi::Seconds, _s)
+		LITERAL_TYPE(Mesi::SecondsSq, _s2)
+		LITERAL_TYPE(Mesi::Kilograms, _kg)
+		LITERAL_TYPE(Mesi::KilogramsSq, _kg2)
+		LITERAL_TYPE(Mesi::Newtons, _n)
+		LITERAL_TYPE(Mesi::NewtonsSq, _n2)
+		LITERAL_TYPE(Mesi::Hertz, _hz)
+		LITERAL_TYPE(Mesi::Amperes, _a)
+		LITERAL_TYPE(Mesi::Kelvin, _k)
+		LITERAL_TYPE(Mesi::Moles, _mol)
+		LITERAL_TYPE(Mesi::Candela, _cd)
+		LITERAL_TYPE(Mesi::Pascals, _pa)
+		LITERAL_TYPE(Mesi::Joules, _j)
+		LITERAL_TYPE(Mesi::Watts, _w)
+		LITERAL_TYPE(Mesi::Coulombs, _c)
+		LITERAL_TYPE(Mesi::Volts, _v)
+		LITERAL_TYPE(Mesi::Farads, _f)
+		LITERAL_TYPE(Mesi::Ohms, _ohm)
+		LITERAL_TYPE(Mesi::Siemens, _siemens)
+		LITERAL_TYPE(Mesi::Webers, _wb)
+		LITERAL_TYPE(Mesi::Tesla, _t)
+		LITERAL_TYPE(Mesi::Henry, _h)
+#undef LITERAL_TYPE
+	}
+}
+
+#undef MESI_HAS_CONSTANT_EVALUATED
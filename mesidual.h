@@ -0,0 +1,441 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include "mesicore.h"
+#include "mesispan.h"
+
+/*
+ * Forward-mode automatic differentiation of quantities, e.g. the force
+ * from a potential energy:
+ *
+ *     auto x = Mesi::independent(Meters(0.2f));
+ *     auto energy = Scalar(0.5f) * stiffness * x * x;   // dual Joules
+ *     Mesi::Newtons force = -Mesi::derivative(energy, x);
+ *
+ * Dual numbers are used as the storage type, so every operator of
+ * mesicore.h, Mesi::pow, scale conversions and the mesimath.h functions
+ * carry derivatives along with values, and derivative() gives each one
+ * the quotient type of the quantities. The first derivative is exact,
+ * unlike a finite difference.
+ *
+ * With N directions, each value carries N derivatives at once, e.g. with
+ * respect to each input of a function for a whole row of its Jacobian in
+ * one evaluation. The derivatives are updated in loops over N that
+ * compilers can vectorise.
+ */
+namespace Mesi {
+	/**
+	 * @brief A value and its derivatives in N directions
+	 *
+	 * @param T the real storage type, e.g. float
+	 * @param N the number of directions
+	 *
+	 * Comparisons only look at the values, so code that branches on a
+	 * quantity takes the same path with dual numbers.
+	 */
+	template<typename T, std::size_t N = 1>
+	struct Dual
+	{
+		static_assert(N > 0, "A dual number needs at least one direction");
+
+		using ValueType = T;
+
+		T value;
+		T tangent[N];
+
+		constexpr Dual()
+			:value(), tangent{}
+		{}
+
+		/**
+		 * A constant, whose derivatives are zero
+		 */
+		constexpr Dual(T const x)
+			:value(x), tangent{}
+		{}
+
+		/**
+		 * A dual number with the derivative of x along this direction, and
+		 * zero along the others
+		 */
+		static Dual variable(T const x, std::size_t const direction = 0)
+		{
+			Dual ret(x);
+			ret.tangent[direction] = T(1);
+			return ret;
+		}
+
+		Dual& operator+=(Dual const& other)
+		{
+			value += other.value;
+			for(std::size_t i = 0; i < N; i++)
+			{
+				tangent[i] += other.tangent[i];
+			}
+			return *this;
+		}
+
+		Dual& operator-=(Dual const& other)
+		{
+			value -= other.value;
+			for(std::size_t i = 0; i < N; i++)
+			{
+				tangent[i] -= other.tangent[i];
+			}
+			return *this;
+		}
+
+		Dual& operator*=(Dual const& other)
+		{
+			for(std::size_t i = 0; i < N; i++)
+			{
+				tangent[i] = tangent[i] * other.value + value * other.tangent[i];
+			}
+			value *= other.value;
+			return *this;
+		}
+
+		Dual& operator/=(Dual const& other)
+		{
+			T const inverse = T(1) / other.value;
+			value *= inverse;
+			for(std::size_t i = 0; i < N; i++)
+			{
+				tangent[i] = (tangent[i] - value * other.tangent[i]) * inverse;
+			}
+			return *this;
+		}
+
+		Dual& operator*=(T const& other)
+		{
+			value *= other;
+			for(std::size_t i = 0; i < N; i++)
+			{
+				tangent[i] *= other;
+			}
+			return *this;
+		}
+
+		Dual& operator/=(T const& other)
+		{
+			return *this *= T(1) / other;
+		}
+	};
+
+	template<typename T, std::size_t N>
+	struct RealType<Dual<T, N>>
+	{
+		using Type = T;
+	};
+
+	namespace _internal {
+		template<typename T>
+		struct IsDual : std::false_type {};
+
+		template<typename T, std::size_t N>
+		struct IsDual<Dual<T, N>> : std::true_type {};
+
+		/**
+		 * f(x) from its value f and derivative df at x.value, by the chain
+		 * rule
+		 */
+		template<typename T, std::size_t N>
+		Dual<T, N> Chain(Dual<T, N> const& x, T const f, T const df)
+		{
+			Dual<T, N> ret(f);
+			for(std::size_t i = 0; i < N; i++)
+			{
+				ret.tangent[i] = df * x.tangent[i];
+			}
+			return ret;
+		}
+
+		/**
+		 * The derivative of lgamma, for tgamma and lgamma, by recurrence up
+		 * to 6 and an asymptotic series from there, reflecting negative
+		 * inputs. Accurate to about 1e-11.
+		 */
+		template<typename T>
+		T Digamma(T x)
+		{
+			T const pi = T(3.14159265358979323846);
+			T shift = 0;
+			if(x < T(0.5))
+			{
+				// digamma(1 - x) - digamma(x) = pi / tan(pi x)
+				shift = -pi / std::tan(pi * x);
+				x = T(1) - x;
+			}
+			for(; x < T(6); x += T(1))
+			{
+				shift -= T(1) / x;
+			}
+			T const inverse = T(1) / (x * x);
+			return shift + std::log(x) - T(0.5) / x
+				- inverse * (T(1) / T(12) - inverse * (T(1) / T(120) - inverse * (T(1) / T(252)
+				- inverse * (T(1) / T(240) - inverse * (T(1) / T(132))))));
+		}
+
+		/**
+		 * The real quantity with the units of dual quantity Q, or no type if
+		 * Q isn't dual, which removes the functions below from overload
+		 * resolution
+		 */
+		template<typename Q, bool = IsDual<typename Q::BaseType>::value>
+		struct DualValue {};
+
+		template<typename Q>
+		struct DualValue<Q, true>
+		{
+			using Type = typename Restored<Q, typename RealType<typename Q::BaseType>::Type>::Type;
+		};
+
+		template<typename Q>
+		using IfDual = typename DualValue<Q>::Type;
+
+		/**
+		 * The type of the derivative of Y with respect to X
+		 */
+		template<typename Y, typename X>
+		using DualDerivative = decltype(std::declval<IfDual<Y>>() / std::declval<IfDual<X>>());
+
+		template<typename Ys, typename X, typename Outs>
+		void CheckDerivativeOutput()
+		{
+			static_assert(std::is_same<ElementType<Outs>, DualDerivative<ElementType<Ys>, X>>::value,
+				"The output must have the type of the derivative");
+		}
+	}
+
+	/*
+	 * Arithmetic, with T on either side. T isn't deduced from the real
+	 * operand, so integers and other arithmetic types convert to it.
+	 */
+
+	template<typename T, std::size_t N>
+	Dual<T, N> operator+(Dual<T, N> a, Dual<T, N> const& b) { return a += b; }
+	template<typename T, std::size_t N>
+	Dual<T, N> operator-(Dual<T, N> a, Dual<T, N> const& b) { return a -= b; }
+	template<typename T, std::size_t N>
+	Dual<T, N> operator*(Dual<T, N> a, Dual<T, N> const& b) { return a *= b; }
+	template<typename T, std::size_t N>
+	Dual<T, N> operator/(Dual<T, N> a, Dual<T, N> const& b) { return a /= b; }
+
+	template<typename T, std::size_t N>
+	Dual<T, N> operator+(Dual<T, N> a, typename Dual<T, N>::ValueType const& b) { a.value += b; return a; }
+	template<typename T, std::size_t N>
+	Dual<T, N> operator-(Dual<T, N> a, typename Dual<T, N>::ValueType const& b) { a.value -= b; return a; }
+	template<typename T, std::size_t N>
+	Dual<T, N> operator*(Dual<T, N> a, typename Dual<T, N>::ValueType const& b) { return a *= b; }
+	template<typename T, std::size_t N>
+	Dual<T, N> operator/(Dual<T, N> a, typename Dual<T, N>::ValueType const& b) { return a /= b; }
+
+	template<typename T, std::size_t N>
+	Dual<T, N> operator+(typename Dual<T, N>::ValueType const& a, Dual<T, N> b) { b.value += a; return b; }
+	template<typename T, std::size_t N>
+	Dual<T, N> operator-(typename Dual<T, N>::ValueType const& a, Dual<T, N> const& b) { return Dual<T, N>(a) -= b; }
+	template<typename T, std::size_t N>
+	Dual<T, N> operator*(typename Dual<T, N>::ValueType const& a, Dual<T, N> b) { return b *= a; }
+	template<typename T, std::size_t N>
+	Dual<T, N> operator/(typename Dual<T, N>::ValueType const& a, Dual<T, N> const& b) { return Dual<T, N>(a) /= b; }
+
+	template<typename T, std::size_t N>
+	Dual<T, N> operator-(Dual<T, N> a)
+	{
+		a.value = -a.value;
+		for(std::size_t i = 0; i < N; i++)
+		{
+			a.tangent[i] = -a.tangent[i];
+		}
+		return a;
+	}
+
+	template<typename T, std::size_t N>
+	Dual<T, N> operator+(Dual<T, N> const& a) { return a; }
+
+	/*
+	 * Comparisons of the values
+	 */
+
+	template<typename T, std::size_t N>
+	bool operator==(Dual<T, N> const& a, Dual<T, N> const& b) { return a.value == b.value; }
+	template<typename T, std::size_t N>
+	bool operator!=(Dual<T, N> const& a, Dual<T, N> const& b) { return a.value != b.value; }
+	template<typename T, std::size_t N>
+	bool operator<(Dual<T, N> const& a, Dual<T, N> const& b) { return a.value < b.value; }
+	template<typename T, std::size_t N>
+	bool operator<=(Dual<T, N> const& a, Dual<T, N> const& b) { return a.value <= b.value; }
+	template<typename T, std::size_t N>
+	bool operator>(Dual<T, N> const& a, Dual<T, N> const& b) { return a.value > b.value; }
+	template<typename T, std::size_t N>
+	bool operator>=(Dual<T, N> const& a, Dual<T, N> const& b) { return a.value >= b.value; }
+
+	/*
+	 * The <cmath> functions that mesicore.h and mesimath.h forward to for
+	 * their storage type, found by argument-dependent lookup. Derivatives
+	 * at kinks and jumps (abs(0), floor of an integer) are those of the
+	 * side above.
+	 */
+
+#define MESI_DUAL_UNARY(name, df) \
+	template<typename T, std::size_t N> \
+	Dual<T, N> name(Dual<T, N> const& d) \
+	{ \
+		T const x = d.value; \
+		T const f = std::name(x); \
+		return _internal::Chain(d, f, T(df)); \
+	}
+
+	MESI_DUAL_UNARY(sqrt, T(0.5) / f)
+	MESI_DUAL_UNARY(cbrt, T(1) / (T(3) * f * f))
+	MESI_DUAL_UNARY(exp, f)
+	MESI_DUAL_UNARY(exp2, f * T(0.69314718055994530942))
+	MESI_DUAL_UNARY(expm1, f + T(1))
+	MESI_DUAL_UNARY(log, T(1) / x)
+	MESI_DUAL_UNARY(log10, T(0.43429448190325182765) / x)
+	MESI_DUAL_UNARY(log1p, T(1) / (T(1) + x))
+	MESI_DUAL_UNARY(log2, T(1.44269504088896340736) / x)
+	MESI_DUAL_UNARY(sin, std::cos(x))
+	MESI_DUAL_UNARY(cos, -std::sin(x))
+	MESI_DUAL_UNARY(tan, T(1) + f * f)
+	MESI_DUAL_UNARY(asin, T(1) / std::sqrt(T(1) - x * x))
+	MESI_DUAL_UNARY(acos, T(-1) / std::sqrt(T(1) - x * x))
+	MESI_DUAL_UNARY(atan, T(1) / (T(1) + x * x))
+	MESI_DUAL_UNARY(sinh, std::cosh(x))
+	MESI_DUAL_UNARY(cosh, std::sinh(x))
+	MESI_DUAL_UNARY(tanh, T(1) - f * f)
+	MESI_DUAL_UNARY(asinh, T(1) / std::sqrt(x * x + T(1)))
+	MESI_DUAL_UNARY(acosh, T(1) / std::sqrt(x * x - T(1)))
+	MESI_DUAL_UNARY(atanh, T(1) / (T(1) - x * x))
+	MESI_DUAL_UNARY(erf, T(1.12837916709551257390) * std::exp(-x * x))
+	MESI_DUAL_UNARY(erfc, T(-1.12837916709551257390) * std::exp(-x * x))
+	MESI_DUAL_UNARY(lgamma, _internal::Digamma(x))
+	MESI_DUAL_UNARY(tgamma, f * _internal::Digamma(x))
+	MESI_DUAL_UNARY(abs, x < T(0) ? T(-1) : T(1))
+	MESI_DUAL_UNARY(ceil, 0)
+	MESI_DUAL_UNARY(floor, 0)
+	MESI_DUAL_UNARY(trunc, 0)
+	MESI_DUAL_UNARY(round, 0)
+	MESI_DUAL_UNARY(nearbyint, 0)
+	MESI_DUAL_UNARY(rint, 0)
+
+#undef MESI_DUAL_UNARY
+
+	/*
+	 * Powers with a real exponent or base, which mesicore.h also needs to
+	 * find for its pow() result types
+	 */
+
+	template<typename T, std::size_t N>
+	Dual<T, N> pow(Dual<T, N> const& d, typename Dual<T, N>::ValueType const& p)
+	{
+		T const f = std::pow(d.value, p);
+		return _internal::Chain(d, f, p * std::pow(d.value, p - T(1)));
+	}
+
+	template<typename T, std::size_t N>
+	Dual<T, N> pow(typename Dual<T, N>::ValueType const& b, Dual<T, N> const& p)
+	{
+		T const f = std::pow(b, p.value);
+		return _internal::Chain(p, f, b > T(0) ? f * std::log(b) : T(0));
+	}
+
+	/**
+	 * d^p, where the derivative with respect to p is taken as zero for d
+	 * not above zero, as it only exists for integer p
+	 */
+	template<typename T, std::size_t N>
+	Dual<T, N> pow(Dual<T, N> const& d, Dual<T, N> const& p)
+	{
+		T const f = std::pow(d.value, p.value);
+		T const df = p.value * std::pow(d.value, p.value - T(1));
+		T const dp = d.value > T(0) ? f * std::log(d.value) : T(0);
+		Dual<T, N> ret(f);
+		for(std::size_t i = 0; i < N; i++)
+		{
+			ret.tangent[i] = df * d.tangent[i] + dp * p.tangent[i];
+		}
+		return ret;
+	}
+
+	template<typename T, std::size_t N>
+	Dual<T, N> atan2(Dual<T, N> const& y, Dual<T, N> const& x)
+	{
+		T const inverse = T(1) / (x.value * x.value + y.value * y.value);
+		Dual<T, N> ret(std::atan2(y.value, x.value));
+		for(std::size_t i = 0; i < N; i++)
+		{
+			ret.tangent[i] = (x.value * y.tangent[i] - y.value * x.tangent[i]) * inverse;
+		}
+		return ret;
+	}
+
+	template<typename T, std::size_t N>
+	Dual<T, N> fmax(Dual<T, N> const& a, Dual<T, N> const& b)
+	{
+		return a.value != a.value || a.value < b.value ? b : a;
+	}
+
+	template<typename T, std::size_t N>
+	Dual<T, N> fmin(Dual<T, N> const& a, Dual<T, N> const& b)
+	{
+		return a.value != a.value || b.value < a.value ? b : a;
+	}
+
+	template<typename T, std::size_t N>
+	Dual<T, N> fdim(Dual<T, N> const& a, Dual<T, N> const& b)
+	{
+		return a.value > b.value ? a - b : Dual<T, N>(std::fdim(a.value, b.value));
+	}
+
+	/**
+	 * x as an independent variable in a dual quantity, with the
+	 * derivative along `direction` of the N
+	 */
+	template<std::size_t N = 1, typename Q>
+	typename _internal::Restored<Q, Dual<typename Q::BaseType, N>>::Type independent(Q const& x, std::size_t const direction = 0)
+	{
+		return typename _internal::Restored<Q, Dual<typename Q::BaseType, N>>::Type(Dual<typename Q::BaseType, N>::variable(x.val, direction));
+	}
+
+	/**
+	 * The value of a dual quantity, without its derivatives
+	 */
+	template<typename Q>
+	_internal::IfDual<Q> value(Q const& y)
+	{
+		return _internal::IfDual<Q>(y.val.value);
+	}
+
+	/**
+	 * The derivative of y with respect to the independent variable x,
+	 * given that x has its derivative along `direction`, e.g. Newtons for
+	 * Joules with respect to Meters. x is only used for its type.
+	 */
+	template<typename Y, typename X>
+	_internal::DualDerivative<Y, X> derivative(Y const& y, X const&, std::size_t const direction = 0)
+	{
+		// The ratio of the scales is part of the quotient type
+		using Result = _internal::DualDerivative<Y, X>;
+		return Result(y.val.tangent[direction]);
+	}
+
+	/**
+	 * derivative() of each of ys, e.g. one column of a Jacobian evaluated
+	 * at many points. Only the common length is written.
+	 */
+	template<typename Ys, typename X, typename Outs>
+	auto derivative(Ys const& ys, X const&, Outs&& out, std::size_t const direction = 0)
+		-> decltype(void(std::declval<_internal::DualDerivative<_internal::ElementType<Ys>, X>>()))
+	{
+		_internal::CheckDerivativeOutput<Ys, X, Outs>();
+		auto const* const src = _internal::BaseData(ys);
+		auto* const dst = _internal::BaseData(out);
+		std::size_t const n = _internal::CommonSize(ys, out);
+		for(std::size_t i = 0; i < n; i++)
+		{
+			dst[i] = src[i].tangent[direction];
+		}
+	}
+}
@@ -0,0 +1,300 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include "mesicore.h"
+#include "mesimath.h"
+
+/**
+ * Fast approximations of common maths functions, for code that can trade
+ * accuracy for speed (e.g. control loops).
+ *
+ * The accuracy policy is selected by namespace: Mesi::Fast holds the
+ * approximations, Mesi::Precise forwards to the full-precision std:: versions
+ * from mesimath.h, so a policy can be picked with a namespace alias:
+ *
+ *     namespace Maths = Mesi::Fast; // or Mesi::Precise
+ *     auto y = Maths::exp(x);
+ *
+ * The dimension rules are the same as mesimath.h: transcendental functions
+ * only accept Scalars, sqrt accepts any type and halves its exponents.
+ *
+ * Maximum errors for float and double, checked by the tests:
+ *  - exp:   relative error below 1e-6; inputs outside the range where the
+ *           result is a normal number saturate to 0 and infinity
+ *  - log:   relative error below 1e-6 for normal positive inputs; zero,
+ *           negative, denormal, infinite and NaN inputs use std::log
+ *  - sin, cos: absolute error below 1e-6 for |x| <= 1e4 radians; the
+ *           range reduction loses accuracy beyond that
+ *  - atan2: absolute error below 1e-6 radians
+ *  - sqrt:  relative error below 1e-6, denormal inputs included
+ *
+ * Only float and double storage types are supported.
+ */
+namespace Mesi {
+	namespace Fast {
+		namespace _internal {
+			template<typename T>
+			struct FloatTraits;
+
+			template<>
+			struct FloatTraits<float>
+			{
+				using Bits = uint32_t;
+				static constexpr int mantissa_bits = 23;
+				static constexpr int exponent_bias = 127;
+				static constexpr Bits rsqrt_magic = 0x5f375a86u;
+
+				// Cody-Waite splits of ln(2) and pi/2: the leading parts have
+				// few enough significant bits that multiplying them by the
+				// reduction quotient is exact
+				static constexpr float ln2_hi = 0.693359375f;
+				static constexpr float ln2_lo = -2.12194440e-4f;
+				static constexpr float half_pi_1 = 1.5703125f;
+				static constexpr float half_pi_2 = 4.837512969970703125e-4f;
+				static constexpr float half_pi_3 = 7.54978995489188216e-8f;
+			};
+
+			template<>
+			struct FloatTraits<double>
+			{
+				using Bits = uint64_t;
+				static constexpr int mantissa_bits = 52;
+				static constexpr int exponent_bias = 1023;
+				static constexpr Bits rsqrt_magic = 0x5fe6eb50c7b537a9ull;
+
+				static constexpr double ln2_hi = 6.93145751953125e-1;
+				static constexpr double ln2_lo = 1.42860682030941723212e-6;
+				static constexpr double half_pi_1 = 1.57079625129699707031e+0;
+				static constexpr double half_pi_2 = 7.54978941586159635335e-8;
+				static constexpr double half_pi_3 = 5.39030285815811905290e-15;
+			};
+
+			template<typename T>
+			inline typename FloatTraits<T>::Bits ToBits(T const x)
+			{
+				typename FloatTraits<T>::Bits ret;
+				std::memcpy(&ret, &x, sizeof(ret));
+				return ret;
+			}
+
+			template<typename T>
+			inline T FromBits(typename FloatTraits<T>::Bits const b)
+			{
+				T ret;
+				std::memcpy(&ret, &b, sizeof(ret));
+				return ret;
+			}
+
+			/**
+			 * Rounds to the nearest integer, returned as a floating-point
+			 * value, by adding and subtracting 1.5 * 2^mantissa_bits. Unlike
+			 * a conversion to int this stays branch-free and vectorises.
+			 */
+			template<typename T>
+			inline T RoundToIntegral(T const x)
+			{
+				T const shifter = T(1.5) * T(typename FloatTraits<T>::Bits(1) << FloatTraits<T>::mantissa_bits);
+				return (x + shifter) - shifter;
+			}
+
+			/**
+			 * 2^k for integral k in the normal exponent range
+			 */
+			template<typename T>
+			inline T Exp2i(T const k)
+			{
+				using Traits = FloatTraits<T>;
+				using Bits = typename Traits::Bits;
+				T const shifter = T(1.5) * T(Bits(1) << Traits::mantissa_bits);
+				// The low bits of k + shifter hold k as a two's complement integer
+				Bits const biased = ToBits(T(k + shifter)) + Bits(Traits::exponent_bias);
+				return FromBits<T>(biased << Traits::mantissa_bits);
+			}
+
+			/*
+			 * The kernels below avoid branches so that loops over them can be
+			 * vectorised; special inputs are handled by selecting the result
+			 * at the end rather than by returning early.
+			 */
+
+			template<typename T>
+			inline T Exp(T const x)
+			{
+				// Limits chosen so that 2^k stays a normal number
+				T const max = T(std::numeric_limits<T>::max_exponent - 1) * T(0.69314718055994530942);
+				T const min = T(std::numeric_limits<T>::min_exponent) * T(0.69314718055994530942);
+				T const clamped = x < min ? min : (x > max ? max : x);
+
+				// x = k*ln(2) + r with |r| <= ln(2)/2, exp(x) = 2^k * exp(r)
+				using Traits = FloatTraits<T>;
+				T const k = RoundToIntegral(clamped * T(1.44269504088896340736));
+				T const r = (clamped - k * Traits::ln2_hi) - k * Traits::ln2_lo;
+
+				T const p = T(1) + r * (T(1) + r * (T(1)/T(2) + r * (T(1)/T(6) + r * (T(1)/T(24) + r * (T(1)/T(120) + r * (T(1)/T(720)))))));
+				T const ret = p * Exp2i(k);
+				return x < min ? T(0) : (x > max ? std::numeric_limits<T>::infinity() : ret);
+			}
+
+			template<typename T>
+			inline T Log(T const x)
+			{
+				using Traits = FloatTraits<T>;
+				using Bits = typename Traits::Bits;
+
+				// Denormals are scaled into the normal range first
+				T const denormal_scale = T(Bits(1) << (Traits::mantissa_bits + 1));
+				bool const denormal = x < std::numeric_limits<T>::min();
+				T const normal = denormal ? x * denormal_scale : x;
+
+				// x = 2^e * m with m in [sqrt(2)/2, sqrt(2))
+				Bits const bits = ToBits(normal);
+				Bits const mantissa_mask = (Bits(1) << Traits::mantissa_bits) - 1;
+				T const m1 = FromBits<T>((bits & mantissa_mask) | (Bits(Traits::exponent_bias) << Traits::mantissa_bits));
+				bool const halve = m1 > T(1.41421356237309504880);
+				T const m = halve ? m1 * T(0.5) : m1;
+				T const e = T(typename std::make_signed<Bits>::type(bits >> Traits::mantissa_bits) - Traits::exponent_bias)
+					+ (halve ? T(1) : T(0))
+					- (denormal ? T(Traits::mantissa_bits + 1) : T(0));
+
+				// log(m) = 2*atanh(s), s = (m-1)/(m+1), with |s| <= 0.172
+				T const s = (m - T(1)) / (m + T(1));
+				T const s2 = s * s;
+				T const log_m = T(2) * s * (T(1) + s2 * (T(1)/T(3) + s2 * (T(1)/T(5) + s2 * (T(1)/T(7) + s2 * (T(1)/T(9))))));
+				T const ret = e * T(0.69314718055994530942) + log_m;
+
+				T const inf = std::numeric_limits<T>::infinity();
+				return x > T(0) ? (x < inf ? ret : inf) : (x == T(0) ? -inf : std::numeric_limits<T>::quiet_NaN());
+			}
+
+			/**
+			 * Shared implementation of sin and cos: evaluates sin(x + quadrant*pi/2)
+			 */
+			template<typename T>
+			inline T SinQuadrant(T const x, int const quadrant)
+			{
+				// x = q*pi/2 + r with |r| <= pi/4
+				using Traits = FloatTraits<T>;
+				T const q = RoundToIntegral(x * T(0.63661977236758134308));
+				T const r = ((x - q * Traits::half_pi_1) - q * Traits::half_pi_2) - q * Traits::half_pi_3;
+				T const r2 = r * r;
+
+				T const c = T(1) - r2 * (T(1)/T(2) - r2 * (T(1)/T(24) - r2 * (T(1)/T(720) - r2 * (T(1)/T(40320)))));
+				T const s = r * (T(1) - r2 * (T(1)/T(6) - r2 * (T(1)/T(120) - r2 * (T(1)/T(5040) - r2 * (T(1)/T(362880))))));
+
+				// The low bits of q + shifter hold q as a two's complement integer
+				T const shifter = T(1.5) * T(typename Traits::Bits(1) << Traits::mantissa_bits);
+				auto const n = (ToBits(T(q + shifter)) + quadrant) & 3;
+				T const ret = (n & 1) ? c : s;
+				return (n & 2) ? -ret : ret;
+			}
+
+			template<typename T>
+			inline T Atan2(T const y, T const x)
+			{
+				T const ax = std::fabs(x);
+				T const ay = std::fabs(y);
+				T const hi = ax > ay ? ax : ay;
+				T const lo = ax > ay ? ay : ax;
+				T const a = hi == T(0) ? T(0) : lo / hi;
+
+				// atan(a) for a in [0, 1], via atan(a) = atan(c) + atan((a-c)/(1+ac)) with
+				// c = 0 or c = 1/2 to keep the series argument below 0.27
+				bool const upper = a > T(0.4);
+				T const t = upper ? (T(2) * a - T(1)) / (T(2) + a) : a;
+				T const t2 = t * t;
+				T const series = t * (T(1) - t2 * (T(1)/T(3) - t2 * (T(1)/T(5) - t2 * (T(1)/T(7) - t2 * (T(1)/T(9) - t2 * (T(1)/T(11) - t2 * (T(1)/T(13))))))));
+				T const r1 = upper ? series + T(0.46364760900080611621) : series;
+
+				T const r2 = ay > ax ? T(1.57079632679489661923) - r1 : r1;
+				T const r3 = x < T(0) ? T(3.14159265358979323846) - r2 : r2;
+				return y < T(0) ? -r3 : r3;
+			}
+
+			template<typename T>
+			inline T Sqrt(T const x)
+			{
+				using Traits = FloatTraits<T>;
+				using Bits = typename Traits::Bits;
+
+				// Denormals are scaled into the normal range first, by an even
+				// power of two so that the root can be scaled back exactly
+				int const root_shift = (Traits::mantissa_bits + 2) / 2;
+				bool const denormal = x < std::numeric_limits<T>::min();
+				T const normal = denormal ? x * T(Bits(1) << (2 * root_shift)) : x;
+
+				// Bit-level estimate of 1/sqrt(x), refined by Newton's method
+				T y = FromBits<T>(Traits::rsqrt_magic - (ToBits(normal) >> 1));
+				T const half_x = T(0.5) * normal;
+				y = y * (T(1.5) - half_x * y * y);
+				y = y * (T(1.5) - half_x * y * y);
+				y = y * (T(1.5) - half_x * y * y);
+				T const root = normal * y;
+				T const ret = denormal ? root / T(Bits(1) << root_shift) : root;
+
+				T const inf = std::numeric_limits<T>::infinity();
+				return x > T(0) ? (x < inf ? ret : inf) : (x == T(0) ? x : std::numeric_limits<T>::quiet_NaN());
+			}
+		}
+
+#define MESI_SCALAR ::Mesi::Type<T, 0, 0, 0>
+#define MESI_TEMPLATE template<typename T, typename t_m, typename t_s, typename t_kg, typename t_A, typename t_K, typename t_mol, typename t_cd, typename t_scale>
+#define MESI_TYPE ::Mesi::RationalTypeReduced<T, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale>
+#define FAST_SCALAR_UNARY(name, impl) \
+		template<typename T> \
+		MESI_SCALAR name(MESI_SCALAR const &x) { \
+			static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value, "Fast maths supports float and double only"); \
+			return MESI_SCALAR(_internal::impl(x.val)); \
+		}
+
+		FAST_SCALAR_UNARY(exp, Exp)
+		FAST_SCALAR_UNARY(log, Log)
+
+		template<typename T>
+		MESI_SCALAR sin(MESI_SCALAR const &x) {
+			static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value, "Fast maths supports float and double only");
+			return MESI_SCALAR(_internal::SinQuadrant(x.val, 0));
+		}
+
+		template<typename T>
+		MESI_SCALAR cos(MESI_SCALAR const &x) {
+			static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value, "Fast maths supports float and double only");
+			return MESI_SCALAR(_internal::SinQuadrant(x.val, 1));
+		}
+
+		/**
+		 * Argument order matches std::atan2, i.e. atan2(y, x)
+		 */
+		template<typename T>
+		MESI_SCALAR atan2(MESI_SCALAR const &y, MESI_SCALAR const &x) {
+			static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value, "Fast maths supports float and double only");
+			return MESI_SCALAR(_internal::Atan2(y.val, x.val));
+		}
+
+		MESI_TEMPLATE
+		auto sqrt(MESI_TYPE const &x) {
+			static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value, "Fast maths supports float and double only");
+			return typename MESI_TYPE::template Pow<std::ratio<1,2>>(_internal::Sqrt(x.val));
+		}
+
+#undef FAST_SCALAR_UNARY
+#undef MESI_TYPE
+#undef MESI_TEMPLATE
+#undef MESI_SCALAR
+	}
+
+	/**
+	 * Full-precision counterpart of Mesi::Fast, so the two can be swapped
+	 * with a namespace alias
+	 */
+	namespace Precise {
+		using std::exp;
+		using std::log;
+		using std::sin;
+		using std::cos;
+		using std::atan2;
+		using std::sqrt;
+	}
+}
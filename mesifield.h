@@ -0,0 +1,453 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "mesicore.h"
+#include "mesiparallel.h"
+#include "mesispan.h"
+
+namespace Mesi {
+	namespace _internal {
+		/**
+		 * Calls f(index) for every index from lo up to but excluding hi,
+		 * with the last dimension varying fastest
+		 */
+		template<std::size_t t_dims, typename F>
+		void ForEachIndex(std::array<std::ptrdiff_t, t_dims> const& lo, std::array<std::ptrdiff_t, t_dims> const& hi, F const& f)
+		{
+			for(std::size_t d = 0; d < t_dims; d++)
+			{
+				if(lo[d] >= hi[d])
+				{
+					return;
+				}
+			}
+			std::array<std::ptrdiff_t, t_dims> index = lo;
+			while(true)
+			{
+				f(index);
+				std::size_t d = t_dims;
+				while(d > 0)
+				{
+					d--;
+					if(++index[d] < hi[d])
+					{
+						break;
+					}
+					index[d] = lo[d];
+					if(d == 0)
+					{
+						return;
+					}
+				}
+			}
+		}
+
+		/**
+		 * Cells per tile: about 64 KiB of floats, so a tile and the rows
+		 * around it that a stencil reads stay in the L2 cache
+		 */
+		constexpr std::size_t c_tile_cells = std::size_t(1) << 14;
+
+		/**
+		 * The longest row segment in a tile
+		 */
+		constexpr std::size_t c_tile_row = std::size_t(1) << 12;
+
+		/**
+		 * Tile extents in the dimensions before the last two, which let
+		 * stencils reuse rows across neighbouring planes
+		 */
+		constexpr std::size_t c_tile_planes = 8;
+
+		/**
+		 * Splits the interior of fields with the given extents into tiles
+		 * and calls row(first, length) for every row segment, with first
+		 * the index of its first cell. Contiguous runs of tiles are handed
+		 * to each thread.
+		 */
+		template<std::size_t t_dims, typename Row>
+		void ForEachTileRow(std::array<std::size_t, t_dims> const& extents, unsigned threads, Row const& row)
+		{
+			using Index = std::array<std::ptrdiff_t, t_dims>;
+			std::size_t cells = 1;
+			for(std::size_t d = 0; d < t_dims; d++)
+			{
+				cells *= extents[d];
+			}
+			if(cells == 0)
+			{
+				return;
+			}
+
+			std::array<std::size_t, t_dims> tile;
+			std::array<std::size_t, t_dims> counts;
+			std::size_t tiles = 1;
+			for(std::size_t d = 0; d < t_dims; d++)
+			{
+				std::size_t const inner = extents[t_dims - 1] < c_tile_row ? extents[t_dims - 1] : c_tile_row;
+				std::size_t const rows = c_tile_cells / inner > 0 ? c_tile_cells / inner : 1;
+				tile[d] = d + 1 == t_dims ? inner : (d + 2 == t_dims ? rows : c_tile_planes);
+				counts[d] = (extents[d] + tile[d] - 1) / tile[d];
+				tiles *= counts[d];
+			}
+
+			ParallelChunks(tiles, ThreadsFor(cells, threads), [&](unsigned, std::size_t begin, std::size_t end) {
+				for(std::size_t t = begin; t < end; t++)
+				{
+					Index lo, hi;
+					std::size_t rest = t;
+					for(std::size_t d = t_dims; d-- > 0;)
+					{
+						std::size_t const start = (rest % counts[d]) * tile[d];
+						rest /= counts[d];
+						lo[d] = std::ptrdiff_t(start);
+						hi[d] = std::ptrdiff_t(start + tile[d] < extents[d] ? start + tile[d] : extents[d]);
+					}
+					std::size_t const length = std::size_t(hi[t_dims - 1] - lo[t_dims - 1]);
+					hi[t_dims - 1] = lo[t_dims - 1] + 1;
+					ForEachIndex(lo, hi, [&](Index const& first) {
+						row(first, length);
+					});
+				}
+			});
+		}
+	}
+
+	/**
+	 * @brief A t_dims-dimensional grid of quantities, with a halo
+	 *
+	 * @param Q the Mesi type of each cell, e.g. Pascals
+	 * @param t_dims the number of dimensions
+	 *
+	 * Cells are indexed like a C array, the last index varying fastest:
+	 * field(z, y, x). The interior runs from 0 to extent - 1 in each
+	 * dimension, and is surrounded by a halo one cell wide, at -1 and
+	 * extent, which stencils read at the edges. The halo is filled by
+	 * fillHalo (fixed values), wrapHalo (periodic) or extendHalo (zero
+	 * gradient), which must be called after the interior changes and before
+	 * a stencil reads it.
+	 *
+	 * Storage is row-major with each row, halo included, padded to whole
+	 * cache lines. Stencils (derivative, gradient, laplacian) visit the
+	 * interior in cache-sized tiles, split across threads, with vectorised
+	 * loops along rows. Custom stencils can use baseData(), offset() and
+	 * strides().
+	 */
+	template<typename Q, std::size_t t_dims>
+	class Field
+	{
+		static_assert(t_dims > 0, "A field needs at least one dimension");
+
+	public:
+		using QuantityType = Q;
+		using BaseType = typename Q::BaseType;
+		using Extents = std::array<std::size_t, t_dims>;
+		using Index = std::array<std::ptrdiff_t, t_dims>;
+
+		static constexpr std::size_t c_dims = t_dims;
+		static constexpr std::ptrdiff_t c_halo = 1;
+
+		Field() = default;
+
+		explicit Field(Extents const& extents, Q const& value = Q())
+			:p_extents(extents)
+		{
+			std::size_t const line = 64 / sizeof(Q) > 0 ? 64 / sizeof(Q) : 1;
+			std::size_t const row = extents[t_dims - 1] + 2 * c_halo;
+			p_strides[t_dims - 1] = 1;
+			std::size_t size = (row + line - 1) / line * line;
+			for(std::size_t d = t_dims - 1; d-- > 0;)
+			{
+				p_strides[d] = size;
+				size *= extents[d] + 2 * c_halo;
+			}
+			p_values.assign(size, value);
+		}
+
+		Extents const& extents() const
+		{
+			return p_extents;
+		}
+
+		/**
+		 * The number of interior cells
+		 */
+		std::size_t size() const
+		{
+			std::size_t ret = 1;
+			for(std::size_t const e : p_extents)
+			{
+				ret *= e;
+			}
+			return ret;
+		}
+
+		/**
+		 * The distance in cells between neighbours in each dimension
+		 */
+		std::array<std::size_t, t_dims> const& strides() const
+		{
+			return p_strides;
+		}
+
+		/**
+		 * The position of a cell, from -1 to its extent in each dimension,
+		 * in baseData()
+		 */
+		std::size_t offset(Index const& index) const
+		{
+			std::size_t ret = 0;
+			for(std::size_t d = 0; d < t_dims; d++)
+			{
+				ret += std::size_t(index[d] + c_halo) * p_strides[d];
+			}
+			return ret;
+		}
+
+		BaseType* baseData()
+		{
+			return view_as<BaseType>(Span<Q>(p_values.data(), p_values.size())).data();
+		}
+
+		BaseType const* baseData() const
+		{
+			return view_as<BaseType>(Span<Q const>(p_values.data(), p_values.size())).data();
+		}
+
+		Q& at(Index const& index)
+		{
+			return p_values[offset(index)];
+		}
+
+		Q const& at(Index const& index) const
+		{
+			return p_values[offset(index)];
+		}
+
+		template<typename... Is>
+		Q& operator()(Is const... indices)
+		{
+			static_assert(sizeof...(Is) == t_dims, "A field needs one index per dimension");
+			return at(Index{{std::ptrdiff_t(indices)...}});
+		}
+
+		template<typename... Is>
+		Q const& operator()(Is const... indices) const
+		{
+			static_assert(sizeof...(Is) == t_dims, "A field needs one index per dimension");
+			return at(Index{{std::ptrdiff_t(indices)...}});
+		}
+
+		/**
+		 * Sets every cell, including the halo
+		 */
+		void fill(Q const& value)
+		{
+			std::fill(p_values.begin(), p_values.end(), value);
+		}
+
+		/**
+		 * Sets the halo to a fixed value (a Dirichlet boundary)
+		 */
+		void fillHalo(Q const& value)
+		{
+			forEachHaloCell([&](Index const&, std::size_t, bool) {
+				return value;
+			});
+		}
+
+		/**
+		 * Copies the opposite edge of the interior into the halo, so the
+		 * field is periodic
+		 */
+		void wrapHalo()
+		{
+			forEachHaloCell([&](Index const& index, std::size_t d, bool low) {
+				Index source = index;
+				source[d] = low ? std::ptrdiff_t(p_extents[d]) - 1 : 0;
+				return at(source);
+			});
+		}
+
+		/**
+		 * Copies the nearest edge of the interior into the halo, so the
+		 * gradient across the boundary is zero (a Neumann boundary)
+		 */
+		void extendHalo()
+		{
+			forEachHaloCell([&](Index const& index, std::size_t d, bool low) {
+				Index source = index;
+				source[d] = low ? 0 : std::ptrdiff_t(p_extents[d]) - 1;
+				return at(source);
+			});
+		}
+
+	private:
+		/**
+		 * Sets each halo cell to value(index, d, low), for the faces normal
+		 * to each dimension d in turn. Faces span the halo of the other
+		 * dimensions, so the corners are set from cells that the earlier
+		 * dimensions have already filled.
+		 */
+		template<typename F>
+		void forEachHaloCell(F const& value)
+		{
+			if(size() == 0)
+			{
+				return;
+			}
+			for(std::size_t d = 0; d < t_dims; d++)
+			{
+				Index lo, hi;
+				for(std::size_t k = 0; k < t_dims; k++)
+				{
+					lo[k] = -c_halo;
+					hi[k] = std::ptrdiff_t(p_extents[k]) + c_halo;
+				}
+				for(bool const low : {true, false})
+				{
+					lo[d] = low ? -c_halo : std::ptrdiff_t(p_extents[d]);
+					hi[d] = lo[d] + 1;
+					_internal::ForEachIndex(lo, hi, [&](Index const& index) {
+						at(index) = value(index, d, low);
+					});
+				}
+			}
+		}
+
+		Extents p_extents{};
+		std::array<std::size_t, t_dims> p_strides{};
+		std::vector<Q> p_values;
+	};
+
+	namespace _internal {
+		template<typename Q, typename X>
+		using FieldDerivativeType = decltype(std::declval<Q>() / std::declval<X>());
+
+		template<typename Q, typename X>
+		using FieldLaplacianType = decltype(std::declval<Q>() / (std::declval<X>() * std::declval<X>()));
+
+		template<typename R, typename Expected, typename Q, std::size_t t_dims>
+		void CheckFieldOutput(Field<Q, t_dims> const& in, Field<R, t_dims> const& out)
+		{
+			static_assert(std::is_same<R, Expected>::value, "The output field must have the type of the result");
+			(void)in;
+			(void)out;
+		}
+
+		/**
+		 * Gives out the extents of in, as stencils index both with the same
+		 * cells. A new field's values are default-initialised.
+		 */
+		template<typename Q, typename R, std::size_t t_dims>
+		void MatchExtents(Field<Q, t_dims> const& in, Field<R, t_dims>& out)
+		{
+			if(out.extents() != in.extents())
+			{
+				out = Field<R, t_dims>(in.extents());
+			}
+		}
+
+		template<typename X, std::size_t t_dims>
+		std::array<X, t_dims> SameSpacings(X const& spacing)
+		{
+			std::array<X, t_dims> ret;
+			ret.fill(spacing);
+			return ret;
+		}
+	}
+
+	/**
+	 * out = the central difference of `in` along dimension t_axis, with
+	 * cells `spacing` apart, e.g. Pascals / Meters from Pascals. out is
+	 * resized to the extents of in if they differ, and in's halo must be
+	 * filled.
+	 */
+	template<std::size_t t_axis, typename Q, typename R, std::size_t t_dims, typename X>
+	void derivative(Field<Q, t_dims> const& in, X const& spacing, Field<R, t_dims>& out, unsigned threads = 0)
+	{
+		static_assert(t_axis < t_dims, "The axis must be one of the field's dimensions");
+		_internal::CheckFieldOutput<R, _internal::FieldDerivativeType<Q, X>>(in, out);
+		_internal::MatchExtents(in, out);
+		using B = typename R::BaseType;
+		B const scale = B(1) / (B(2) * B(spacing.val));
+		std::size_t const stride = in.strides()[t_axis];
+		typename Q::BaseType const* const src = in.baseData();
+		B* const dst = out.baseData();
+		_internal::ForEachTileRow(in.extents(), threads, [&](typename Field<Q, t_dims>::Index const& first, std::size_t const length) {
+			typename Q::BaseType const* const c = src + in.offset(first);
+			B* const o = dst + out.offset(first);
+			for(std::size_t i = 0; i < length; i++)
+			{
+				o[i] = B(c[i + stride] - c[i - stride]) * scale;
+			}
+		});
+	}
+
+	namespace _internal {
+		template<typename Q, typename R, std::size_t t_dims, typename X, std::size_t... t_axes>
+		void GradientAxes(Field<Q, t_dims> const& in, X const& spacing, std::array<Field<R, t_dims>, t_dims>& out,
+			unsigned threads, std::index_sequence<t_axes...>)
+		{
+			int const expand[] = {(derivative<t_axes>(in, spacing, out[t_axes], threads), 0)...};
+			(void)expand;
+		}
+	}
+
+	/**
+	 * out[d] = the derivative of `in` along each dimension d
+	 */
+	template<typename Q, typename R, std::size_t t_dims, typename X>
+	void gradient(Field<Q, t_dims> const& in, X const& spacing, std::array<Field<R, t_dims>, t_dims>& out, unsigned threads = 0)
+	{
+		_internal::CheckFieldOutput<R, _internal::FieldDerivativeType<Q, X>>(in, out[0]);
+		_internal::GradientAxes(in, spacing, out, threads, std::make_index_sequence<t_dims>());
+	}
+
+	/**
+	 * out = the sum of the second central differences of `in` along every
+	 * dimension, with the given spacing along each, e.g. Kelvin / Meters^2
+	 * from Kelvin. out is resized to the extents of in if they differ, and
+	 * in's halo must be filled.
+	 */
+	template<typename Q, typename R, std::size_t t_dims, typename X>
+	void laplacian(Field<Q, t_dims> const& in, std::array<X, t_dims> const& spacings, Field<R, t_dims>& out, unsigned threads = 0)
+	{
+		_internal::CheckFieldOutput<R, _internal::FieldLaplacianType<Q, X>>(in, out);
+		_internal::MatchExtents(in, out);
+		using B = typename R::BaseType;
+		std::array<B, t_dims> weights;
+		B centre = 0;
+		for(std::size_t d = 0; d < t_dims; d++)
+		{
+			weights[d] = B(1) / (B(spacings[d].val) * B(spacings[d].val));
+			centre += B(2) * weights[d];
+		}
+		std::array<std::size_t, t_dims> const strides = in.strides();
+		typename Q::BaseType const* const src = in.baseData();
+		B* const dst = out.baseData();
+		_internal::ForEachTileRow(in.extents(), threads, [&](typename Field<Q, t_dims>::Index const& first, std::size_t const length) {
+			typename Q::BaseType const* const c = src + in.offset(first);
+			B* const o = dst + out.offset(first);
+			for(std::size_t i = 0; i < length; i++)
+			{
+				B sum = -centre * B(c[i]);
+				for(std::size_t d = 0; d < t_dims; d++)
+				{
+					sum += weights[d] * B(c[i + strides[d]] + c[i - strides[d]]);
+				}
+				o[i] = sum;
+			}
+		});
+	}
+
+	template<typename Q, typename R, std::size_t t_dims, typename X>
+	void laplacian(Field<Q, t_dims> const& in, X const& spacing, Field<R, t_dims>& out, unsigned threads = 0)
+	{
+		laplacian(in, _internal::SameSpacings<X, t_dims>(spacing), out, threads);
+	}
+}
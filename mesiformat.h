@@ -0,0 +1,115 @@
+#pragma once
+#include <string>
+#include "mesicore.h"
+
+MESI_EXPORT namespace Mesi {
+	namespace _internal {
+		/**
+		 * Appends the decimal digits of v to s. std::to_string isn't used as
+		 * some compilers fail to link it when instantiated from the module.
+		 */
+		inline void AppendInteger(std::string& s, long long v)
+		{
+			char digits[24];
+			int n = 0;
+			unsigned long long u = v < 0 ? 0ull - static_cast<unsigned long long>(v) : static_cast<unsigned long long>(v);
+			do
+			{
+				digits[n++] = char('0' + u % 10);
+				u /= 10;
+			} while(u);
+			if(v < 0)
+			{
+				s += '-';
+			}
+			while(n)
+			{
+				s += digits[--n];
+			}
+		}
+
+		/**
+		 * Builds SI-style unit strings, e.g. "m s^-2 kg". The string for each
+		 * type is built once and cached. Only appends are used, as some
+		 * compilers can't find std::string's operator+ when this is
+		 * instantiated from the module.
+		 */
+		template<typename Type>
+		struct UnitFormatter
+		{
+			static std::string format() {
+				using t_scale = typename Type::ScaleInfo;
+				using t_m = typename Type::MeterExponent;
+				using t_s = typename Type::SecondExponent;
+				using t_kg = typename Type::KilogramExponent;
+				using t_A = typename Type::AmpereExponent;
+				using t_K = typename Type::KelvinExponent;
+				using t_mol = typename Type::MoleExponent;
+				using t_cd = typename Type::CandelaExponent;
+
+				static std::string s_unitString("");
+				if( s_unitString.size() > 0 )
+					return s_unitString;
+
+				if( t_scale::ratio::num != 1 )
+				{
+					s_unitString += " * ";
+					if( t_scale::exponent_denominator != 1 && t_scale::ratio::den != 1 )
+					{
+						s_unitString += "(";
+					}
+					AppendInteger(s_unitString, t_scale::ratio::num);
+					if( t_scale::ratio::den != 1 )
+					{
+						s_unitString += "/";
+						AppendInteger(s_unitString, t_scale::ratio::den);
+					}
+					if( t_scale::exponent_denominator != 1 )
+					{
+						if( t_scale::ratio::den != 1 )
+						{
+							s_unitString += ")";
+						}
+						s_unitString += "^(1/";
+						AppendInteger(s_unitString, t_scale::exponent_denominator);
+						s_unitString += ")";
+					}
+					s_unitString += " ";
+				}
+
+				if( t_scale::power_of_ten::num != 0 )
+				{
+					s_unitString += "* 10^";
+					if(t_scale::power_of_ten::den != 1)
+					{
+						s_unitString += "(";
+					}
+					AppendInteger(s_unitString, t_scale::power_of_ten::num);
+					if(t_scale::power_of_ten::den != 1)
+					{
+						s_unitString += "/";
+						AppendInteger(s_unitString, t_scale::power_of_ten::den);
+						s_unitString += ")";
+					}
+					s_unitString += " ";
+				}
+
+#define DIM_TO_STRING(TP) \
+				if( t_##TP ::num == 1 && t_##TP ::den == 1 ) { s_unitString += #TP " "; } \
+				else if( t_##TP ::num != 0 && t_##TP ::den == 1) { s_unitString += #TP "^"; AppendInteger(s_unitString, t_##TP ::num); s_unitString += " "; } \
+				else if(t_##TP ::num != 0) { s_unitString += #TP "^("; AppendInteger(s_unitString, t_##TP ::num); s_unitString += "/"; AppendInteger(s_unitString, t_##TP ::den); s_unitString += ") "; }
+				DIM_TO_STRING(m)
+				DIM_TO_STRING(s)
+				DIM_TO_STRING(kg)
+				DIM_TO_STRING(A)
+				DIM_TO_STRING(K)
+				DIM_TO_STRING(mol)
+				DIM_TO_STRING(cd)
+#undef DIM_TO_STRING
+
+				s_unitString = s_unitString.substr(0, s_unitString.size() - 1);
+				return s_unitString;
+			}
+		};
+	}
+}
@@ -0,0 +1,428 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "mesicore.h"
+#include "mesispan.h"
+#include "mesiparallel.h"
+
+namespace Mesi {
+	namespace _internal {
+		/**
+		 * Open-addressing hash table from keys to dense group numbers, given
+		 * out in the order keys are first seen. Slots hold the key and its
+		 * group side by side and collisions probe the following slots, so a
+		 * lookup usually touches one cache line. The table doubles when half
+		 * full.
+		 */
+		template<typename Key>
+		class GroupTable
+		{
+		public:
+			static constexpr uint32_t c_missing = std::numeric_limits<uint32_t>::max();
+
+			GroupTable()
+				:p_slots(16, Slot{Key(), c_missing}), p_shift(64 - 4)
+			{}
+
+			/**
+			 * The group of key, adding a new group if it has none
+			 */
+			uint32_t insert(Key const key)
+			{
+				std::size_t const mask = p_slots.size() - 1;
+				Slot const* const slots = p_slots.data();
+				std::size_t i = slotOf(key);
+				// Nearly all keys are within c_window slots of their own, so those
+				// are checked without branches. At most one holds key, and the
+				// others, like empty slots, give all ones.
+				uint32_t near = c_missing;
+				for(std::size_t j = 0; j < c_window; j++)
+				{
+					Slot const& slot = slots[(i + j) & mask];
+					near &= slot.group | (0u - uint32_t(slot.key != key));
+				}
+				if(near != c_missing)
+				{
+					return near;
+				}
+				for(; slots[i].group != c_missing; i = (i + 1) & mask)
+				{
+					if(slots[i].key == key)
+					{
+						return slots[i].group;
+					}
+				}
+				return add(key, i);
+			}
+
+			/**
+			 * The group of key, or c_missing
+			 */
+			uint32_t find(Key const key) const
+			{
+				std::size_t const mask = p_slots.size() - 1;
+				for(std::size_t i = slotOf(key);; i = (i + 1) & mask)
+				{
+					Slot const& slot = p_slots[i];
+					if(slot.group == c_missing || slot.key == key)
+					{
+						return slot.group;
+					}
+				}
+			}
+
+			std::vector<Key> const& keys() const { return p_keys; }
+
+		private:
+			static constexpr std::size_t c_window = 4;
+
+			struct Slot
+			{
+				Key key;
+				uint32_t group;
+			};
+
+			/**
+			 * The top bits of the key after MurmurHash3's finaliser. A plain
+			 * multiplicative hash piles IDs with a regular stride, which device
+			 * IDs often have, into a few runs of slots.
+			 */
+			std::size_t slotOf(Key const key) const
+			{
+				uint64_t h = uint64_t(key);
+				h = (h ^ (h >> 33)) * UINT64_C(0xff51afd7ed558ccd);
+				h = (h ^ (h >> 33)) * UINT64_C(0xc4ceb9fe1a85ec53);
+				return std::size_t((h ^ (h >> 33)) >> p_shift);
+			}
+
+			/**
+			 * Gives key the next group in the empty slot i, where its probe ended
+			 */
+			uint32_t add(Key const key, std::size_t const i)
+			{
+				if(2 * (p_keys.size() + 1) > p_slots.size())
+				{
+					grow();
+					return insert(key);
+				}
+				uint32_t const group = uint32_t(p_keys.size());
+				p_slots[i] = Slot{key, group};
+				p_keys.push_back(key);
+				return group;
+			}
+
+			void grow()
+			{
+				std::vector<Slot> old(p_slots.size() * 2, Slot{Key(), c_missing});
+				old.swap(p_slots);
+				p_shift--;
+				std::size_t const mask = p_slots.size() - 1;
+				for(Slot const& slot : old)
+				{
+					if(slot.group == c_missing)
+					{
+						continue;
+					}
+					std::size_t i = slotOf(slot.key);
+					while(p_slots[i].group != c_missing)
+					{
+						i = (i + 1) & mask;
+					}
+					p_slots[i] = slot;
+				}
+			}
+
+			std::vector<Slot> p_slots;
+			std::vector<Key> p_keys;
+			unsigned p_shift;
+		};
+
+		template<typename Key>
+		constexpr uint32_t GroupTable<Key>::c_missing;
+
+		template<typename Key>
+		constexpr std::size_t GroupTable<Key>::c_window;
+
+		template<typename Result, typename Outs>
+		void CheckGroupOutput()
+		{
+			static_assert(std::is_same<ElementType<Outs>, Result>::value,
+				"The output must have the type of the aggregate, e.g. Joules for the sum of Watts times Seconds");
+		}
+	}
+
+	/**
+	 * @brief Aggregates of quantity columns per key, e.g. per device ID
+	 *
+	 * @param Key the integer type of the key column
+	 * @param Accumulator storage type used for sums and means. This
+	 *        defaults to double so that large groups of float values don't
+	 *        lose precision.
+	 *
+	 * Groups the rows of a key column once, then computes any number of
+	 * aggregates of value columns with the same rows, one value per group:
+	 *
+	 *     GroupBy<uint32_t> devices(deviceIds);
+	 *     devices.sumProduct(power, durations, energy);   // Joules per device
+	 *     devices.max(power, peak);                       // Watts
+	 *     devices.mean(temperature, typical);             // Kelvin
+	 *
+	 * The output containers must hold the type of each aggregate, which is
+	 * checked at compile time, and have a value per group, in the order of
+	 * keys().
+	 *
+	 * Rows are split between threads. Each thread groups its rows with its
+	 * own hash table, and aggregates into its own partial results, which
+	 * are merged in order at the end, so the results only depend on the
+	 * number of threads. See mesiparallel.h for the `threads` arguments.
+	 */
+	template<typename Key, typename Accumulator = double>
+	class GroupBy
+	{
+		static_assert(std::is_integral<Key>::value, "Group keys must be integers");
+
+	public:
+		using KeyType = Key;
+
+		GroupBy() = default;
+
+		explicit GroupBy(Span<Key const> keys, unsigned threads = 0)
+			:p_groups(keys.size())
+		{
+			std::size_t const rows = keys.size();
+			threads = _internal::ThreadsFor(rows, threads);
+			std::vector<_internal::GroupTable<Key>> tables(threads);
+			std::vector<std::vector<std::size_t>> counts(threads);
+			_internal::ParallelChunks(rows, threads, [&](unsigned const chunk, std::size_t const begin, std::size_t const end) {
+				_internal::GroupTable<Key>& table = tables[chunk];
+				std::vector<std::size_t>& count = counts[chunk];
+				for(std::size_t i = begin; i < end; i++)
+				{
+					uint32_t const group = table.insert(keys[i]);
+					count.resize(table.keys().size());
+					count[group]++;
+					p_groups[i] = group;
+				}
+			});
+
+			// Each chunk's groups in order of first appearance, chunk by chunk,
+			// which is the order of first appearance in the whole column
+			std::vector<std::vector<uint32_t>> global(threads);
+			for(unsigned chunk = 0; chunk < threads; chunk++)
+			{
+				std::vector<Key> const& local = tables[chunk].keys();
+				global[chunk].resize(local.size());
+				for(std::size_t g = 0; g < local.size(); g++)
+				{
+					global[chunk][g] = p_table.insert(local[g]);
+					p_counts.resize(p_table.keys().size());
+					p_counts[global[chunk][g]] += counts[chunk][g];
+				}
+			}
+			if(threads > 1)
+			{
+				_internal::ParallelChunks(rows, threads, [&](unsigned const chunk, std::size_t const begin, std::size_t const end) {
+					uint32_t const* const remap = global[chunk].data();
+					for(std::size_t i = begin; i < end; i++)
+					{
+						p_groups[i] = remap[p_groups[i]];
+					}
+				});
+			}
+		}
+
+		/**
+		 * The number of groups
+		 */
+		std::size_t size() const { return p_table.keys().size(); }
+
+		/**
+		 * The key of each group, in the order they first appear in the column
+		 */
+		Span<Key const> keys() const { return Span<Key const>(p_table.keys().data(), size()); }
+
+		/**
+		 * The number of rows in each group
+		 */
+		Span<std::size_t const> counts() const { return Span<std::size_t const>(p_counts.data(), p_counts.size()); }
+
+		/**
+		 * The group of each row
+		 */
+		Span<uint32_t const> groups() const { return Span<uint32_t const>(p_groups.data(), p_groups.size()); }
+
+		/**
+		 * The group of key, or size() if it isn't in the column
+		 */
+		std::size_t find(Key const key) const
+		{
+			uint32_t const group = p_table.find(key);
+			return group == _internal::GroupTable<Key>::c_missing ? size() : group;
+		}
+
+		/**
+		 * The sum of values per group, e.g. Joules from Joules
+		 */
+		template<typename Values, typename Outs>
+		void sum(Values const& values, Outs&& out, unsigned threads = 0) const
+		{
+			using Q = _internal::ElementType<Values>;
+			_internal::CheckGroupOutput<Q, Outs>();
+			auto const* const v = _internal::BaseData(values);
+			auto const sums = reduce(rowsIn(values), threads, Accumulator(0), [v](Accumulator& sum, std::size_t const i) {
+				sum += Accumulator(v[i]);
+			}, [](Accumulator& into, Accumulator const& from) {
+				into += from;
+			});
+			write(sums, out, [](Accumulator const sum, std::size_t) {
+				return sum;
+			});
+		}
+
+		/**
+		 * The sum of a[i] * b[i] per group, e.g. Joules from Watts and Seconds
+		 */
+		template<typename As, typename Bs, typename Outs>
+		void sumProduct(As const& a, Bs const& b, Outs&& out, unsigned threads = 0) const
+		{
+			using Q = decltype(_internal::ElementType<As>() * _internal::ElementType<Bs>());
+			_internal::CheckGroupOutput<Q, Outs>();
+			auto const* const x = _internal::BaseData(a);
+			auto const* const y = _internal::BaseData(b);
+			std::size_t const rows = rowsIn(a) < rowsIn(b) ? rowsIn(a) : rowsIn(b);
+			auto const sums = reduce(rows, threads, Accumulator(0), [x, y](Accumulator& sum, std::size_t const i) {
+				sum += Accumulator(x[i]) * Accumulator(y[i]);
+			}, [](Accumulator& into, Accumulator const& from) {
+				into += from;
+			});
+			write(sums, out, [](Accumulator const sum, std::size_t) {
+				return sum;
+			});
+		}
+
+		/**
+		 * The mean of values per group, over the group's rows in `values`
+		 */
+		template<typename Values, typename Outs>
+		void mean(Values const& values, Outs&& out, unsigned threads = 0) const
+		{
+			using Q = _internal::ElementType<Values>;
+			_internal::CheckGroupOutput<Q, Outs>();
+			auto const* const v = _internal::BaseData(values);
+			using Partial = std::pair<Accumulator, std::size_t>;
+			auto const sums = reduce(rowsIn(values), threads, Partial(Accumulator(0), 0), [v](Partial& p, std::size_t const i) {
+				p.first += Accumulator(v[i]);
+				p.second++;
+			}, [](Partial& into, Partial const& from) {
+				into.first += from.first;
+				into.second += from.second;
+			});
+			write(sums, out, [](Partial const& p, std::size_t) {
+				return p.first / Accumulator(p.second);
+			});
+		}
+
+		/**
+		 * The smallest of values per group
+		 */
+		template<typename Values, typename Outs>
+		void min(Values const& values, Outs&& out, unsigned threads = 0) const
+		{
+			extreme<false>(values, out, threads);
+		}
+
+		/**
+		 * The largest of values per group
+		 */
+		template<typename Values, typename Outs>
+		void max(Values const& values, Outs&& out, unsigned threads = 0) const
+		{
+			extreme<true>(values, out, threads);
+		}
+
+	private:
+		/**
+		 * The rows of the key column that a value column also has
+		 */
+		template<typename Values>
+		std::size_t rowsIn(Values const& values) const
+		{
+			std::size_t const n = _internal::Size(values);
+			return n < p_groups.size() ? n : p_groups.size();
+		}
+
+		/**
+		 * Folds the first `rows` rows into a partial result per group with
+		 * add(partial, row), on each thread separately, then merges the
+		 * threads' partial results in order
+		 */
+		template<typename Partial, typename Add, typename Merge>
+		std::vector<Partial> reduce(std::size_t const rows, unsigned threads, Partial const& initial, Add const& add, Merge const& merge) const
+		{
+			threads = _internal::ThreadsFor(rows, threads);
+			std::vector<std::vector<Partial>> partials(threads);
+			_internal::ParallelChunks(rows, threads, [&](unsigned const chunk, std::size_t const begin, std::size_t const end) {
+				std::vector<Partial>& partial = partials[chunk];
+				partial.assign(size(), initial);
+				Partial* const p = partial.data();
+				uint32_t const* const g = p_groups.data();
+				for(std::size_t i = begin; i < end; i++)
+				{
+					add(p[g[i]], i);
+				}
+			});
+			for(unsigned chunk = 1; chunk < threads; chunk++)
+			{
+				for(std::size_t group = 0; group < size(); group++)
+				{
+					merge(partials[0][group], partials[chunk][group]);
+				}
+			}
+			return std::move(partials[0]);
+		}
+
+		/**
+		 * Writes finish(partial, group) for each group, as far as out goes
+		 */
+		template<typename Partial, typename Outs, typename Finish>
+		void write(std::vector<Partial> const& partials, Outs& out, Finish const& finish) const
+		{
+			using B = typename _internal::ElementType<Outs>::BaseType;
+			B* const dst = _internal::BaseData(out);
+			std::size_t const n = _internal::Size(out) < partials.size() ? _internal::Size(out) : partials.size();
+			for(std::size_t group = 0; group < n; group++)
+			{
+				dst[group] = B(finish(partials[group], group));
+			}
+		}
+
+		template<bool t_max, typename Values, typename Outs>
+		void extreme(Values const& values, Outs& out, unsigned threads) const
+		{
+			using Q = _internal::ElementType<Values>;
+			using B = typename Q::BaseType;
+			_internal::CheckGroupOutput<Q, Outs>();
+			B const* const v = _internal::BaseData(values);
+			B const initial = std::numeric_limits<B>::has_infinity
+				? (t_max ? -std::numeric_limits<B>::infinity() : std::numeric_limits<B>::infinity())
+				: (t_max ? std::numeric_limits<B>::lowest() : std::numeric_limits<B>::max());
+			auto const pick = [](B& into, B const x) {
+				into = (t_max ? into < x : x < into) ? x : into;
+			};
+			auto const results = reduce(rowsIn(values), threads, initial, [v, pick](B& e, std::size_t const i) {
+				pick(e, v[i]);
+			}, pick);
+			write(results, out, [](B const e, std::size_t) {
+				return e;
+			});
+		}
+
+		_internal::GroupTable<Key> p_table;
+		std::vector<uint32_t> p_groups;
+		std::vector<std::size_t> p_counts;
+	};
+}
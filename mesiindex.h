@@ -0,0 +1,295 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+#include "mesicore.h"
+#include "mesispan.h"
+
+/*
+ * Fetches the cache line at an address ahead of a load that will need it
+ */
+#if defined(__GNUC__)
+#	define MESI_PREFETCH(address) __builtin_prefetch(address)
+#else
+#	define MESI_PREFETCH(address)
+#endif
+
+namespace Mesi {
+	namespace _internal {
+		/**
+		 * Q with its scale replaced by t_scale, so that bounds in any scale
+		 * of Q can be checked against it
+		 */
+		template<typename Q, typename t_scale>
+		struct WithScale;
+
+		template<typename T, typename t_m, typename t_s, typename t_kg, typename t_A, typename t_K, typename t_mol, typename t_cd, typename t_scale, typename t_scale2>
+		struct WithScale<RationalTypeReduced<T, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale>, t_scale2>
+		{
+			using Type = RationalTypeReduced<T, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale2>;
+		};
+
+		/**
+		 * The slot an Eytzinger search ends on, from the position k it walked
+		 * off the bottom of the tree at. Each step went left (k = 2k) at a
+		 * value not below the key, so the answer is the last of those, found
+		 * by dropping the trailing right turns (ones) and the left turn
+		 * before them. 0 if the search never went left.
+		 */
+		inline std::size_t EytzingerSlot(std::size_t const k)
+		{
+#if defined(__GNUC__)
+			return ~k == 0 ? 0 : k >> (__builtin_ctzll(static_cast<unsigned long long>(~k)) + 1);
+#else
+			std::size_t slot = k;
+			while(slot & 1)
+			{
+				slot >>= 1;
+			}
+			return slot >> 1;
+#endif
+		}
+	}
+
+	/**
+	 * @brief Read-only index for range queries over a column of quantities
+	 *
+	 * @param Q the Mesi type of the values, e.g. Meters
+	 *
+	 * Answers questions such as "which readings are between 3 km and 5 km"
+	 * in logarithmic time instead of a scan:
+	 *
+	 *     SortedIndex<Meters> index(altitudes);
+	 *     for(std::size_t row : index.between(Kilo<Meters>(3), Kilo<Meters>(5))) ...
+	 *
+	 * The values are copied and sorted, keeping the position each came from
+	 * (its row). Searches run over a second copy laid out in Eytzinger
+	 * (breadth-first) order, padded to a complete tree, so that every search
+	 * takes the same number of branch-free steps and the next few levels are
+	 * in a cache line that can be fetched ahead. lowerBounds() interleaves
+	 * many searches to hide the memory latency of each.
+	 *
+	 * Bounds can have any scale of Q, e.g. kilometres for an index of
+	 * metres. They're converted to Q once, by a factor known at compile
+	 * time, rather than the values being converted during the search.
+	 *
+	 * The values must not be NaN, which has no place in the order. The index
+	 * takes about three times the memory of the values plus a row per value.
+	 */
+	template<typename Q>
+	class SortedIndex
+	{
+	public:
+		using ValueType = Q;
+		using BaseType = typename Q::BaseType;
+
+		static_assert(std::numeric_limits<BaseType>::is_specialized,
+			"SortedIndex needs an ordered arithmetic storage type");
+
+		SortedIndex()
+			:p_tree(1), p_ranks(1, 0), p_depth(0)
+		{}
+
+		explicit SortedIndex(Span<Q const> values)
+			:p_rows(values.size())
+		{
+			std::iota(p_rows.begin(), p_rows.end(), std::size_t(0));
+			std::stable_sort(p_rows.begin(), p_rows.end(), [&](std::size_t const a, std::size_t const b) {
+				return values[a].val < values[b].val;
+			});
+			p_values.resize(values.size());
+			for(std::size_t i = 0; i < values.size(); i++)
+			{
+				p_values[i] = values[p_rows[i]];
+			}
+
+			p_depth = 0;
+			while((std::size_t(1) << p_depth) - 1 < values.size())
+			{
+				p_depth++;
+			}
+			p_tree.resize(std::size_t(1) << p_depth);
+			p_ranks.resize(p_tree.size());
+			std::size_t rank = 0;
+			fill(1, rank);
+			p_ranks[0] = values.size();
+		}
+
+		std::size_t size() const { return p_values.size(); }
+
+		/**
+		 * The values in increasing order
+		 */
+		Span<Q const> values() const { return Span<Q const>(p_values.data(), p_values.size()); }
+
+		/**
+		 * The position in the indexed column of each of values(), so equal
+		 * values keep their original order
+		 */
+		Span<std::size_t const> rows() const { return Span<std::size_t const>(p_rows.data(), p_rows.size()); }
+
+		/**
+		 * The number of values below bound, i.e. the position in values() of
+		 * the first value not below it
+		 */
+		template<typename Bound>
+		std::size_t lowerBound(Bound const& bound) const
+		{
+			return search<false>(convert(bound));
+		}
+
+		/**
+		 * The number of values not above bound
+		 */
+		template<typename Bound>
+		std::size_t upperBound(Bound const& bound) const
+		{
+			return search<true>(convert(bound));
+		}
+
+		/**
+		 * The rows with values from lo to hi inclusive, in increasing order of
+		 * value
+		 */
+		template<typename Lo, typename Hi>
+		Span<std::size_t const> between(Lo const& lo, Hi const& hi) const
+		{
+			return slice(lowerBound(lo), upperBound(hi));
+		}
+
+		/**
+		 * The rows with values greater than bound, in increasing order of
+		 * value
+		 */
+		template<typename Bound>
+		Span<std::size_t const> above(Bound const& bound) const
+		{
+			return slice(upperBound(bound), size());
+		}
+
+		/**
+		 * The rows with values less than bound, in increasing order of value
+		 */
+		template<typename Bound>
+		Span<std::size_t const> below(Bound const& bound) const
+		{
+			return slice(0, lowerBound(bound));
+		}
+
+		/**
+		 * lowerBound() of every key in `keys`, writing to out, which must be
+		 * at least as long. Runs c_batch searches side by side, so their
+		 * cache misses overlap.
+		 */
+		void lowerBounds(Span<Q const> keys, Span<std::size_t> out) const
+		{
+			std::size_t const n = keys.size();
+			std::size_t i = 0;
+			for(; i + c_batch <= n; i += c_batch)
+			{
+				std::size_t k[c_batch];
+				for(std::size_t j = 0; j < c_batch; j++)
+				{
+					k[j] = 1;
+				}
+				for(unsigned level = 0; level < p_depth; level++)
+				{
+					for(std::size_t j = 0; j < c_batch; j++)
+					{
+						k[j] = 2 * k[j] + std::size_t(p_tree[k[j]] < keys[i + j].val);
+					}
+				}
+				for(std::size_t j = 0; j < c_batch; j++)
+				{
+					out[i + j] = p_ranks[_internal::EytzingerSlot(k[j])];
+				}
+			}
+			for(; i < n; i++)
+			{
+				out[i] = search<false>(keys[i].val);
+			}
+		}
+
+	private:
+		/** The number of searches lowerBounds() interleaves */
+		static constexpr std::size_t c_batch = 8;
+		/**
+		 * How many levels below the current slot are prefetched. Slots
+		 * 2^c_prefetch * k onwards are the descendants of k that many levels
+		 * down, which are contiguous.
+		 */
+		static constexpr unsigned c_prefetch = 4;
+
+		template<typename Bound>
+		static BaseType convert(Bound const& bound)
+		{
+			static_assert(std::is_same<typename _internal::WithScale<Bound, typename Q::ScaleInfo>::Type, Q>::value,
+				"Bounds must have the units and storage type of the indexed values");
+			return Q(bound).val;
+		}
+
+		/**
+		 * The position in values() of the first value not below x, or with
+		 * t_upper of the first value above x. The tree is complete, so the
+		 * loop always runs p_depth times.
+		 */
+		template<bool t_upper>
+		std::size_t search(BaseType const x) const
+		{
+			std::size_t k = 1;
+			std::size_t const last = p_tree.size() - 1;
+			for(unsigned level = 0; level < p_depth; level++)
+			{
+				MESI_PREFETCH(p_tree.data() + std::min(k << c_prefetch, last));
+				bool const right = t_upper ? !(x < p_tree[k]) : p_tree[k] < x;
+				k = 2 * k + std::size_t(right);
+			}
+			return p_ranks[_internal::EytzingerSlot(k)];
+		}
+
+		/**
+		 * Places the sorted values in the subtree at slot k in order, with
+		 * the largest value of the storage type in the slots past the last
+		 * value, so they sort after everything
+		 */
+		void fill(std::size_t const k, std::size_t& rank)
+		{
+			if(k >= p_tree.size())
+			{
+				return;
+			}
+			fill(2 * k, rank);
+			bool const padding = rank >= p_values.size();
+			p_tree[k] = padding ? Largest() : p_values[rank].val;
+			p_ranks[k] = padding ? p_values.size() : rank;
+			rank++;
+			fill(2 * k + 1, rank);
+		}
+
+		static BaseType Largest()
+		{
+			return std::numeric_limits<BaseType>::has_infinity
+				? std::numeric_limits<BaseType>::infinity()
+				: std::numeric_limits<BaseType>::max();
+		}
+
+		Span<std::size_t const> slice(std::size_t const begin, std::size_t const end) const
+		{
+			return end > begin ? Span<std::size_t const>(p_rows.data() + begin, end - begin) : Span<std::size_t const>();
+		}
+
+		std::vector<Q> p_values;
+		std::vector<std::size_t> p_rows;
+		/** The values in Eytzinger order from slot 1, padded to 2^p_depth slots */
+		std::vector<BaseType> p_tree;
+		/** The position in p_values of each slot's value, or size() for padding */
+		std::vector<std::size_t> p_ranks;
+		unsigned p_depth;
+	};
+}
+
+#undef MESI_PREFETCH
@@ -0,0 +1,465 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "mesicore.h"
+#include "mesispan.h"
+
+/*
+ * Tells the compiler the loop that follows has no dependencies between
+ * iterations. Gathers through an index that was itself loaded can't be
+ * checked for overlap with the stores, which stops the non-uniform loops
+ * vectorising otherwise.
+ */
+#if defined(__clang__)
+#	define MESI_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#	define MESI_IVDEP _Pragma("GCC ivdep")
+#else
+#	define MESI_IVDEP
+#endif
+
+namespace Mesi {
+	/**
+	 * How a Lut interpolates between its entries
+	 */
+	enum class LutInterpolation
+	{
+		/** Straight lines between entries */
+		Linear,
+		/**
+		 * Cubic Hermite curves through the entries, with slopes estimated
+		 * from neighbouring entries. Exact for quadratics.
+		 */
+		Cubic
+	};
+
+	/**
+	 * @brief Lookup table of a function from In to Out
+	 *
+	 * @param In the Mesi type of the input, e.g. Kelvin
+	 * @param Out the Mesi type of the output, e.g. Pascals
+	 * @param t_interpolation how values between entries are found
+	 *
+	 * Replaces an expensive function with interpolation between values
+	 * sampled from it, e.g. a vapour pressure curve that would otherwise
+	 * call exp():
+	 *
+	 *     auto table = Lut<Kelvin, Pascals>::sample(vapourPressure, 273_k, 373_k, 256);
+	 *     Pascals p = table(300_k);
+	 *
+	 * Only In is accepted as input and only Out is returned, so the table
+	 * keeps the dimension checks of the function it replaces.
+	 *
+	 * The entries can be evenly spaced, which makes finding them a
+	 * multiplication, or at any increasing inputs, which needs a search.
+	 * Inputs outside the table give the value at the nearest end.
+	 *
+	 * The span overload of operator() evaluates many inputs at once. With
+	 * evenly spaced entries its loop is branch-free, so compilers can
+	 * vectorise it with gathers (e.g. AVX2 with -march=native).
+	 */
+	template<typename In, typename Out, LutInterpolation t_interpolation = LutInterpolation::Linear>
+	class Lut
+	{
+	public:
+		using InputType = In;
+		using OutputType = Out;
+		using InBase = typename In::BaseType;
+		using OutBase = typename Out::BaseType;
+
+		static_assert(std::is_floating_point<InBase>::value, "Lut inputs must be stored as floating point");
+		static_assert(std::is_floating_point<OutBase>::value, "Lut outputs must be stored as floating point");
+
+		Lut() = default;
+
+		/**
+		 * A table of values at `values.size()` evenly spaced inputs from
+		 * min to max. At least two values are needed.
+		 */
+		Lut(In const& min, In const& max, Span<Out const> values)
+			:p_min(min.val), p_max(max.val),
+			p_step((max.val - min.val) / InBase(values.size() - 1)),
+			p_inv_step(InBase(values.size() - 1) / (max.val - min.val)),
+			p_values(ToBase(values))
+		{
+			initSlopes();
+		}
+
+		/**
+		 * A table of values at the given inputs, which must be strictly
+		 * increasing. At least two values are needed.
+		 */
+		Lut(Span<In const> inputs, Span<Out const> values)
+			:p_min(inputs[0].val), p_max(inputs[inputs.size() - 1].val),
+			p_step(0), p_inv_step(0),
+			p_inputs(ToBase(inputs)), p_values(ToBase(values))
+		{
+			initHints();
+			initSlopes();
+		}
+
+		/**
+		 * Samples f at `count` evenly spaced inputs from min to max. f must
+		 * take In and return Out, or Out with a different scale or storage
+		 * type.
+		 */
+		template<typename F>
+		static Lut sample(F const& f, In const& min, In const& max, std::size_t count)
+		{
+			count = count < 2 ? 2 : count;
+			std::vector<Out> values(count);
+			for(std::size_t i = 0; i < count; i++)
+			{
+				// Computed from both ends, so the last input is exactly max
+				InBase const t = InBase(i) / InBase(count - 1);
+				values[i] = Evaluate(f, In(min.val * (InBase(1) - t) + max.val * t));
+			}
+			return Lut(min, max, values);
+		}
+
+		/**
+		 * Samples f at the given inputs, which must be strictly increasing.
+		 * Denser inputs where f curves most give better accuracy for the
+		 * same size.
+		 */
+		template<typename F>
+		static Lut sample(F const& f, Span<In const> inputs)
+		{
+			std::vector<Out> values(inputs.size());
+			for(std::size_t i = 0; i < inputs.size(); i++)
+			{
+				values[i] = Evaluate(f, inputs[i]);
+			}
+			return Lut(inputs, values);
+		}
+
+		bool isUniform() const { return p_inputs.empty(); }
+		std::size_t size() const { return p_values.size(); }
+		In min() const { return In(p_min); }
+		In max() const { return In(p_max); }
+
+		Out operator()(In const& x) const
+		{
+			return isUniform() ? Out(uniformKernel()(x.val)) : Out(nonUniformKernel<false>()(x.val));
+		}
+
+		/**
+		 * Evaluates the table at every input in `in`, writing to out, which
+		 * must be at least as long
+		 */
+		void operator()(Span<In const> in, Span<Out> out) const
+		{
+			if(isUniform())
+			{
+				Apply(uniformKernel(), in, out);
+			}
+			else if(p_span <= 2)
+			{
+				Apply(nonUniformKernel<true>(), in, out);
+			}
+			else
+			{
+				Apply(nonUniformKernel<false>(), in, out);
+			}
+		}
+
+	private:
+		template<typename Quantity>
+		static std::vector<typename Quantity::BaseType> ToBase(Span<Quantity const> values)
+		{
+			std::vector<typename Quantity::BaseType> ret(values.size());
+			for(std::size_t i = 0; i < values.size(); i++)
+			{
+				ret[i] = values[i].val;
+			}
+			return ret;
+		}
+
+		template<typename F>
+		static Out Evaluate(F const& f, In const& x)
+		{
+			auto const y = f(x);
+			static_assert(_internal::HasBaseType<decltype(y)>::value,
+				"Lut::sample needs a function returning a Mesi type");
+			return Out(y);
+		}
+
+		/**
+		 * Estimates slopes for cubic interpolation using three neighbouring
+		 * entries, one-sided at the ends, which are exact for quadratics
+		 */
+		void initSlopes()
+		{
+			if(t_interpolation != LutInterpolation::Cubic)
+			{
+				return;
+			}
+			std::size_t const n = p_values.size();
+			std::vector<OutBase> const& v = p_values;
+			p_slopes.resize(n);
+			if(n == 2)
+			{
+				p_slopes[0] = p_slopes[1] = (v[1] - v[0]) / OutBase(width(0));
+				return;
+			}
+			for(std::size_t i = 1; i + 1 < n; i++)
+			{
+				OutBase const h0 = OutBase(width(i - 1));
+				OutBase const h1 = OutBase(width(i));
+				OutBase const d0 = (v[i] - v[i - 1]) / h0;
+				OutBase const d1 = (v[i + 1] - v[i]) / h1;
+				p_slopes[i] = (h0 * d1 + h1 * d0) / (h0 + h1);
+			}
+			{
+				OutBase const h0 = OutBase(width(0));
+				OutBase const h1 = OutBase(width(1));
+				p_slopes[0] = -(2 * h0 + h1) / (h0 * (h0 + h1)) * v[0]
+					+ (h0 + h1) / (h0 * h1) * v[1]
+					- h0 / (h1 * (h0 + h1)) * v[2];
+			}
+			{
+				OutBase const h0 = OutBase(width(n - 3));
+				OutBase const h1 = OutBase(width(n - 2));
+				p_slopes[n - 1] = h1 / (h0 * (h0 + h1)) * v[n - 3]
+					- (h0 + h1) / (h0 * h1) * v[n - 2]
+					+ (h0 + 2 * h1) / (h1 * (h0 + h1)) * v[n - 1];
+			}
+		}
+
+		/**
+		 * The input distance between entries i and i + 1
+		 */
+		InBase width(std::size_t i) const
+		{
+			return isUniform() ? p_step : p_inputs[i + 1] - p_inputs[i];
+		}
+
+		/*
+		 * The evaluation is done by small structs holding copies of the
+		 * table's pointers and constants, so the compiler can see that
+		 * writing the outputs doesn't change them, and keep them in
+		 * registers
+		 */
+
+		/**
+		 * Interpolates between entries
+		 */
+		struct Interpolator
+		{
+			OutBase const* values;
+			OutBase const* slopes;
+
+			/**
+			 * The value at fraction t of the way from entry i to entry
+			 * i + 1, which are h apart. Gathers need 32-bit indices to
+			 * vectorise, so the index type is left open.
+			 */
+			template<typename Index>
+			OutBase operator()(Index i, OutBase t, OutBase h) const
+			{
+				OutBase const* v = values;
+				if(t_interpolation == LutInterpolation::Linear)
+				{
+					return v[i] + t * (v[i + 1] - v[i]);
+				}
+				OutBase const* m = slopes;
+				OutBase const t2 = t * t;
+				OutBase const t3 = t2 * t;
+				return (2 * t3 - 3 * t2 + 1) * v[i]
+					+ (t3 - 2 * t2 + t) * h * m[i]
+					+ (3 * t2 - 2 * t3) * v[i + 1]
+					+ (t3 - t2) * h * m[i + 1];
+			}
+		};
+
+		/**
+		 * Evenly spaced entries. Written with ternaries and 32-bit indices
+		 * rather than branches and std::min, so loops over it vectorise.
+		 */
+		struct UniformKernel
+		{
+			Interpolator interpolate;
+			InBase min;
+			InBase inv_step;
+			InBase step;
+			InBase last;
+			int32_t last_segment;
+
+			OutBase operator()(InBase x) const
+			{
+				InBase u = (x - min) * inv_step;
+				u = u > InBase(0) ? u : InBase(0);
+				u = u < last ? u : last;
+				int32_t i = int32_t(u);
+				i = i < last_segment ? i : last_segment;
+				return interpolate(i, OutBase(u - InBase(i)), OutBase(step));
+			}
+		};
+
+		/**
+		 * The bucket of the index of uneven entries that holds x
+		 */
+		static int32_t Bucket(InBase x, InBase min, InBase inv_width, int32_t last)
+		{
+			InBase const u = (x - min) * inv_width;
+			int32_t const b = int32_t(u > InBase(0) ? u : InBase(0));
+			return b < last ? b : last;
+		}
+
+		/**
+		 * Entries at any increasing inputs. x is first placed in one of
+		 * the evenly spaced buckets of p_hints, which gives the few entries
+		 * it can be between, then a branch-free binary search finds the
+		 * last entry at or below x. The search covers as many entries as
+		 * the fullest bucket, so its length doesn't depend on x.
+		 *
+		 * When no bucket holds more than one entry, which initHints() aims
+		 * for, the search is a single comparison and t_single is true: the
+		 * loop then has no inner loop, and vectorises like the uniform one.
+		 */
+		template<bool t_single>
+		struct NonUniformKernel
+		{
+			Interpolator interpolate;
+			InBase const* inputs;
+			int32_t const* hints;
+			InBase min;
+			InBase max;
+			InBase inv_bucket;
+			int32_t last_bucket;
+			int32_t last_segment;
+			int32_t span;
+
+			OutBase operator()(InBase x) const
+			{
+				InBase const* k = inputs;
+				x = x > min ? x : min;
+				x = x < max ? x : max;
+				int32_t i = hints[Bucket(x, min, inv_bucket, last_bucket)];
+				if(t_single)
+				{
+					int32_t const j = i < last_segment ? i + 1 : last_segment;
+					i = k[j] <= x ? j : i;
+				}
+				else
+				{
+					int32_t len = span;
+					while(len > 1)
+					{
+						int32_t const half = len / 2;
+						int32_t const j = i + half < last_segment ? i + half : last_segment;
+						i = k[j] <= x ? j : i;
+						len -= half;
+					}
+				}
+				InBase const h = k[i + 1] - k[i];
+				return interpolate(i, OutBase((x - k[i]) / h), OutBase(h));
+			}
+		};
+
+		/**
+		 * Fills p_hints, so that the entry at or below any x in bucket b is
+		 * between p_hints[b] and p_hints[b + 1] inclusive. Uses Bucket(), as
+		 * the kernel does, so rounding can't put x in the wrong bucket.
+		 *
+		 * Buckets no wider than the closest entries would hold at most one
+		 * entry each, but are limited to 16 per entry to bound the memory
+		 * used for very uneven entries.
+		 */
+		void initHints()
+		{
+			std::size_t const segments = p_inputs.size() - 1;
+			InBase narrowest = p_max - p_min;
+			for(std::size_t i = 0; i < segments; i++)
+			{
+				InBase const h = p_inputs[i + 1] - p_inputs[i];
+				narrowest = h < narrowest ? h : narrowest;
+			}
+			InBase const wanted = (p_max - p_min) / narrowest + 1;
+			std::size_t const buckets = wanted < InBase(16 * segments) ? std::size_t(wanted) : 16 * segments;
+			p_step = (p_max - p_min) / InBase(buckets);
+			p_inv_step = InBase(buckets) / (p_max - p_min);
+			p_hints.resize(buckets + 1);
+			p_hints[0] = 0;
+			p_span = 1;
+			std::size_t s = 0;
+			for(std::size_t b = 0; b < buckets; b++)
+			{
+				while(s + 1 < segments && std::size_t(Bucket(p_inputs[s + 1], p_min, p_inv_step, int32_t(buckets - 1))) <= b)
+				{
+					s++;
+				}
+				p_hints[b + 1] = int32_t(s);
+				int32_t const span = int32_t(s) - p_hints[b] + 1;
+				p_span = span > p_span ? span : p_span;
+			}
+		}
+
+		UniformKernel uniformKernel() const
+		{
+			return UniformKernel{
+				Interpolator{p_values.data(), p_slopes.data()},
+				p_min, p_inv_step, p_step,
+				InBase(p_values.size() - 1), int32_t(p_values.size() - 2)
+			};
+		}
+
+		template<bool t_single>
+		NonUniformKernel<t_single> nonUniformKernel() const
+		{
+			return NonUniformKernel<t_single>{
+				Interpolator{p_values.data(), p_slopes.data()},
+				p_inputs.data(), p_hints.data(), p_min, p_max,
+				p_inv_step, int32_t(p_hints.size() - 2),
+				int32_t(p_inputs.size() - 2), p_span
+			};
+		}
+
+		/**
+		 * Evaluates into a block on the stack before copying to out: the
+		 * compiler can't check that gathers from the table don't overlap
+		 * out, but it knows nothing overlaps a local array
+		 */
+		template<typename Kernel>
+		static void Apply(Kernel const kernel, Span<In const> in, Span<Out> out)
+		{
+			constexpr std::size_t c_block = 64;
+			std::size_t const n = in.size() < out.size() ? in.size() : out.size();
+			InBase const* src = view_as<InBase>(in).data();
+			OutBase* dst = view_as<OutBase>(out).data();
+			for(std::size_t start = 0; start < n; start += c_block)
+			{
+				std::size_t const count = n - start < c_block ? n - start : c_block;
+				OutBase block[c_block];
+				MESI_IVDEP
+				for(std::size_t i = 0; i < count; i++)
+				{
+					block[i] = kernel(src[start + i]);
+				}
+				for(std::size_t i = 0; i < count; i++)
+				{
+					dst[start + i] = block[i];
+				}
+			}
+		}
+
+		InBase p_min;
+		InBase p_max;
+		/** The distance between entries, or for uneven entries between buckets */
+		InBase p_step;
+		InBase p_inv_step;
+		/** Empty for evenly spaced entries */
+		std::vector<InBase> p_inputs;
+		/** Empty for evenly spaced entries, see initHints() */
+		std::vector<int32_t> p_hints;
+		/** The most entries a bucket of p_hints can be between */
+		int32_t p_span;
+		std::vector<OutBase> p_values;
+		/** Slopes in Out per In, only used for cubic interpolation */
+		std::vector<OutBase> p_slopes;
+	};
+}
+
+#undef MESI_IVDEP
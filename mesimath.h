@@ -1,16 +1,141 @@
 #pragma once
-#include "mesitype.h"
-namespace std {
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include "mesicore.h"
+
+MESI_EXPORT namespace Mesi {
+	namespace _internal {
+		/**
+		 * Compile time versions of the <cmath> functions below, for the
+		 * built-in arithmetic types. Rounding to an integer assumes the
+		 * default rounding mode, which is what constant evaluation uses.
+		 */
+		struct ConstantMaths
+		{
+			template<typename T>
+			static constexpr T abs(T const x)
+			{
+				// -0 gives +0, like std::abs
+				return x < T(0) ? T(-x) : x == T(0) ? T(0) : x;
+			}
+
+			template<typename T>
+			static constexpr T fmax(T const x, T const y)
+			{
+				return x != x ? y : y != y ? x : x < y ? y : x;
+			}
+
+			template<typename T>
+			static constexpr T fmin(T const x, T const y)
+			{
+				return x != x ? y : y != y ? x : y < x ? y : x;
+			}
+
+			template<typename T>
+			static constexpr T fdim(T const x, T const y)
+			{
+				return x != x || y != y ? T(x + y) : x > y ? T(x - y) : T(0);
+			}
+
+			template<typename T>
+			static constexpr T trunc(T const x)
+			{
+				return isIntegral(x) ? x
+					: T(intmax_t(x)) == T(0) ? T(x * T(0))
+					: T(intmax_t(x));
+			}
+
+			template<typename T>
+			static constexpr T floor(T const x)
+			{
+				return trunc(x) > x ? T(trunc(x) - T(1)) : trunc(x);
+			}
+
+			template<typename T>
+			static constexpr T ceil(T const x)
+			{
+				return trunc(x) < x ? T(trunc(x) + T(1)) : trunc(x);
+			}
+
+			/**
+			 * Halfway cases round away from zero
+			 */
+			template<typename T>
+			static constexpr T round(T const x)
+			{
+				return x - trunc(x) >= T(0.5) ? T(trunc(x) + T(1))
+					: x - trunc(x) <= T(-0.5) ? T(trunc(x) - T(1))
+					: trunc(x);
+			}
+
+			/**
+			 * Halfway cases round to even
+			 */
+			template<typename T>
+			static constexpr T rint(T const x)
+			{
+				return x - trunc(x) > T(0.5) || (x - trunc(x) == T(0.5) && intmax_t(trunc(x)) % 2 != 0) ? T(trunc(x) + T(1))
+					: x - trunc(x) < T(-0.5) || (x - trunc(x) == T(-0.5) && intmax_t(trunc(x)) % 2 != 0) ? T(trunc(x) - T(1))
+					: trunc(x);
+			}
+
+			template<typename T>
+			static constexpr T nearbyint(T const x)
+			{
+				return rint(x);
+			}
+
+		private:
+			/**
+			 * Whether x is an integer already, or infinite or NaN, which are
+			 * their own integer parts. From 2^(digits - 1), every floating
+			 * point value is an integer.
+			 */
+			template<typename T>
+			static constexpr bool isIntegral(T const x)
+			{
+				return std::is_integral<T>::value || !(x - x == T(0))
+					|| abs(x) >= T(uintmax_t(1) << (std::numeric_limits<T>::digits - 1));
+			}
+		};
+	}
+}
+
+MESI_EXPORT namespace std {
 #define MESI_TEMPLATE template<typename T, typename t_m, typename t_s, typename t_kg, typename t_A, typename t_K, typename t_mol, typename t_cd, typename t_scale>
 #define MESI_TEMPLATE_2 template<typename T, typename t_m, typename t_m2, typename t_s, typename t_s2, typename t_kg, typename t_kg2, typename t_A, typename t_A2, typename t_K, typename t_K2, typename t_mol, typename t_mol2, typename t_cd, typename t_cd2, typename t_scale, typename t_scale2>
 #define MESI_TYPE Mesi::RationalTypeReduced<T, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale>
 #define MESI_TYPE_2 Mesi::RationalTypeReduced<T, t_m2, t_s2, t_kg2, t_A2, t_K2, t_mol2, t_cd2, t_scale2>
 #define MESI_SCALAR Mesi::Type<T, 0, 0, 0>
-#define FORWARD_SIMPLE_UNARY(name) MESI_TEMPLATE auto name(MESI_TYPE const &x) { return MESI_TYPE(name(x.val)); }
-#define FORWARD_SIMPLE_BINARY(name) MESI_TEMPLATE auto name(MESI_TYPE const &x, MESI_TYPE const &y) { return MESI_TYPE(name(x.val, y.val)); }
+/*
+ * Built-in storage types use Mesi::_internal::ConstantMaths during constant
+ * evaluation, so these are constexpr; other storage types call their own
+ * overloads
+ */
+#define MESI_IF_ARITHMETIC(result) typename enable_if<is_arithmetic<T>::value, result>::type
+#define MESI_UNLESS_ARITHMETIC(result) typename enable_if<!is_arithmetic<T>::value, result>::type
+#define FORWARD_SIMPLE_UNARY(name) \
+	MESI_TEMPLATE constexpr MESI_IF_ARITHMETIC(MESI_TYPE) name(MESI_TYPE const &x) { \
+		return MESI_TYPE(Mesi::_internal::IsConstantEvaluated() ? Mesi::_internal::ConstantMaths::name(x.val) : name(x.val)); } \
+	MESI_TEMPLATE MESI_UNLESS_ARITHMETIC(MESI_TYPE) name(MESI_TYPE const &x) { return MESI_TYPE(name(x.val)); }
+#define FORWARD_SIMPLE_BINARY(name) \
+	MESI_TEMPLATE constexpr MESI_IF_ARITHMETIC(MESI_TYPE) name(MESI_TYPE const &x, MESI_TYPE const &y) { \
+		return MESI_TYPE(Mesi::_internal::IsConstantEvaluated() ? Mesi::_internal::ConstantMaths::name(x.val, y.val) : name(x.val, y.val)); } \
+	MESI_TEMPLATE MESI_UNLESS_ARITHMETIC(MESI_TYPE) name(MESI_TYPE const &x, MESI_TYPE const &y) { return MESI_TYPE(name(x.val, y.val)); }
 #define FORWARD_SCALAR(name) template<typename T> auto name(MESI_SCALAR const &x) { return MESI_SCALAR(name(x.val)); }
 
-FORWARD_SIMPLE_UNARY(abs)
+/*
+ * The magnitude of a complex (or other) storage type can be a different type,
+ * e.g. the abs of complex Volts is real Volts
+ */
+MESI_TEMPLATE constexpr MESI_IF_ARITHMETIC(MESI_TYPE) abs(MESI_TYPE const &x) {
+	return MESI_TYPE(Mesi::_internal::IsConstantEvaluated() ? Mesi::_internal::ConstantMaths::abs(x.val) : abs(x.val));
+}
+MESI_TEMPLATE auto abs(MESI_TYPE const &x)
+	-> typename enable_if<!is_arithmetic<T>::value, Mesi::RationalTypeReduced<decltype(abs(x.val)), t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale>>::type {
+	return Mesi::RationalTypeReduced<decltype(abs(x.val)), t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale>(abs(x.val));
+}
 FORWARD_SIMPLE_BINARY(fmax)
 FORWARD_SIMPLE_BINARY(fmin)
 FORWARD_SIMPLE_BINARY(fdim)
@@ -55,17 +180,17 @@ MESI_SCALAR atan2(MESI_SCALAR const &x, MESI_SCALAR const &y) {
 }
 
 MESI_TEMPLATE
-auto sqrt(MESI_TYPE const &x) {
+constexpr auto sqrt(MESI_TYPE const &x) {
 	return Mesi::pow<std::ratio<1,2>>(x);
 }
 
 MESI_TEMPLATE
-auto cbrt(MESI_TYPE const &x) {
+constexpr auto cbrt(MESI_TYPE const &x) {
 	return Mesi::pow<std::ratio<1,3>>(x);
 }
 
 MESI_TEMPLATE
-auto hypot(MESI_TYPE const &x, MESI_TYPE const &y) {
+constexpr auto hypot(MESI_TYPE const &x, MESI_TYPE const &y) {
 	return sqrt(x*x+y*y);
 }
 
@@ -74,6 +199,8 @@ auto hypot(MESI_TYPE const &x, MESI_TYPE const &y) {
 #undef MESI_TYPE
 #undef MESI_TYPE_2
 #undef MESI_SCALAR
+#undef MESI_IF_ARITHMETIC
+#undef MESI_UNLESS_ARITHMETIC
 #undef FORWARD_SIMPLE_UNARY
 #undef FORWARD_SIMPLE_BINARY
 #undef FORWARD_SCALAR
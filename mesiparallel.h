@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/*
+ * Splitting work across threads, shared by the headers with threaded bulk
+ * operations. Those operations take a `threads` argument: 0 chooses
+ * automatically and 1 disables threading. Needs -pthread.
+ */
+namespace Mesi {
+	namespace _internal {
+		/**
+		 * Fewer items than this per thread aren't worth starting a thread for
+		 */
+		constexpr std::size_t c_items_per_thread = std::size_t(1) << 17;
+
+		inline unsigned ThreadsFor(std::size_t items, unsigned requested)
+		{
+			std::size_t useful = items / c_items_per_thread;
+			useful = useful > 0 ? useful : 1;
+			unsigned threads = requested;
+			if(threads == 0)
+			{
+				unsigned const hardware = std::thread::hardware_concurrency();
+				threads = hardware > 0 ? hardware : 1;
+				threads = useful < threads ? unsigned(useful) : threads;
+			}
+			threads = items < threads ? unsigned(items > 0 ? items : 1) : threads;
+			return threads;
+		}
+
+		/**
+		 * Calls body(chunk, begin, end) for `threads` even chunks of
+		 * [0, items), each on its own thread, the first on this one
+		 */
+		template<typename F>
+		void ParallelChunks(std::size_t items, unsigned threads, F const& body)
+		{
+			auto const bounds = [=](unsigned chunk) {
+				return items * chunk / threads;
+			};
+			if(threads <= 1)
+			{
+				body(0u, std::size_t(0), items);
+				return;
+			}
+			std::vector<std::thread> workers;
+			workers.reserve(threads - 1);
+			for(unsigned chunk = 1; chunk < threads; chunk++)
+			{
+				workers.emplace_back([&, chunk] {
+					body(chunk, bounds(chunk), bounds(chunk + 1));
+				});
+			}
+			body(0u, bounds(0), bounds(1));
+			for(auto& w : workers)
+			{
+				w.join();
+			}
+		}
+	}
+}
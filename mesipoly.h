@@ -0,0 +1,247 @@
+#pragma once
+#include <cstddef>
+#include <ratio>
+#include <type_traits>
+#include <utility>
+#include "mesicore.h"
+#include "mesispan.h"
+
+namespace Mesi {
+	namespace _internal {
+		/**
+		 * The type of the coefficient of x^t_power in a polynomial from In to
+		 * Out: Out / In^t_power, so that its term has the units of Out
+		 */
+		template<typename In, typename Out, std::size_t t_power>
+		using PolynomialCoefficient = decltype(
+			std::declval<Out>() / std::declval<typename In::template Pow<std::ratio<t_power>>>());
+
+		/**
+		 * c[t_index] + x * (c[t_index + 1] + x * (... + x * c[t_last])),
+		 * unrolled at compile time
+		 */
+		template<std::size_t t_index, std::size_t t_last>
+		struct Horner
+		{
+			template<typename T>
+			static constexpr T apply(T const* c, T const x)
+			{
+				return c[t_index] + x * Horner<t_index + 1, t_last>::apply(c, x);
+			}
+		};
+
+		template<std::size_t t_last>
+		struct Horner<t_last, t_last>
+		{
+			template<typename T>
+			static constexpr T apply(T const* c, T const)
+			{
+				return c[t_last];
+			}
+		};
+
+		constexpr std::size_t Log2(std::size_t n)
+		{
+			return n <= 1 ? 0 : 1 + Log2(n / 2);
+		}
+
+		/**
+		 * The t_count terms from t_first, split into a lower part with a
+		 * power of two terms and the rest, which is multiplied by x to that
+		 * power. Both parts can be evaluated at the same time, so the
+		 * longest chain of dependent operations is logarithmic in the
+		 * degree rather than linear. powers[j] holds x^(2^j).
+		 */
+		template<std::size_t t_first, std::size_t t_count>
+		struct Estrin
+		{
+			static constexpr std::size_t c_log_split = Log2(t_count - 1);
+			static constexpr std::size_t c_split = std::size_t(1) << c_log_split;
+
+			template<typename T>
+			static constexpr T apply(T const* c, T const* powers)
+			{
+				return Estrin<t_first, c_split>::apply(c, powers)
+					+ powers[c_log_split] * Estrin<t_first + c_split, t_count - c_split>::apply(c, powers);
+			}
+		};
+
+		template<std::size_t t_first>
+		struct Estrin<t_first, 1>
+		{
+			template<typename T>
+			static constexpr T apply(T const* c, T const*)
+			{
+				return c[t_first];
+			}
+		};
+
+		template<typename In, typename Out, typename Indices>
+		class PolynomialStorage;
+
+		/**
+		 * Holds the coefficients, with a constructor taking exactly the
+		 * coefficient types in order
+		 */
+		template<typename In, typename Out, std::size_t... t_powers>
+		class PolynomialStorage<In, Out, std::index_sequence<t_powers...>>
+		{
+		public:
+			using BaseType = decltype(std::declval<typename Out::BaseType>() * std::declval<typename In::BaseType>());
+
+			PolynomialStorage() = default;
+
+			constexpr PolynomialStorage(PolynomialCoefficient<In, Out, t_powers> const&... coefficients)
+				:p_coefficients{BaseType(coefficients.val)...}
+			{}
+
+		protected:
+			BaseType p_coefficients[sizeof...(t_powers)];
+		};
+	}
+
+	/**
+	 * @brief Polynomial from In to Out, with dimensioned coefficients
+	 *
+	 * @param In the Mesi type of the variable, e.g. Kelvin
+	 * @param Out the Mesi type of the result, e.g. Ohms
+	 * @param t_degree the highest power of the variable
+	 *
+	 * The coefficient of x^k has the type Out / In^k (see Coefficient<k>),
+	 * so every term has the units of Out, and the constructor only accepts
+	 * coefficients of those types, lowest power first. E.g. a platinum
+	 * resistance thermometer:
+	 *
+	 *     using Rtd = Polynomial<Celsius, Ohms, 2>;
+	 *     constexpr Rtd pt100(Ohms(100), Rtd::Coefficient<1>(0.39083), Rtd::Coefficient<2>(-5.775e-5));
+	 *
+	 * make_polynomial<In>() deduces Out and the degree from the
+	 * coefficients instead.
+	 *
+	 * Evaluation is fully unrolled and constexpr. operator() uses Horner's
+	 * method, which needs the fewest operations, so gives the best
+	 * throughput, and is what the span overload uses; its loop vectorises.
+	 * estrin() reorders the evaluation so that more of it can run in
+	 * parallel, which lowers the latency of a single evaluation of a high
+	 * degree polynomial.
+	 */
+	template<typename In, typename Out, std::size_t t_degree>
+	class Polynomial : public _internal::PolynomialStorage<In, Out, std::make_index_sequence<t_degree + 1>>
+	{
+		using Storage = _internal::PolynomialStorage<In, Out, std::make_index_sequence<t_degree + 1>>;
+
+	public:
+		using InputType = In;
+		using OutputType = Out;
+		using typename Storage::BaseType;
+
+		template<std::size_t t_power>
+		using Coefficient = _internal::PolynomialCoefficient<In, Out, t_power>;
+
+		static constexpr std::size_t c_degree = t_degree;
+
+		using Storage::Storage;
+
+		template<std::size_t t_power>
+		constexpr Coefficient<t_power> coefficient() const
+		{
+			static_assert(t_power <= t_degree, "The polynomial has no coefficient of that power");
+			return Coefficient<t_power>(typename Coefficient<t_power>::BaseType(this->p_coefficients[t_power]));
+		}
+
+		constexpr Out operator()(In const& x) const
+		{
+			return Out(typename Out::BaseType(evaluateHorner(BaseType(x.val))));
+		}
+
+		constexpr Out estrin(In const& x) const
+		{
+			return Out(typename Out::BaseType(evaluateEstrin(Powers(BaseType(x.val)))));
+		}
+
+		/**
+		 * Evaluates the polynomial at every input in `in`, writing to out,
+		 * which must be at least as long
+		 */
+		void operator()(Span<In const> in, Span<Out> out) const
+		{
+			std::size_t const n = in.size() < out.size() ? in.size() : out.size();
+			typename In::BaseType const* src = view_as<typename In::BaseType>(in).data();
+			typename Out::BaseType* dst = view_as<typename Out::BaseType>(out).data();
+			// A copy the compiler can see isn't changed by writing to out
+			Polynomial const local = *this;
+			for(std::size_t i = 0; i < n; i++)
+			{
+				dst[i] = typename Out::BaseType(local.evaluateHorner(BaseType(src[i])));
+			}
+		}
+
+	private:
+		constexpr BaseType evaluateHorner(BaseType const x) const
+		{
+			return _internal::Horner<0, t_degree>::apply(this->p_coefficients, x);
+		}
+
+		struct Powers
+		{
+			BaseType p[_internal::Log2(t_degree) + 1];
+
+			/**
+			 * x, x^2, x^4, ... as far as the evaluation needs
+			 */
+			constexpr Powers(BaseType const x)
+				:p{}
+			{
+				p[0] = x;
+				for(std::size_t j = 1; j < sizeof(p) / sizeof(p[0]); j++)
+				{
+					p[j] = p[j - 1] * p[j - 1];
+				}
+			}
+		};
+
+		constexpr BaseType evaluateEstrin(Powers const& powers) const
+		{
+			return _internal::Estrin<0, t_degree + 1>::apply(this->p_coefficients, powers.p);
+		}
+	};
+
+	namespace _internal {
+		template<bool... t_values>
+		struct AllOf : std::is_same<AllOf<t_values...>, AllOf<(t_values || true)...>> {};
+
+		template<typename In, typename Out, typename Indices, typename... Coefficients>
+		struct PolynomialFromCoefficients;
+
+		template<typename In, typename Out, std::size_t... t_powers, typename... Coefficients>
+		struct PolynomialFromCoefficients<In, Out, std::index_sequence<t_powers...>, Coefficients...>
+		{
+			using Type = Polynomial<In, Out, sizeof...(t_powers) - 1>;
+
+			static constexpr bool c_valid = AllOf<std::is_constructible<
+				PolynomialCoefficient<In, Out, t_powers>, Coefficients>::value...>::value;
+
+			static constexpr Type make(Coefficients const&... coefficients)
+			{
+				return Type(PolynomialCoefficient<In, Out, t_powers>(coefficients)...);
+			}
+		};
+	}
+
+	/**
+	 * Makes a polynomial in In from its coefficients, lowest power first.
+	 * The result has the type of the first coefficient, and each later
+	 * coefficient must have its units divided by In to the power, in any
+	 * scale: coefficients are converted to the scale of the result.
+	 */
+	template<typename In, typename Constant, typename... Coefficients>
+	constexpr Polynomial<In, Constant, sizeof...(Coefficients)> make_polynomial(
+		Constant const& constant, Coefficients const&... coefficients)
+	{
+		using Maker = _internal::PolynomialFromCoefficients<In, Constant,
+			std::make_index_sequence<sizeof...(Coefficients) + 1>, Constant, Coefficients...>;
+		static_assert(Maker::c_valid,
+			"The coefficient of x^k must have the units of the constant term divided by In^k");
+		return Maker::make(constant, coefficients...);
+	}
+}
@@ -0,0 +1,197 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <ratio>
+#include <type_traits>
+#include "mesicore.h"
+#include "mesispan.h"
+
+namespace Mesi {
+	/**
+	 * @brief Compact storage for a quantity with a known range
+	 *
+	 * @param Quantity the Mesi type that is stored
+	 * @param IntT the integer type used for storage, e.g. uint8_t
+	 * @param t_min the smallest representable value, as a std::ratio in
+	 *        units of Quantity
+	 * @param t_max the largest representable value, as a std::ratio in units
+	 *        of Quantity
+	 *
+	 * Values are mapped affinely onto the full range of IntT, so e.g.
+	 * Quantized<Volts, uint8_t, std::ratio<0>, std::ratio<5>> stores 0-5 V in
+	 * a byte with a resolution of 5/255 V. Values outside the range are
+	 * clamped, and encoding rounds to the nearest representable value.
+	 *
+	 * Arithmetic and mixed operations decode on use and return Quantity, so
+	 * a Quantized can be used wherever Quantity can; comparisons between two
+	 * values of the same Quantized type compare the codes directly.
+	 */
+	template<typename Quantity, typename IntT, typename t_min, typename t_max>
+	struct Quantized
+	{
+		static_assert(std::is_integral<IntT>::value, "Quantized values must be stored in an integer type");
+		static_assert(std::ratio_less<t_min, t_max>::value, "The range of a Quantized value must not be empty");
+
+		using QuantityType = Quantity;
+		using StorageType = IntT;
+		using BaseType = typename Quantity::BaseType;
+
+		IntT code;
+
+		Quantized() = default;
+
+		explicit Quantized(Quantity const& value)
+			:code(encode(value))
+		{}
+
+		static constexpr Quantized fromCode(IntT c)
+		{
+			Quantized ret{};
+			ret.code = c;
+			return ret;
+		}
+
+		static constexpr Quantity min() { return Quantity(BaseType(t_min::num) / BaseType(t_min::den)); }
+		static constexpr Quantity max() { return Quantity(BaseType(t_max::num) / BaseType(t_max::den)); }
+
+		/**
+		 * The difference between consecutive representable values
+		 */
+		static constexpr Quantity step() { return Quantity(BaseType(realStep())); }
+
+		static IntT encode(Quantity const& value)
+		{
+			Real t = (Real(value.val) - Real(min().val)) * (levels() / (Real(max().val) - Real(min().val)));
+			t = t > Real(0) ? t : Real(0);
+			// The top code is set as an integer, since levels() may have been
+			// rounded up past it
+			Offset const c = t < levels() ? Offset(t + Real(0.5)) : c_levels;
+			return IntT(Offset(std::numeric_limits<IntT>::min()) + (c < c_levels ? c : c_levels));
+		}
+
+		constexpr Quantity decode() const
+		{
+			return Quantity(BaseType(Real(min().val) + Real(Offset(code) - Offset(std::numeric_limits<IntT>::min())) * realStep()));
+		}
+
+		explicit constexpr operator Quantity() const
+		{
+			return decode();
+		}
+
+		/**
+		 * Encodes values into out, which must be at least as long as in. The
+		 * loop is kept simple so compilers can vectorise it.
+		 */
+		static void encode(Span<Quantity const> in, Span<Quantized> out)
+		{
+			std::size_t const n = in.size() < out.size() ? in.size() : out.size();
+			Quantity const* src = in.data();
+			Quantized* dst = out.data();
+			for(std::size_t i = 0; i < n; i++)
+			{
+				dst[i].code = encode(src[i]);
+			}
+		}
+
+		/**
+		 * Decodes values into out, which must be at least as long as in
+		 */
+		static void decode(Span<Quantized const> in, Span<Quantity> out)
+		{
+			std::size_t const n = in.size() < out.size() ? in.size() : out.size();
+			Quantized const* src = in.data();
+			Quantity* dst = out.data();
+			for(std::size_t i = 0; i < n; i++)
+			{
+				dst[i] = src[i].decode();
+			}
+		}
+
+	private:
+		/**
+		 * Integer type for code arithmetic: 32 bits when they suffice, as
+		 * conversions between 32-bit integers and floats vectorise well, and
+		 * otherwise unsigned, so that offsets of 64-bit codes wrap rather
+		 * than overflow
+		 */
+		using Offset = typename std::conditional<(sizeof(IntT) < 4), int32_t, uintmax_t>::type;
+
+		/**
+		 * Floating-point type for encoding and decoding: BaseType when it
+		 * holds every code exactly, otherwise a wider type, so e.g. 32-bit
+		 * codes of float Volts don't round to their neighbours
+		 */
+		template<typename T>
+		using Holds = std::integral_constant<bool, (std::numeric_limits<IntT>::digits <= std::numeric_limits<T>::digits)>;
+		using Real = typename std::conditional<!std::is_floating_point<BaseType>::value || Holds<BaseType>::value, BaseType,
+			typename std::conditional<Holds<double>::value, double, long double>::type>::type;
+
+		static constexpr Offset c_levels = Offset(uintmax_t(std::numeric_limits<IntT>::max()) - uintmax_t(std::numeric_limits<IntT>::min()));
+
+		static constexpr Real levels()
+		{
+			return Real(c_levels);
+		}
+
+		static constexpr Real realStep()
+		{
+			return (Real(max().val) - Real(min().val)) / levels();
+		}
+	};
+
+	template<typename Quantity, typename IntT, typename t_min, typename t_max>
+	constexpr typename Quantized<Quantity, IntT, t_min, t_max>::Offset Quantized<Quantity, IntT, t_min, t_max>::c_levels;
+
+#define QUANTIZED_FULL_PARAMS typename Q, typename I, typename t_min, typename t_max
+#define QUANTIZED_TYPE Quantized<Q, I, t_min, t_max>
+#define QUANTIZED_B_FULL_PARAMS typename Q2, typename I2, typename t_min2, typename t_max2
+#define QUANTIZED_B_TYPE Quantized<Q2, I2, t_min2, t_max2>
+#define MESI_FULL_PARAMS typename T, typename t_m, typename t_s, typename t_kg, typename t_A, typename t_K, typename t_mol, typename t_cd, typename t_scale
+#define MESI_TYPE RationalTypeReduced<T, t_m, t_s, t_kg, t_A, t_K, t_mol, t_cd, t_scale>
+#define ARITHMETIC(S) typename S, typename = typename std::enable_if<std::is_arithmetic<S>::value>::type
+
+	/*
+	 * Arithmetic decodes lazily and forwards to the operators of Quantity
+	 */
+#define QUANTIZED_OPERATOR(op) \
+	template<QUANTIZED_FULL_PARAMS, QUANTIZED_B_FULL_PARAMS> \
+	constexpr auto operator op(QUANTIZED_TYPE const& left, QUANTIZED_B_TYPE const& right) { return left.decode() op right.decode(); } \
+	template<QUANTIZED_FULL_PARAMS, MESI_FULL_PARAMS> \
+	constexpr auto operator op(QUANTIZED_TYPE const& left, MESI_TYPE const& right) { return left.decode() op right; } \
+	template<QUANTIZED_FULL_PARAMS, MESI_FULL_PARAMS> \
+	constexpr auto operator op(MESI_TYPE const& left, QUANTIZED_TYPE const& right) { return left op right.decode(); } \
+	template<QUANTIZED_FULL_PARAMS, ARITHMETIC(S)> \
+	constexpr auto operator op(QUANTIZED_TYPE const& left, S const& right) { return left.decode() op right; } \
+	template<QUANTIZED_FULL_PARAMS, ARITHMETIC(S)> \
+	constexpr auto operator op(S const& left, QUANTIZED_TYPE const& right) { return left op right.decode(); }
+
+	QUANTIZED_OPERATOR(+)
+	QUANTIZED_OPERATOR(-)
+	QUANTIZED_OPERATOR(*)
+	QUANTIZED_OPERATOR(/)
+#undef QUANTIZED_OPERATOR
+
+	/*
+	 * The encoding is monotonic, so values of the same type compare by code
+	 */
+#define QUANTIZED_COMPARISON(op) \
+	template<QUANTIZED_FULL_PARAMS> \
+	constexpr bool operator op(QUANTIZED_TYPE const& left, QUANTIZED_TYPE const& right) { return left.code op right.code; }
+
+	QUANTIZED_COMPARISON(==)
+	QUANTIZED_COMPARISON(!=)
+	QUANTIZED_COMPARISON(<)
+	QUANTIZED_COMPARISON(<=)
+	QUANTIZED_COMPARISON(>)
+	QUANTIZED_COMPARISON(>=)
+#undef QUANTIZED_COMPARISON
+
+#undef ARITHMETIC
+#undef MESI_TYPE
+#undef MESI_FULL_PARAMS
+#undef QUANTIZED_B_TYPE
+#undef QUANTIZED_B_FULL_PARAMS
+#undef QUANTIZED_TYPE
+#undef QUANTIZED_FULL_PARAMS
+}
@@ -0,0 +1,330 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include "mesicore.h"
+#include "mesispan.h"
+
+/*
+ * Bounded lock-free queues of quantities between threads, e.g. samples
+ * from a sensor thread to a processing thread:
+ *
+ *     Mesi::SpscQueue<Volts> samples(4096);
+ *     samples.push(reading);                 // sensor thread
+ *     std::size_t n = samples.pop(block);    // processing thread, into a span
+ *
+ * Neither queue blocks: push() fails when the queue is full and pop() when
+ * it's empty, so callers choose whether to spin, yield or drop samples.
+ * The batch overloads move as many values as fit in one step, so a
+ * consumer can pop straight into the span a bulk kernel reads.
+ *
+ * The producer and consumer positions are kept on separate cache lines.
+ * As with ShardedCounter, C++14 doesn't guarantee the alignment of
+ * over-aligned types allocated with new, which only affects speed.
+ */
+namespace Mesi {
+	namespace _internal {
+		constexpr std::size_t c_queue_line = 64;
+
+		/**
+		 * The smallest power of two of at least n, and at least 2
+		 */
+		inline std::size_t QueueCapacity(std::size_t const n)
+		{
+			std::size_t capacity = 2;
+			while(capacity < n)
+			{
+				capacity *= 2;
+			}
+			return capacity;
+		}
+
+		template<typename Quantity>
+		void CheckQueued()
+		{
+			static_assert(std::is_trivially_copyable<Quantity>::value,
+				"Queued quantities must have a trivially copyable storage type");
+		}
+	}
+
+	/**
+	 * @brief Bounded queue for one producer thread and one consumer thread
+	 *
+	 * @param Quantity the Mesi type that is queued
+	 *
+	 * A ring buffer whose positions only ever increase. Each side keeps a
+	 * copy of the other's position and only reloads it when the copy says
+	 * the queue is full or empty, so in the steady state the two threads
+	 * don't touch each other's cache lines between batches.
+	 *
+	 * At most one thread may push and one pop at a time.
+	 */
+	template<typename Quantity>
+	class SpscQueue
+	{
+	public:
+		using ValueType = Quantity;
+
+		/**
+		 * A queue holding at least `capacity` values, rounded up to a power
+		 * of two
+		 */
+		explicit SpscQueue(std::size_t const capacity)
+			:p_values(_internal::QueueCapacity(capacity)), p_mask(p_values.size() - 1)
+		{
+			_internal::CheckQueued<Quantity>();
+		}
+
+		SpscQueue(SpscQueue const&) = delete;
+		SpscQueue& operator=(SpscQueue const&) = delete;
+
+		std::size_t capacity() const { return p_values.size(); }
+
+		/**
+		 * The number of values queued. Only exact when neither side is
+		 * active.
+		 */
+		std::size_t size() const
+		{
+			// The head is read first: the tail only grows and never passes
+			// the head, so a tail read later can't be behind it
+			std::size_t const head = p_consumer.position.load(std::memory_order_acquire);
+			return p_producer.position.load(std::memory_order_acquire) - head;
+		}
+
+		bool empty() const { return size() == 0; }
+
+		/**
+		 * Queues value, or returns false if the queue is full
+		 */
+		bool push(Quantity const& value)
+		{
+			std::size_t const tail = p_producer.position.load(std::memory_order_relaxed);
+			if(tail - p_producer.other == capacity())
+			{
+				p_producer.other = p_consumer.position.load(std::memory_order_acquire);
+				if(tail - p_producer.other == capacity())
+				{
+					return false;
+				}
+			}
+			p_values[tail & p_mask] = value;
+			p_producer.position.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * Queues as many of `values` as fit, in order, returning how many
+		 */
+		std::size_t push(Span<Quantity const> values)
+		{
+			std::size_t const tail = p_producer.position.load(std::memory_order_relaxed);
+			if(capacity() - (tail - p_producer.other) < values.size())
+			{
+				p_producer.other = p_consumer.position.load(std::memory_order_acquire);
+			}
+			std::size_t const space = capacity() - (tail - p_producer.other);
+			std::size_t const count = values.size() < space ? values.size() : space;
+			for(std::size_t i = 0; i < count; i++)
+			{
+				p_values[(tail + i) & p_mask] = values[i];
+			}
+			p_producer.position.store(tail + count, std::memory_order_release);
+			return count;
+		}
+
+		/**
+		 * Takes the oldest value into value, or returns false if the queue is
+		 * empty
+		 */
+		bool pop(Quantity& value)
+		{
+			std::size_t const head = p_consumer.position.load(std::memory_order_relaxed);
+			if(head == p_consumer.other)
+			{
+				p_consumer.other = p_producer.position.load(std::memory_order_acquire);
+				if(head == p_consumer.other)
+				{
+					return false;
+				}
+			}
+			value = p_values[head & p_mask];
+			p_consumer.position.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * Takes up to out.size() of the oldest values into out, returning
+		 * how many
+		 */
+		std::size_t pop(Span<Quantity> out)
+		{
+			std::size_t const head = p_consumer.position.load(std::memory_order_relaxed);
+			if(p_consumer.other - head < out.size())
+			{
+				p_consumer.other = p_producer.position.load(std::memory_order_acquire);
+			}
+			std::size_t const available = p_consumer.other - head;
+			std::size_t const count = out.size() < available ? out.size() : available;
+			for(std::size_t i = 0; i < count; i++)
+			{
+				out[i] = p_values[(head + i) & p_mask];
+			}
+			p_consumer.position.store(head + count, std::memory_order_release);
+			return count;
+		}
+
+	private:
+		/**
+		 * One side's position, and its last look at the other side's
+		 */
+		struct alignas(_internal::c_queue_line) Side
+		{
+			std::atomic<std::size_t> position{0};
+			std::size_t other = 0;
+		};
+
+		std::vector<Quantity> p_values;
+		std::size_t p_mask;
+		Side p_producer;
+		Side p_consumer;
+	};
+
+	/**
+	 * @brief Bounded queue for any number of producer threads and one
+	 * consumer thread
+	 *
+	 * @param Quantity the Mesi type that is queued
+	 *
+	 * Based on Dmitry Vyukov's bounded queue. Producers claim slots by
+	 * advancing a shared position with compare-and-swap, as many as fit at
+	 * once, then mark each slot with its position when it's written. The
+	 * consumer takes slots in order only once they're marked, so a producer
+	 * that is slow to write holds up later values but never exposes a
+	 * half-written one.
+	 *
+	 * Values pushed by one producer are popped in the order it pushed them.
+	 * At most one thread may pop at a time.
+	 */
+	template<typename Quantity>
+	class MpscQueue
+	{
+	public:
+		using ValueType = Quantity;
+
+		/**
+		 * A queue holding at least `capacity` values, rounded up to a power
+		 * of two
+		 */
+		explicit MpscQueue(std::size_t const capacity)
+			:p_slots(_internal::QueueCapacity(capacity)), p_mask(p_slots.size() - 1)
+		{
+			_internal::CheckQueued<Quantity>();
+			// A slot is full when marked with one past its position, which
+			// none is yet
+			for(std::size_t i = 0; i < p_slots.size(); i++)
+			{
+				p_slots[i].written.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		MpscQueue(MpscQueue const&) = delete;
+		MpscQueue& operator=(MpscQueue const&) = delete;
+
+		std::size_t capacity() const { return p_slots.size(); }
+
+		/**
+		 * The number of slots claimed by producers and not yet popped,
+		 * including any still being written. Only exact when no thread is
+		 * active.
+		 */
+		std::size_t size() const
+		{
+			// The head first, as in SpscQueue::size()
+			std::size_t const head = p_head.load(std::memory_order_acquire);
+			return p_tail.load(std::memory_order_acquire) - head;
+		}
+
+		bool empty() const { return size() == 0; }
+
+		/**
+		 * Queues value, or returns false if the queue is full
+		 */
+		bool push(Quantity const& value)
+		{
+			return push(Span<Quantity const>(&value, 1)) == 1;
+		}
+
+		/**
+		 * Queues as many of `values` as fit, in order and without values from
+		 * other producers between them, returning how many
+		 */
+		std::size_t push(Span<Quantity const> values)
+		{
+			std::size_t tail = p_tail.load(std::memory_order_relaxed);
+			std::size_t count;
+			do
+			{
+				std::size_t const space = capacity() - (tail - p_head.load(std::memory_order_acquire));
+				count = values.size() < space ? values.size() : space;
+				if(count == 0)
+				{
+					return 0;
+				}
+			}
+			while(!p_tail.compare_exchange_weak(tail, tail + count, std::memory_order_relaxed));
+
+			for(std::size_t i = 0; i < count; i++)
+			{
+				Slot& slot = p_slots[(tail + i) & p_mask];
+				slot.value = values[i];
+				slot.written.store(tail + i + 1, std::memory_order_release);
+			}
+			return count;
+		}
+
+		/**
+		 * Takes the oldest value into value, or returns false if the queue
+		 * has no written value at its front
+		 */
+		bool pop(Quantity& value)
+		{
+			return pop(Span<Quantity>(&value, 1)) == 1;
+		}
+
+		/**
+		 * Takes up to out.size() of the oldest values into out, stopping at
+		 * the first slot not yet written, returning how many
+		 */
+		std::size_t pop(Span<Quantity> out)
+		{
+			std::size_t const head = p_head.load(std::memory_order_relaxed);
+			std::size_t count = 0;
+			for(; count < out.size(); count++)
+			{
+				Slot const& slot = p_slots[(head + count) & p_mask];
+				if(slot.written.load(std::memory_order_acquire) != head + count + 1)
+				{
+					break;
+				}
+				out[count] = slot.value;
+			}
+			p_head.store(head + count, std::memory_order_release);
+			return count;
+		}
+
+	private:
+		struct Slot
+		{
+			/** One past the position of the value last written here */
+			std::atomic<std::size_t> written;
+			Quantity value;
+		};
+
+		std::vector<Slot> p_slots;
+		std::size_t p_mask;
+		alignas(_internal::c_queue_line) std::atomic<std::size_t> p_tail{0};
+		alignas(_internal::c_queue_line) std::atomic<std::size_t> p_head{0};
+	};
+}
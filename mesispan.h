@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace Mesi {
+	/**
+	 * @brief Non-owning view of a contiguous sequence of T
+	 *
+	 * Stands in for std::span, which is not available in C++14. Bulk
+	 * operations on Mesi types take Spans so they can work on any contiguous
+	 * storage (arrays, std::vector, std::array, raw buffers).
+	 *
+	 * A Span<T const> can be made from a Span<T>, or from any container with
+	 * data() and size() members whose elements are convertible.
+	 */
+	template<typename T>
+	struct Span
+	{
+		using element_type = T;
+		using value_type = typename std::remove_cv<T>::type;
+		using iterator = T*;
+
+		constexpr Span()
+			:p_data(nullptr), p_size(0)
+		{}
+
+		constexpr Span(T* data, std::size_t size)
+			:p_data(data), p_size(size)
+		{}
+
+		template<std::size_t N>
+		constexpr Span(T (&array)[N])
+			:p_data(array), p_size(N)
+		{}
+
+		template<typename U, typename = typename std::enable_if<std::is_convertible<U(*)[], T(*)[]>::value>::type>
+		constexpr Span(Span<U> const& other)
+			:p_data(other.data()), p_size(other.size())
+		{}
+
+		template<typename Container,
+			typename = typename std::enable_if<
+				!std::is_same<typename std::decay<Container>::type, Span>::value &&
+				std::is_convertible<typename std::remove_pointer<decltype(std::declval<Container&>().data())>::type(*)[], T(*)[]>::value
+			>::type>
+		constexpr Span(Container& container)
+			:p_data(container.data()), p_size(container.size())
+		{}
+
+		constexpr T* data() const { return p_data; }
+		constexpr std::size_t size() const { return p_size; }
+		constexpr bool empty() const { return p_size == 0; }
+
+		constexpr T& operator[](std::size_t i) const { return p_data[i]; }
+
+		constexpr T* begin() const { return p_data; }
+		constexpr T* end() const { return p_data + p_size; }
+
+		/**
+		 * The `count` elements starting at `offset`, clipped to the end of
+		 * this span
+		 */
+		constexpr Span subspan(std::size_t offset, std::size_t count) const
+		{
+			return offset >= p_size
+				? Span(p_data + p_size, 0)
+				: Span(p_data + offset, count < p_size - offset ? count : p_size - offset);
+		}
+
+	private:
+		T* p_data;
+		std::size_t p_size;
+	};
+
+	namespace _internal {
+		/**
+		 * The elements and length of a container with data() and size(), or
+		 * of an array
+		 */
+		template<typename Container>
+		constexpr auto Data(Container& c) -> decltype(c.data())
+		{
+			return c.data();
+		}
+
+		template<typename T, std::size_t N>
+		constexpr T* Data(T (&array)[N])
+		{
+			return array;
+		}
+
+		template<typename Container>
+		constexpr auto Size(Container const& c) -> decltype(c.size())
+		{
+			return c.size();
+		}
+
+		template<typename T, std::size_t N>
+		constexpr std::size_t Size(T const (&)[N])
+		{
+			return N;
+		}
+
+		/**
+		 * The length of the shortest of the containers
+		 */
+		template<typename Container>
+		constexpr std::size_t CommonSize(Container const& c)
+		{
+			return Size(c);
+		}
+
+		template<typename Container, typename... Rest>
+		constexpr std::size_t CommonSize(Container const& c, Rest const&... rest)
+		{
+			return Size(c) < CommonSize(rest...) ? Size(c) : CommonSize(rest...);
+		}
+
+		template<typename Container>
+		using ElementType = typename std::remove_cv<typename std::remove_pointer<
+			decltype(Data(std::declval<Container&>()))>::type>::type;
+
+		template<typename T, typename = void>
+		struct HasBaseType : std::false_type {};
+
+		template<typename T>
+		struct HasBaseType<T, decltype(void(std::declval<typename T::BaseType>()))> : std::true_type {};
+
+		/**
+		 * Whether Wrapper is a layout-compatible wrapper around Raw: Raw is
+		 * its base type, and it is a trivially copyable, standard-layout type
+		 * of the same size and alignment
+		 */
+		template<typename Wrapper, typename Raw, bool = HasBaseType<Wrapper>::value>
+		struct IsLayoutWrapper : std::false_type {};
+
+		template<typename Wrapper, typename Raw>
+		struct IsLayoutWrapper<Wrapper, Raw, true> : std::integral_constant<bool,
+			std::is_same<typename Wrapper::BaseType, Raw>::value &&
+			std::is_trivially_copyable<Wrapper>::value &&
+			std::is_standard_layout<Wrapper>::value &&
+			sizeof(Wrapper) == sizeof(Raw) &&
+			alignof(Wrapper) == alignof(Raw)
+		> {};
+
+		template<typename To, typename From>
+		using ViewAs = typename std::enable_if<
+			IsLayoutWrapper<typename std::remove_cv<To>::type, typename std::remove_cv<From>::type>::value ||
+			IsLayoutWrapper<typename std::remove_cv<From>::type, typename std::remove_cv<To>::type>::value,
+			Span<typename std::conditional<std::is_const<From>::value, To const, To>::type>
+		>::type;
+	}
+
+	/**
+	 * @brief Reinterprets a buffer of raw values as Mesi types, or back
+	 *
+	 * view_as<Meters>(Span<float>) gives a Span<Meters> over the same memory,
+	 * and view_as<float>(Span<Meters>) the reverse, so that existing buffers
+	 * (legacy arrays, DMA regions, memory-mapped files) can be given units
+	 * without copying. Constness of the source is kept.
+	 *
+	 * Only conversions between a type and its BaseType are allowed, and only
+	 * when the two have identical layout, which is checked at compile time.
+	 */
+	template<typename To, typename From>
+	_internal::ViewAs<To, From> view_as(Span<From> from)
+	{
+		using Result = _internal::ViewAs<To, From>;
+		using Element = typename Result::element_type;
+		return Result(reinterpret_cast<Element*>(from.data()), from.size());
+	}
+
+	template<typename To, typename Container,
+		typename From = typename std::remove_pointer<decltype(std::declval<Container&>().data())>::type>
+	_internal::ViewAs<To, From> view_as(Container& from)
+	{
+		return view_as<To>(Span<From>(from));
+	}
+
+	namespace _internal {
+		/**
+		 * The base values of contiguous Mesi quantities
+		 */
+		template<typename Container>
+		auto BaseData(Container& c)
+		{
+			using Element = typename std::remove_pointer<decltype(Data(c))>::type;
+			return view_as<typename ElementType<Container>::BaseType>(Span<Element>(Data(c), Size(c))).data();
+		}
+	}
+}
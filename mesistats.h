@@ -0,0 +1,374 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <ratio>
+#include <vector>
+#include "mesicore.h"
+#include "mesifastmath.h"
+#include "mesispan.h"
+
+namespace Mesi {
+	/**
+	 * @brief Streaming mean, variance, minimum and maximum of a quantity
+	 *
+	 * @param Quantity the Mesi type of the samples
+	 * @param Accumulator storage type used for the running sums. This
+	 *        defaults to double so that long streams of float samples don't
+	 *        lose precision.
+	 *
+	 * Samples are added one at a time (Welford's algorithm) or in batches,
+	 * and accumulators filled on different threads can be combined with
+	 * merge(). The variance has the type of the square of the samples, e.g.
+	 * the variance of Volts is in Volts^2.
+	 */
+	template<typename Quantity, typename Accumulator = double>
+	class Statistics
+	{
+	public:
+		using ValueType = Quantity;
+		using VarianceType = typename Quantity::template Pow<std::ratio<2,1>>;
+
+		Statistics()
+			:p_count(0), p_mean(0), p_m2(0),
+			p_min(std::numeric_limits<Accumulator>::infinity()),
+			p_max(-std::numeric_limits<Accumulator>::infinity())
+		{}
+
+		void add(Quantity const& sample)
+		{
+			Accumulator const x = Accumulator(sample.val);
+			p_count++;
+			Accumulator const delta = x - p_mean;
+			p_mean += delta / Accumulator(p_count);
+			p_m2 += delta * (x - p_mean);
+			p_min = x < p_min ? x : p_min;
+			p_max = x > p_max ? x : p_max;
+		}
+
+		/**
+		 * Adds a batch of samples. The batch's own mean and variance are
+		 * computed with two passes over independent lanes, which compilers
+		 * can vectorise without reassociating floating-point sums, and then
+		 * merged into the running totals.
+		 */
+		void add(Span<Quantity const> samples)
+		{
+			constexpr std::size_t lanes = 8;
+			std::size_t const n = samples.size();
+			std::size_t const bulk = n - n % lanes;
+			Quantity const* data = samples.data();
+
+			Accumulator sum[lanes] = {};
+			Accumulator lo[lanes];
+			Accumulator hi[lanes];
+			for(std::size_t j = 0; j < lanes; j++)
+			{
+				lo[j] = std::numeric_limits<Accumulator>::infinity();
+				hi[j] = -std::numeric_limits<Accumulator>::infinity();
+			}
+			for(std::size_t i = 0; i < bulk; i += lanes)
+			{
+				for(std::size_t j = 0; j < lanes; j++)
+				{
+					Accumulator const x = Accumulator(data[i + j].val);
+					sum[j] += x;
+					lo[j] = x < lo[j] ? x : lo[j];
+					hi[j] = x > hi[j] ? x : hi[j];
+				}
+			}
+			for(std::size_t i = bulk; i < n; i++)
+			{
+				Accumulator const x = Accumulator(data[i].val);
+				sum[0] += x;
+				lo[0] = x < lo[0] ? x : lo[0];
+				hi[0] = x > hi[0] ? x : hi[0];
+			}
+
+			Statistics batch;
+			batch.p_count = n;
+			for(std::size_t j = 0; j < lanes; j++)
+			{
+				batch.p_mean += sum[j];
+				batch.p_min = lo[j] < batch.p_min ? lo[j] : batch.p_min;
+				batch.p_max = hi[j] > batch.p_max ? hi[j] : batch.p_max;
+			}
+			if(n == 0)
+			{
+				return;
+			}
+			batch.p_mean /= Accumulator(n);
+
+			Accumulator m2[lanes] = {};
+			for(std::size_t i = 0; i < bulk; i += lanes)
+			{
+				for(std::size_t j = 0; j < lanes; j++)
+				{
+					Accumulator const d = Accumulator(data[i + j].val) - batch.p_mean;
+					m2[j] += d * d;
+				}
+			}
+			for(std::size_t i = bulk; i < n; i++)
+			{
+				Accumulator const d = Accumulator(data[i].val) - batch.p_mean;
+				m2[0] += d * d;
+			}
+			for(std::size_t j = 0; j < lanes; j++)
+			{
+				batch.p_m2 += m2[j];
+			}
+
+			merge(batch);
+		}
+
+		/**
+		 * Combines the samples of another accumulator into this one (Chan et
+		 * al.'s parallel algorithm)
+		 */
+		void merge(Statistics const& other)
+		{
+			if(other.p_count == 0)
+			{
+				return;
+			}
+			if(p_count == 0)
+			{
+				*this = other;
+				return;
+			}
+			uint64_t const count = p_count + other.p_count;
+			Accumulator const delta = other.p_mean - p_mean;
+			Accumulator const weight = Accumulator(other.p_count) / Accumulator(count);
+			p_mean += delta * weight;
+			p_m2 += other.p_m2 + delta * delta * Accumulator(p_count) * weight;
+			p_count = count;
+			p_min = other.p_min < p_min ? other.p_min : p_min;
+			p_max = other.p_max > p_max ? other.p_max : p_max;
+		}
+
+		uint64_t count() const { return p_count; }
+
+		Quantity mean() const { return Quantity(typename Quantity::BaseType(p_mean)); }
+		Quantity min() const { return Quantity(typename Quantity::BaseType(p_min)); }
+		Quantity max() const { return Quantity(typename Quantity::BaseType(p_max)); }
+
+		/**
+		 * Population variance, i.e. the mean squared deviation
+		 */
+		VarianceType variance() const
+		{
+			return VarianceType(typename VarianceType::BaseType(p_count ? p_m2 / Accumulator(p_count) : Accumulator(0)));
+		}
+
+		/**
+		 * Unbiased sample variance, dividing by count() - 1
+		 */
+		VarianceType sampleVariance() const
+		{
+			return VarianceType(typename VarianceType::BaseType(p_count > 1 ? p_m2 / Accumulator(p_count - 1) : Accumulator(0)));
+		}
+
+		/**
+		 * Population standard deviation
+		 */
+		auto standardDeviation() const
+		{
+			return Mesi::pow<std::ratio<1,2>>(variance());
+		}
+
+	private:
+		uint64_t p_count;
+		Accumulator p_mean;
+		Accumulator p_m2;
+		Accumulator p_min;
+		Accumulator p_max;
+	};
+
+	/**
+	 * @brief Mergeable sketch for approximate quantiles of a quantity
+	 *
+	 * Values are counted in logarithmically sized buckets (as in DDSketch),
+	 * so any quantile is returned with a relative error of at most the
+	 * accuracy given on construction, whatever the distribution. Sketches
+	 * built on different threads can be combined with merge() as long as
+	 * they share the same accuracy.
+	 *
+	 * Infinite samples are counted separately and ranked beyond every
+	 * finite one, and NaN samples, which have no rank, are ignored.
+	 *
+	 * This is kept separate from Statistics as it costs a logarithm per
+	 * sample, which Statistics users may not want to pay.
+	 */
+	template<typename Quantity>
+	class QuantileSketch
+	{
+	public:
+		explicit QuantileSketch(double relative_accuracy = 0.01)
+			:p_gamma((1 + relative_accuracy) / (1 - relative_accuracy)),
+			p_inverse_log_gamma(1 / std::log(p_gamma)),
+			p_zero_count(0),
+			p_infinite_counts{0, 0}
+		{}
+
+		void add(Quantity const& sample)
+		{
+			double const x = double(sample.val);
+			if(std::isnan(x))
+			{
+				return;
+			}
+			if(std::isinf(x))
+			{
+				p_infinite_counts[x > 0]++;
+			}
+			else if(x > c_min_magnitude)
+			{
+				p_positive.add(index(x));
+			}
+			else if(x < -c_min_magnitude)
+			{
+				p_negative.add(index(-x));
+			}
+			else
+			{
+				p_zero_count++;
+			}
+		}
+
+		void add(Span<Quantity const> samples)
+		{
+			for(auto const& s : samples)
+			{
+				add(s);
+			}
+		}
+
+		void merge(QuantileSketch const& other)
+		{
+			p_positive.merge(other.p_positive);
+			p_negative.merge(other.p_negative);
+			p_zero_count += other.p_zero_count;
+			p_infinite_counts[0] += other.p_infinite_counts[0];
+			p_infinite_counts[1] += other.p_infinite_counts[1];
+		}
+
+		uint64_t count() const
+		{
+			return p_positive.total + p_negative.total + p_zero_count + p_infinite_counts[0] + p_infinite_counts[1];
+		}
+
+		/**
+		 * Estimates the q-th quantile, for q in [0, 1]. Returns zero for an
+		 * empty sketch.
+		 */
+		Quantity quantile(double q) const
+		{
+			using T = typename Quantity::BaseType;
+			uint64_t const total = count();
+			if(total == 0)
+			{
+				return Quantity(T(0));
+			}
+			q = q < 0 ? 0 : (q > 1 ? 1 : q);
+			uint64_t const rank = uint64_t(q * double(total - 1));
+
+			uint64_t seen = p_infinite_counts[0];
+			if(seen > rank)
+			{
+				return Quantity(T(-std::numeric_limits<double>::infinity()));
+			}
+			// Negative values, from the largest magnitude down
+			for(std::size_t i = p_negative.counts.size(); i-- > 0;)
+			{
+				seen += p_negative.counts[i];
+				if(seen > rank)
+				{
+					return Quantity(T(-value(int(i) + p_negative.offset)));
+				}
+			}
+			seen += p_zero_count;
+			if(seen > rank)
+			{
+				return Quantity(T(0));
+			}
+			for(std::size_t i = 0; i < p_positive.counts.size(); i++)
+			{
+				seen += p_positive.counts[i];
+				if(seen > rank)
+				{
+					return Quantity(T(value(int(i) + p_positive.offset)));
+				}
+			}
+			return Quantity(T(std::numeric_limits<double>::infinity()));
+		}
+
+	private:
+		static constexpr double c_min_magnitude = std::numeric_limits<double>::min();
+
+		/**
+		 * Counts per bucket index, stored densely from `offset` upwards
+		 */
+		struct Store
+		{
+			std::vector<uint64_t> counts;
+			int offset = 0;
+			uint64_t total = 0;
+
+			void add(int i, uint64_t n = 1)
+			{
+				if(counts.empty())
+				{
+					offset = i;
+				}
+				if(i < offset)
+				{
+					counts.insert(counts.begin(), std::size_t(offset - i), 0);
+					offset = i;
+				}
+				if(std::size_t(i - offset) >= counts.size())
+				{
+					counts.resize(std::size_t(i - offset) + 1, 0);
+				}
+				counts[std::size_t(i - offset)] += n;
+				total += n;
+			}
+
+			void merge(Store const& other)
+			{
+				for(std::size_t i = 0; i < other.counts.size(); i++)
+				{
+					if(other.counts[i])
+					{
+						add(int(i) + other.offset, other.counts[i]);
+					}
+				}
+			}
+		};
+
+		/**
+		 * Bucket i holds magnitudes in (gamma^(i-1), gamma^i]. The fast log's
+		 * error is far below the bucket width.
+		 */
+		int index(double magnitude) const
+		{
+			return int(std::ceil(Fast::_internal::Log(magnitude) * p_inverse_log_gamma));
+		}
+
+		/**
+		 * Representative value of bucket i, within the relative accuracy of
+		 * every magnitude in the bucket
+		 */
+		double value(int i) const
+		{
+			return 2 * std::pow(p_gamma, i) / (p_gamma + 1);
+		}
+
+		double p_gamma;
+		double p_inverse_log_gamma;
+		Store p_positive;
+		Store p_negative;
+		uint64_t p_zero_count;
+		/** Counts of negative and positive infinities */
+		uint64_t p_infinite_counts[2];
+	};
+}
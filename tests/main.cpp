@@ -1,12 +1,33 @@
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <limits>
 #include <vector>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <iostream>
 #include <regex>
 
 #include "../mesitype.h"
 #include "../mesimath.h"
+#include "../mesifastmath.h"
+#include "../mesistats.h"
+#include "../mesicompress.h"
+#include "../mesiquantized.h"
+#include "../mesiatomic.h"
+#include "../mesichecked.h"
+#include "../mesilut.h"
+#include "../mesipoly.h"
+#include "../mesicalculus.h"
+#include "../mesicomplex.h"
+#include "../mesiangle.h"
+#include "../mesifield.h"
+#include "../mesiindex.h"
+#include "../mesiqueue.h"
+#include "../mesidual.h"
+#include "../mesigroupby.h"
+#include "../mesiclock.h"
 #include "tee/tee.hpp"
 
 using namespace std;
@@ -322,6 +343,15 @@ Tee_Test(test_conversions) {
 		assert(Mesi::Hours(1) == Mesi::Hours(Mesi::Minutes(60)));
 	}
 
+	Tee_SubTest(test_negative_powers_of_ten) {
+		// The closest values to the exact scales, not repeated divisions
+		assert(Meters(Mesi::Milli<Meters>(1)).val == 0.001f);
+		assert(Meters(Mesi::Nano<Meters>(3)).val == 3 * 1e-9f);
+		using MetersD = Mesi::Type<double, 1, 0, 0>;
+		assert(MetersD(Mesi::Pico<MetersD>(1)).val == 1e-12);
+		assert(Mesi::Milli<Meters>(Mesi::Micro<Meters>(1)).val == 0.001f);
+	}
+
 	Tee_SubTest(test_multiples) {
 		assert(Meters(Meters::Multiply<5>(1)) == Meters(5));
 	}
@@ -394,6 +424,67 @@ Tee_Test(test_unit_scaling) {
 		assert((std::is_same<Scalar::Multiply<10>, Mesi::Scalar::ScaleByTenToThe<1>>::value));
 		assert((std::is_same<Scalar::Multiply<4>::Multiply<25>, Mesi::Scalar::ScaleByTenToThe<3>::ScaleByTenToThe<-1>>::value));
 	}
+
+	Tee_SubTest(test_scale_canonical_form) {
+		// Chained scales are reduced as they go, so this never overflows
+		auto x = Mesi::Hours(1) * Mesi::Tonnes(1) / Mesi::Micro<Mesi::Seconds>(1);
+		assert((std::is_same<decltype(x)::ScaleInfo, Scale<std::ratio<36,1>, 1, std::ratio<11,1>>>::value));
+
+		// Roots are taken where possible, and factors of ten always move
+		// to the power of ten, so equal scales have the same type
+		assert((std::is_same<ScaleSimplify<Scale<std::ratio<40804,9>, 2, Zero>>::Scale, Scale<std::ratio<202,3>, 1, Zero>>::value));
+		assert((std::is_same<ScaleSimplify<Scale<std::ratio<1000,1>, 2, Zero>>::Scale, Scale<One, 1, std::ratio<3,2>>>::value));
+		assert((std::is_same<ScaleSimplify<Scale<std::ratio<1000,1>, 2, Zero>>::Scale, ScalePower<Scale<One, 1, std::ratio<3,1>>, OneHalf>::Scale>::value));
+		assert((std::is_same<ScaleSimplify<Scale<std::ratio<-8,1>, 3, Zero>>::Scale, Scale<std::ratio<-2,1>, 1, Zero>>::value));
+		assert((std::is_same<ScaleDivide<Scale<Two, 2, Zero>, Scale<Two, 2, Zero>>::Scale, ScaleOne>::value));
+
+		// A zero scale absorbs everything it is multiplied by
+		using ZeroScale = Scale<Zero, 1, Zero>;
+		assert((std::is_same<ScaleMultiply<ZeroScale, Mesi::Hours::ScaleInfo>::Scale, ZeroScale>::value));
+		assert((std::is_same<ScaleMultiply<Mesi::Hours::ScaleInfo, ZeroScale>::Scale, ZeroScale>::value));
+	}
+
+	Tee_SubTest(test_large_ratios) {
+		// Roots of ratios near the limits of intmax_t
+		using TwoTo62 = std::ratio<4611686018427387904, 1>;
+		using S1 = ScaleSimplify<Scale<TwoTo62, 2, Zero>>::Scale;
+		assert(S1::ratio::num == 2147483648);
+		assert(S1::exponent_denominator == 1);
+
+		using S2 = ScaleSimplify<Scale<TwoTo62, 62, Zero>>::Scale;
+		assert((std::is_same<S2::ratio, Two>::value));
+		assert(S2::exponent_denominator == 1);
+
+		using ThreeTo39 = std::ratio<1, 4052555153018976267>;
+		using S3 = ScaleSimplify<Scale<ThreeTo39, 39, Zero>>::Scale;
+		assert((std::is_same<S3::ratio, std::ratio<1,3>>::value));
+		assert(S3::exponent_denominator == 1);
+
+		// A large prime has no integer roots, which takes the longest to find
+		using LargePrime = std::ratio<999999999989, 1>;
+		using S4 = ScaleSimplify<Scale<LargePrime, 2, Zero>>::Scale;
+		assert((std::is_same<S4::ratio, LargePrime>::value));
+		assert(S4::exponent_denominator == 2);
+		assert((std::is_same<ScaleMultiply<S4, S4>::Scale, Scale<LargePrime, 1, Zero>>::value));
+
+		// Large powers of scales
+		using S5 = ScalePower<Scale<One, 1, std::ratio<3,1>>, std::ratio<1000,1>>::Scale;
+		assert((std::is_same<S5::ratio, One>::value));
+		assert(S5::power_of_ten::num == 3000);
+		using S6 = ScalePower<Scale<Two, 1, Zero>, std::ratio<62,1>>::Scale;
+		assert((std::is_same<S6::ratio, TwoTo62>::value));
+		assert((Exp<3, 39>::value == 4052555153018976267));
+		assert((Exp<-3, 39>::value == -4052555153018976267));
+
+		// Products of two large primes, which overflow if multiplied out
+		using P1 = Scale<std::ratio<1000000007LL * 1000000009LL, 1>, 2, Zero>;
+		using P2 = Scale<std::ratio<1, 1000000007LL * 1000000021LL>, 2, Zero>;
+		using S7 = ScaleMultiply<P1, P2>::Scale;
+		assert((std::is_same<S7, Scale<std::ratio<1000000009LL, 1000000021LL>, 2, Zero>>::value));
+
+		using Big = Mesi::Type<double, 1, 0, 0, 0, 0, 0, 0, LargePrime, 2>;
+		assert(std::fabs(Mesi::Type<double, 1, 0, 0>(Big(1)).val - std::sqrt(999999999989.)) < 1e-6);
+	}
 }
 
 Tee_Test(test_unit_exponentiation) {
@@ -428,6 +519,31 @@ Tee_Test(test_unit_exponentiation) {
 		assert(b == Mesi::Minutes(1)*Mesi::Minutes(1)*25);
 		assert(c == a);
 	}
+
+	Tee_SubTest(test_pow_strategies_match_std_pow) {
+		auto m = Mesi::Meters(2.5f);
+		auto close = [](float a, float b) { return std::fabs(a - b) <= 1e-5f * std::fabs(b); };
+
+		assert((Mesi::pow<std::ratio<0,1>>(m).val == 1));
+		assert((Mesi::pow<std::ratio<1,1>>(m).val == m.val));
+		assert((close(Mesi::pow<std::ratio<2,1>>(m).val, std::pow(2.5f, 2.f))));
+		assert((close(Mesi::pow<std::ratio<3,1>>(m).val, std::pow(2.5f, 3.f))));
+		assert((close(Mesi::pow<std::ratio<7,1>>(m).val, std::pow(2.5f, 7.f))));
+		assert((close(Mesi::pow<std::ratio<-1,1>>(m).val, std::pow(2.5f, -1.f))));
+		assert((close(Mesi::pow<std::ratio<-3,1>>(m).val, std::pow(2.5f, -3.f))));
+		assert((close(Mesi::pow<std::ratio<1,2>>(m).val, std::pow(2.5f, 0.5f))));
+		assert((close(Mesi::pow<std::ratio<1,3>>(m).val, std::pow(2.5f, 1/3.f))));
+		assert((close(Mesi::pow<std::ratio<3,2>>(m).val, std::pow(2.5f, 1.5f))));
+		assert((close(Mesi::pow<std::ratio<-5,4>>(m).val, std::pow(2.5f, -1.25f))));
+		assert((close(Mesi::pow<std::ratio<7,4>>(m).val, std::pow(2.5f, 7/4.f))));
+		assert((close(Mesi::pow<std::ratio<2,5>>(m).val, std::pow(2.5f, 0.4f))));
+	}
+
+	Tee_SubTest(test_integer_pow_of_integer_types) {
+		auto m = Mesi::Type<int, 1, 0, 0>(3);
+		assert((Mesi::pow<std::ratio<4,1>>(m).val == 81));
+		assert((std::is_same<decltype(Mesi::pow<std::ratio<4,1>>(m))::BaseType, int>::value));
+	}
 }
 
 Tee_Test(test_std_math) {
@@ -462,6 +578,49 @@ Tee_Test(test_std_math) {
 		assert(5_v == std::hypot(4_v, 3_v));
 	}
 
+	Tee_SubTest(test_constexpr) {
+		using namespace Mesi::Literals;
+		using MetersD = Mesi::Type<double, 1, 0, 0>;
+		using MetersSqD = Mesi::Type<double, 2, 0, 0>;
+
+		static_assert(std::sqrt(2_m * 8_m) == 4_m, "sqrt should be constexpr");
+		static_assert(std::hypot(3_m, 4_m) == 5_m, "hypot should be constexpr");
+		static_assert(std::cbrt(Mesi::MetersCu(-27)) == -3_m, "cbrt should be constexpr");
+		static_assert(std::fma(2_a, 2_ohm, 1_v) == 5_v, "fma should be constexpr");
+		static_assert(Mesi::pow<std::ratio<3,2>>(Mesi::MetersSq(4)) == Mesi::MetersCu(8), "pow should be constexpr");
+		static_assert(Mesi::pow<std::ratio<-2,5>>(Mesi::Type<double, 5, 0, 0>(32)).val == 0.25, "pow should be constexpr");
+		static_assert(std::sqrt(Mesi::Type<int, 2, 0, 0>(99)).val == 9, "integer roots truncate");
+		static_assert(std::sqrt(Mesi::Type<int, 2, 0, 0>(100)).val == 10, "integer roots are exact");
+		static_assert(std::abs(-2.5_m) == 2.5_m, "abs should be constexpr");
+		static_assert(std::fmin(1_m, 2_m) == 1_m && std::fmax(1_m, 2_m) == 2_m, "fmin should be constexpr");
+		static_assert(std::fdim(3_m, 2_m) == 1_m && std::fdim(2_m, 3_m) == 0_m, "fdim should be constexpr");
+		static_assert(std::floor(-2.5_m) == -3_m && std::ceil(-2.5_m) == -2_m, "floor should be constexpr");
+		static_assert(std::trunc(-2.5_m) == -2_m && std::round(-2.5_m) == -3_m, "round should be constexpr");
+		static_assert(std::rint(-2.5_m) == -2_m && std::nearbyint(3.5_m) == 4_m, "rint rounds to even");
+
+		// Compile time results match the run time ones
+		struct Roots
+		{
+			MetersD sqrt[64];
+			MetersD floor[64];
+			constexpr Roots() : sqrt{}, floor{}
+			{
+				for(int i = 0; i < 64; i++)
+				{
+					sqrt[i] = std::sqrt(MetersSqD(i * 0.37 + 1e-300 * i));
+					floor[i] = std::floor(MetersD(i * -0.37));
+				}
+			}
+		};
+		constexpr Roots roots;
+		volatile double scale = 1;
+		for(int i = 0; i < 64; i++)
+		{
+			assert(roots.sqrt[i] == std::sqrt(MetersSqD(i * 0.37 * scale + 1e-300 * i)));
+			assert(roots.floor[i] == std::floor(MetersD(i * -0.37 * scale)));
+		}
+	}
+
 
 	Tee_SubTest(test_var_pow) {
 		Mesi::Minutes a = Mesi::Minutes(5);
@@ -473,6 +632,1709 @@ Tee_Test(test_std_math) {
 	}
 }
 
+Tee_Test(test_fast_math) {
+	using Scalar = Mesi::Scalar;
+	int const samples = 100000;
+
+	Tee_SubTest(test_fast_exp_error_bound) {
+		float worst = 0;
+		for(int i = 0; i <= samples; i++)
+		{
+			float x = -80.f + 160.f * i / samples;
+			double ref = std::exp(double(x));
+			worst = std::max(worst, float(std::fabs(Mesi::Fast::exp(Scalar(x)).val - ref) / ref));
+		}
+		assert(worst < 1e-6f);
+	}
+
+	Tee_SubTest(test_fast_log_error_bound) {
+		float worst = 0;
+		for(int i = 1; i <= samples; i++)
+		{
+			float x = float(std::exp(-80. + 160. * i / samples));
+			double ref = std::log(double(x));
+			worst = std::max(worst, float(std::fabs(Mesi::Fast::log(Scalar(x)).val - ref) / std::max(std::fabs(ref), 1e-30)));
+		}
+		assert(worst < 1e-6f);
+		assert(std::isinf(Mesi::Fast::log(Scalar(0)).val));
+	}
+
+	Tee_SubTest(test_fast_trig_error_bound) {
+		float worst = 0;
+		for(int i = 0; i <= samples; i++)
+		{
+			float x = -1e4f + 2e4f * i / samples;
+			worst = std::max(worst, float(std::fabs(Mesi::Fast::sin(Scalar(x)).val - std::sin(double(x)))));
+			worst = std::max(worst, float(std::fabs(Mesi::Fast::cos(Scalar(x)).val - std::cos(double(x)))));
+		}
+		assert(worst < 1e-6f);
+	}
+
+	Tee_SubTest(test_fast_atan2_error_bound) {
+		float worst = 0;
+		for(int i = 0; i <= samples; i++)
+		{
+			float angle = -4.f + 8.f * i / samples;
+			float y = 3 * std::sin(angle);
+			float x = std::cos(angle);
+			worst = std::max(worst, float(std::fabs(Mesi::Fast::atan2(Scalar(y), Scalar(x)).val - std::atan2(double(y), double(x)))));
+		}
+		assert(worst < 1e-6f);
+		assert(Mesi::Fast::atan2(Scalar(0), Scalar(1)).val == 0);
+	}
+
+	Tee_SubTest(test_fast_sqrt_error_bound_and_dimension) {
+		float worst = 0;
+		for(int i = 0; i <= samples; i++)
+		{
+			float x = float(std::exp(-60. + 120. * i / samples));
+			double ref = std::sqrt(double(x));
+			worst = std::max(worst, float(std::fabs(Mesi::Fast::sqrt(Mesi::MetersSq(x)).val - ref) / ref));
+		}
+		assert(worst < 1e-6f);
+		// Denormals, down to the smallest, are scaled into the normal range
+		for(float const x : {1e-40f, 1e-42f, std::numeric_limits<float>::denorm_min()})
+		{
+			double const ref = std::sqrt(double(x));
+			assert(std::fabs(Mesi::Fast::sqrt(Mesi::MetersSq(x)).val - ref) / ref < 1e-6);
+		}
+		for(double const x : {1e-310, std::numeric_limits<double>::denorm_min()})
+		{
+			double const ref = std::sqrt(x);
+			assert(std::fabs(Mesi::Fast::sqrt(Mesi::Type<double, 2, 0, 0>(x)).val - ref) / ref < 1e-6);
+		}
+		assert((std::is_same<decltype(Mesi::Fast::sqrt(Mesi::MetersSq(4))), Mesi::Meters>::value));
+		assert(Mesi::Fast::sqrt(Mesi::MetersSq(0)).val == 0);
+	}
+
+	Tee_SubTest(test_precise_policy_matches_std) {
+		namespace Maths = Mesi::Precise;
+		assert(Maths::exp(Scalar(2)) == std::exp(Scalar(2)));
+		assert(Maths::atan2(Scalar(1), Scalar(2)) == std::atan2(Scalar(1), Scalar(2)));
+		assert(Maths::sqrt(Mesi::MetersSq(9)) == Mesi::Meters(3));
+	}
+}
+
+Tee_Test(test_statistics) {
+	using Volts = Mesi::Volts;
+	std::vector<Volts> samples;
+	for(int i = 0; i < 1001; i++)
+	{
+		samples.push_back(Volts(float(i % 37) * 0.5f - 3.f));
+	}
+	double mean = 0;
+	for(auto const& s : samples)
+		mean += s.val;
+	mean /= samples.size();
+	double variance = 0;
+	for(auto const& s : samples)
+		variance += (s.val - mean) * (s.val - mean);
+	variance /= samples.size();
+	auto close = [](double a, double b) { return std::fabs(a - b) <= 1e-6 * std::max(1.0, std::fabs(b)); };
+
+	Tee_SubTest(test_result_types) {
+		using Stats = Mesi::Statistics<Volts>;
+		assert((std::is_same<decltype(Stats{}.mean()), Volts>::value));
+		assert((std::is_same<decltype(Stats{}.variance()), decltype(Volts{} * Volts{})>::value));
+		assert((std::is_same<decltype(Stats{}.standardDeviation()), Volts>::value));
+	}
+
+	Tee_SubTest(test_single_samples) {
+		Mesi::Statistics<Volts> stats;
+		for(auto const& s : samples)
+			stats.add(s);
+		assert(stats.count() == samples.size());
+		assert((close(stats.mean().val, mean)));
+		assert((close(stats.variance().val, variance)));
+		assert(stats.min() == Volts(-3));
+		assert(stats.max() == Volts(15));
+	}
+
+	Tee_SubTest(test_batches_and_merging_match) {
+		Mesi::Statistics<Volts> batched;
+		batched.add(Mesi::Span<Volts const>(samples).subspan(0, 300));
+		Mesi::Statistics<Volts> other;
+		other.add(Mesi::Span<Volts const>(samples).subspan(300, 1000));
+		batched.merge(other);
+		batched.merge(Mesi::Statistics<Volts>());
+		assert(batched.count() == samples.size());
+		assert((close(batched.mean().val, mean)));
+		assert((close(batched.variance().val, variance)));
+		assert((close(batched.sampleVariance().val, variance * samples.size() / (samples.size() - 1))));
+		assert(batched.min() == Volts(-3));
+		assert(batched.max() == Volts(15));
+	}
+
+	Tee_SubTest(test_quantiles_are_within_relative_accuracy) {
+		Mesi::QuantileSketch<Mesi::Seconds> a(0.01);
+		Mesi::QuantileSketch<Mesi::Seconds> b(0.01);
+		for(int i = 1; i <= 10000; i++)
+		{
+			(i % 2 ? a : b).add(Mesi::Seconds(float(i) * 1e-3f));
+		}
+		a.merge(b);
+		assert(a.count() == 10000);
+		for(double q : {0.0, 0.1, 0.5, 0.9, 0.99, 1.0})
+		{
+			double exact = (std::floor(q * 9999) + 1) * 1e-3;
+			assert(std::fabs(a.quantile(q).val - exact) <= 0.0101 * exact);
+		}
+	}
+
+	Tee_SubTest(test_quantiles_of_signed_values) {
+		Mesi::QuantileSketch<Volts> sketch;
+		sketch.add(samples);
+		assert(sketch.quantile(0).val < -2.9f);
+		assert(sketch.quantile(1).val > 14.8f);
+		assert(Mesi::QuantileSketch<Volts>().quantile(0.5) == Volts(0));
+	}
+
+	Tee_SubTest(test_quantiles_of_non_finite_values) {
+		float const inf = std::numeric_limits<float>::infinity();
+		Mesi::QuantileSketch<Volts> sketch;
+		Mesi::QuantileSketch<Volts> other;
+		for(int i = 1; i <= 8; i++)
+		{
+			sketch.add(Volts(float(i)));
+		}
+		sketch.add(Volts(std::numeric_limits<float>::quiet_NaN()));
+		sketch.add(Volts(inf));
+		other.add(Volts(-inf));
+		sketch.merge(other);
+		assert(sketch.count() == 10);
+		assert(sketch.quantile(0) == Volts(-inf));
+		assert(sketch.quantile(1) == Volts(inf));
+		assert(std::fabs(sketch.quantile(0.5).val - 4) <= 0.04f);
+	}
+}
+
+Tee_Test(test_time_series_compression) {
+	using Time = Mesi::NanosecondTimestamps;
+	using Watts = Mesi::Watts;
+	std::vector<Time> times;
+	std::vector<Watts> values;
+	for(int i = 0; i < 2000; i++)
+	{
+		// Mostly regular sampling with occasional jitter and gaps
+		int64_t jitter = (i % 97 == 0) ? 5000 : (i % 13 == 0 ? -3 : 0);
+		times.push_back(Time(int64_t(1000000000) * 1700000000 + int64_t(i) * 1000000 + jitter + (i > 1500 ? 1000000000 : 0)));
+		values.push_back(Watts(float(int(1000 + 10 * std::sin(i * 0.01))) + (i % 7 == 0 ? 0.25f : 0.f)));
+	}
+	values[100] = Watts(-std::numeric_limits<float>::infinity());
+	values[101] = Watts(0);
+
+	Mesi::TimeSeriesEncoder<Watts> encoder;
+	encoder.append(times, values);
+
+	Tee_SubTest(test_round_trip) {
+		Mesi::TimeSeriesDecoder<Watts> decoder(encoder.words());
+		assert(decoder.valid());
+		assert(decoder.remaining() == times.size());
+		std::vector<Time> outTimes(times.size());
+		std::vector<Watts> outValues(values.size());
+		assert(decoder.decode(outTimes, outValues) == times.size());
+		assert(decoder.remaining() == 0);
+		for(std::size_t i = 0; i < times.size(); i++)
+		{
+			assert(outTimes[i] == times[i]);
+			assert(std::memcmp(&outValues[i], &values[i], sizeof(Watts)) == 0);
+		}
+	}
+
+	Tee_SubTest(test_decoding_in_blocks) {
+		Mesi::TimeSeriesDecoder<Watts> decoder(encoder.words());
+		Time t[300];
+		Watts v[300];
+		std::size_t total = 0;
+		while(std::size_t n = decoder.decode(t, v))
+		{
+			for(std::size_t i = 0; i < n; i++)
+			{
+				assert(t[i] == times[total + i]);
+			}
+			total += n;
+		}
+		assert(total == times.size());
+	}
+
+	Tee_SubTest(test_streams_compress) {
+		assert(encoder.sizeInBytes() * 3 < times.size() * (sizeof(Time) + sizeof(Watts)));
+	}
+
+	Tee_SubTest(test_header_checks_types) {
+		assert(!(Mesi::TimeSeriesDecoder<Mesi::Volts>(encoder.words()).valid()));
+		assert(!(Mesi::TimeSeriesDecoder<Mesi::Kilo<Watts>>(encoder.words()).valid()));
+		assert(!(Mesi::TimeSeriesDecoder<Watts, Mesi::Micro<Mesi::Type<int64_t, 0, 1, 0>>>(encoder.words()).valid()));
+		assert(Mesi::TimeSeriesDecoder<Watts>(encoder.words()).valid());
+		assert(!(Mesi::TimeSeriesDecoder<Watts>(Mesi::Span<uint64_t const>()).valid()));
+	}
+
+	Tee_SubTest(test_damaged_blocks_stay_in_bounds) {
+		std::vector<Time> t(times.size());
+		std::vector<Watts> v(values.size());
+
+		// Cut off mid-stream: decodes what is there, then stops
+		std::vector<uint64_t> truncated(encoder.words().begin(), encoder.words().end());
+		truncated.resize(truncated.size() / 2);
+		Mesi::TimeSeriesDecoder<Watts> cut(truncated);
+		std::size_t const n = cut.decode(t, v);
+		assert(!cut.valid() && cut.remaining() == 0);
+		assert(n > 0 && n < times.size());
+		for(std::size_t i = 0; i < n; i++)
+		{
+			assert(t[i] == times[i]);
+		}
+
+		// A count the payload can't hold is rejected up front
+		std::vector<uint64_t> inflated(encoder.words().begin(), encoder.words().end());
+		inflated[Mesi::_internal::TimeSeriesHeader<Watts, Time>::count_word] = UINT64_MAX;
+		Mesi::TimeSeriesDecoder<Watts> liar(inflated);
+		assert(!liar.valid() && liar.decode(t, v) == 0);
+
+		// Random payload bits never read past the end
+		std::vector<uint64_t> noise(encoder.words().begin(), encoder.words().end());
+		uint64_t state = 99;
+		for(std::size_t i = Mesi::_internal::TimeSeriesHeader<Watts, Time>::size; i < noise.size(); i++)
+		{
+			state = state * 6364136223846793005u + 1442695040888963407u;
+			noise[i] = state;
+		}
+		Mesi::TimeSeriesDecoder<Watts> garbled(noise);
+		assert(garbled.decode(t, v) <= times.size());
+	}
+
+	Tee_SubTest(test_double_values) {
+		Mesi::TimeSeriesEncoder<Mesi::Type<double, 0, 0, 0, 0, 1>> doubles;
+		for(int i = 0; i < 100; i++)
+		{
+			doubles.append(Time(int64_t(i * i)), Mesi::Type<double, 0, 0, 0, 0, 1>(300 + 1e-9 * i));
+		}
+		Mesi::TimeSeriesDecoder<Mesi::Type<double, 0, 0, 0, 0, 1>> decoder(doubles.words());
+		std::vector<Time> t(100);
+		std::vector<Mesi::Type<double, 0, 0, 0, 0, 1>> v(100);
+		assert(decoder.decode(t, v) == 100);
+		for(int i = 0; i < 100; i++)
+		{
+			assert(t[i].val == i * i);
+			assert(v[i].val == 300 + 1e-9 * i);
+		}
+	}
+}
+
+Tee_Test(test_quantized) {
+	using Volts = Mesi::Volts;
+	using Kelvin = Mesi::Kelvin;
+	using Volts8 = Mesi::Quantized<Volts, uint8_t, std::ratio<0>, std::ratio<5>>;
+	using Kelvin16 = Mesi::Quantized<Kelvin, int16_t, std::ratio<200>, std::ratio<400>>;
+
+	Tee_SubTest(test_footprint) {
+		assert(sizeof(Volts8) == 1);
+		assert(sizeof(Kelvin16) == 2);
+	}
+
+	Tee_SubTest(test_round_trip_error_is_within_half_a_step) {
+		for(int i = 0; i <= 1000; i++)
+		{
+			Volts v(5.f * i / 1000);
+			assert(std::fabs(Volts8(v).decode().val - v.val) <= Volts8::step().val / 2 + 1e-6f);
+			Kelvin k(200.f + 200.f * i / 1000);
+			assert(std::fabs(Kelvin16(k).decode().val - k.val) <= Kelvin16::step().val / 2 + 1e-4f);
+		}
+		assert(Volts8(Volts(0)).code == 0);
+		assert(Volts8(Volts(5)).code == 255);
+		assert(Kelvin16(Kelvin(200)).code == -32768);
+		assert(Kelvin16(Kelvin(400)).code == 32767);
+	}
+
+	Tee_SubTest(test_out_of_range_values_clamp) {
+		assert(Volts8(Volts(-1)).decode() == Volts8::min());
+		assert(Volts8(Volts(7)).decode() == Volts8::max());
+	}
+
+	Tee_SubTest(test_codes_wider_than_the_mantissa) {
+		// 2^32 - 1 levels don't fit in a float, so the ends must not round
+		// past the top code and wrap
+		using VoltsU32 = Mesi::Quantized<Volts, uint32_t, std::ratio<0>, std::ratio<5>>;
+		using VoltsI32 = Mesi::Quantized<Volts, int32_t, std::ratio<0>, std::ratio<5>>;
+		using VoltsU64 = Mesi::Quantized<Volts, uint64_t, std::ratio<0>, std::ratio<5>>;
+		assert(VoltsU32(Volts(0)).code == 0);
+		assert(VoltsU32(Volts(5)).code == UINT32_MAX);
+		assert(VoltsU32(Volts(7)).code == UINT32_MAX);
+		assert(VoltsU32(VoltsU32::min()).decode() == VoltsU32::min());
+		assert(VoltsU32(VoltsU32::max()).decode() == VoltsU32::max());
+		assert(VoltsI32(Volts(0)).code == INT32_MIN);
+		assert(VoltsI32(Volts(5)).code == INT32_MAX);
+		assert(VoltsI32(VoltsI32::min()).decode() == VoltsI32::min());
+		assert(VoltsI32(VoltsI32::max()).decode() == VoltsI32::max());
+		assert(std::fabs(VoltsI32(Volts(2.5f)).decode().val - 2.5f) <= 1e-6f);
+		assert(VoltsU64(Volts(0)).code == 0);
+		assert(VoltsU64(Volts(5)).code == UINT64_MAX);
+		assert(VoltsU64(VoltsU64::max()).decode() == VoltsU64::max());
+	}
+
+	Tee_SubTest(test_bulk_matches_single) {
+		std::vector<Volts> in;
+		for(int i = 0; i < 100; i++)
+			in.push_back(Volts(0.05f * i));
+		std::vector<Volts8> codes(in.size());
+		std::vector<Volts> out(in.size());
+		Volts8::encode(in, codes);
+		Volts8::decode(codes, out);
+		for(std::size_t i = 0; i < in.size(); i++)
+		{
+			assert(codes[i] == Volts8(in[i]));
+			assert(out[i] == Volts8(in[i]).decode());
+		}
+	}
+
+	Tee_SubTest(test_arithmetic_decodes_to_the_quantity) {
+		Volts8 v(Volts(2));
+		auto power = v * Mesi::Amperes(3);
+		assert((std::is_same<decltype(power), Mesi::Watts>::value));
+		assert((std::is_same<decltype(v + v), Volts>::value));
+		assert((std::is_same<decltype(Volts(1) - v), Volts>::value));
+		assert((std::is_same<decltype(2 * v), Volts>::value));
+		assert(v + v == v.decode() * 2);
+		assert(Volts8(Volts(1)) < Volts8(Volts(2)));
+		assert(Volts(v) == v.decode());
+	}
+}
+
+Tee_Test(test_layout_and_views) {
+	using Meters = Mesi::Meters;
+
+	Tee_SubTest(test_trivially_copyable) {
+		assert(std::is_trivially_copyable<Meters>::value);
+		assert((std::is_trivially_copyable<Mesi::Type<double, 1, -2, 1>>::value));
+		assert(std::is_trivially_default_constructible<Meters>::value);
+		assert(std::is_standard_layout<Meters>::value);
+		assert(sizeof(Meters) == sizeof(float));
+
+		Meters in[3] = {Meters(1), Meters(2), Meters(3)};
+		Meters out[3];
+		std::memcpy(out, in, sizeof(in));
+		assert(out[0] == in[0] && out[1] == in[1] && out[2] == in[2]);
+	}
+
+	Tee_SubTest(test_value_initialisation_is_zero) {
+		constexpr Meters zero{};
+		assert(zero.val == 0);
+	}
+
+	Tee_SubTest(test_view_raw_buffer_as_quantities) {
+		float raw[4] = {1, 2, 3, 4};
+		Mesi::Span<Meters> metres = Mesi::view_as<Meters>(Mesi::Span<float>(raw));
+		assert(metres.size() == 4);
+		assert(static_cast<void*>(metres.data()) == static_cast<void*>(raw));
+		metres[1] += Meters(10);
+		assert(raw[1] == 12);
+	}
+
+	Tee_SubTest(test_view_quantities_as_raw_buffer) {
+		std::vector<Meters> metres(3, Meters(2));
+		Mesi::Span<float> raw = Mesi::view_as<float>(metres);
+		raw[2] = 5;
+		assert(metres[2] == Meters(5));
+	}
+
+	Tee_SubTest(test_view_keeps_constness) {
+		std::vector<float> const raw(2, 5.f);
+		auto metres = Mesi::view_as<Meters>(raw);
+		assert((std::is_same<decltype(metres), Mesi::Span<Meters const>>::value));
+		assert(metres[1] == Meters(5));
+	}
+}
+
+Tee_Test(test_atomic) {
+	using Joules = Mesi::Joules;
+	using Coulombs = Mesi::Type<int64_t, 0, 1, 0, 1>;
+
+	Tee_SubTest(test_atomic_operations) {
+		Mesi::Atomic<Joules> energy(Joules(1));
+		assert(energy.load() == Joules(1));
+		energy.store(Joules(2));
+		assert(energy.exchange(Joules(3)) == Joules(2));
+
+		Joules expected(1);
+		assert(!energy.compare_exchange_strong(expected, Joules(4)));
+		assert(expected == Joules(3));
+		assert(energy.compare_exchange_strong(expected, Joules(4)));
+		assert(energy.load() == Joules(4));
+
+		assert(energy.fetch_add(Joules(1.5)) == Joules(4));
+		assert(energy.fetch_sub(Joules(0.5)) == Joules(5.5));
+		assert((energy += Joules(1)) == Joules(6));
+		assert((energy -= Joules(2)) == Joules(4));
+		assert((std::is_same<decltype(energy.load()), Joules>::value));
+	}
+
+	Tee_SubTest(test_integer_atomic) {
+		Mesi::Atomic<Coulombs> charge(Coulombs(10));
+		assert(charge.fetch_add(Coulombs(5)) == Coulombs(10));
+		assert(charge.fetch_sub(Coulombs(20)) == Coulombs(15));
+		assert(charge.load() == Coulombs(-5));
+	}
+
+	Tee_SubTest(test_concurrent_accumulation) {
+		constexpr int threads = 4;
+		constexpr int additions = 10000;
+		Mesi::Atomic<Joules> energy(Joules(0));
+		Mesi::Atomic<Coulombs> charge(Coulombs(0));
+		Mesi::ShardedCounter<Joules, 2> sharded;
+		std::vector<std::thread> workers;
+		for(int t = 0; t < threads; t++)
+		{
+			workers.emplace_back([&] {
+				for(int i = 0; i < additions; i++)
+				{
+					energy.fetch_add(Joules(1));
+					charge.fetch_add(Coulombs(2));
+					sharded.add(Joules(1));
+				}
+			});
+		}
+		for(auto& w : workers)
+		{
+			w.join();
+		}
+		assert(energy.load() == Joules(threads * additions));
+		assert(charge.load() == Coulombs(2 * threads * additions));
+		assert(sharded.load() == Joules(threads * additions));
+
+		sharded.sub(Joules(1));
+		assert(sharded.load() == Joules(threads * additions - 1));
+		sharded.reset();
+		assert(sharded.load() == Joules(0));
+	}
+}
+
+Tee_Test(test_checked) {
+	using CheckedMeters = Mesi::Type<Mesi::Checked<float>, 1, 0, 0>;
+	using CheckedSeconds = Mesi::Type<Mesi::Checked<float>, 0, 1, 0>;
+	using CheckedCount = Mesi::Type<Mesi::Checked<int32_t>, 0, 0, 0>;
+	using Op = Mesi::CheckedOperation;
+	using Error = Mesi::CheckedError;
+	auto const& report = Mesi::CheckedFailures();
+
+	Tee_SubTest(test_checked_types) {
+		assert((std::is_trivially_copyable<CheckedMeters>::value));
+		assert(sizeof(CheckedMeters) == sizeof(float));
+		auto speed = CheckedMeters(4) / CheckedSeconds(2);
+		assert((std::is_same<decltype(speed), Mesi::Type<Mesi::Checked<float>, 1, -1, 0>>::value));
+		assert(speed.val == 2.f);
+		assert((std::is_same<decltype(CheckedMeters(1) * 2.0), Mesi::Type<Mesi::Checked<double>, 1, 0, 0>>::value));
+		assert((std::is_same<Mesi::DebugChecked<float>, Mesi::Checked<float>>::value == bool(MESI_CHECKED)));
+
+		Mesi::ResetCheckedFailures();
+		auto metres = Mesi::Kilo<CheckedMeters>(1.5f);
+		assert(float(CheckedMeters(metres).val) == 1500.f);
+		assert(std::sqrt(CheckedMeters(9) * CheckedMeters(4)).val == 6.f);
+		assert(report.total() == 0);
+		assert(!report.has_failed);
+	}
+
+	Tee_SubTest(test_checked_floating_point) {
+		Mesi::ResetCheckedFailures();
+		auto huge = CheckedMeters(3e38f) * 10.f;
+		assert(std::isinf(float(huge.val)));
+		assert(report.count(Op::Multiply, Error::Infinity) == 1);
+
+		// Only the operation that created the infinity is reported
+		auto still_huge = huge + CheckedMeters(1);
+		(void)still_huge;
+		assert(report.total() == 1);
+
+		auto zero = CheckedMeters(0);
+		auto ratio = zero / zero;
+		assert(std::isnan(float(ratio.val.val)));
+		assert(report.count(Op::Divide, Error::DivideByZero) == 1);
+
+		auto root = std::sqrt(CheckedMeters(-4) * CheckedMeters(1));
+		(void)root;
+		assert(report.count(Op::Function, Error::NaN) == 1);
+		assert(report.count(Error::NaN) == 1);
+		assert(report.total() == 3);
+
+		assert(report.has_failed);
+		assert(report.first_operation == Op::Multiply);
+		assert(report.first_error == Error::Infinity);
+		assert(report.first_left == double(3e38f));
+		assert(report.first_right == 10.0);
+	}
+
+	Tee_SubTest(test_checked_integers) {
+		Mesi::ResetCheckedFailures();
+		auto big = CheckedCount(2000000000);
+		assert((big - big).val == 0);
+		assert(report.total() == 0);
+		auto wrapped = big + big;
+		assert(wrapped.val == int32_t(uint32_t(4000000000u)));
+		assert(report.count(Op::Add, Error::Overflow) == 1);
+		(void)(big * CheckedCount(2));
+		(void)(-big - big);
+		assert(report.count(Op::Multiply, Error::Overflow) == 1);
+		assert(report.count(Op::Subtract, Error::Overflow) == 1);
+		(void)(big / CheckedCount(0));
+		assert(report.count(Op::Divide, Error::DivideByZero) == 1);
+		auto min = Mesi::Checked<int32_t>(std::numeric_limits<int32_t>::min());
+		(void)(min / -1);
+		(void)(-min);
+		assert(report.count(Op::Divide, Error::Overflow) == 1);
+		assert(report.count(Op::Negate, Error::Overflow) == 1);
+		assert(report.total() == 6);
+
+		Mesi::ResetCheckedFailures();
+		Mesi::Checked<int8_t> narrow(300);
+		Mesi::Checked<uint8_t> unsigned_narrow(-1);
+		Mesi::Checked<int32_t> from_nan(std::numeric_limits<float>::quiet_NaN());
+		(void)narrow; (void)unsigned_narrow; (void)from_nan;
+		assert(report.count(Op::Convert, Error::Overflow) == 2);
+		assert(report.count(Op::Convert, Error::NaN) == 1);
+		assert(int(Mesi::Checked<int32_t>(1e10f).val) == std::numeric_limits<int32_t>::max());
+		assert(std::isinf(Mesi::Checked<float>(1e300).val));
+		Mesi::Checked<uint8_t> fits(255);
+		(void)fits;
+		assert(report.count(Op::Convert, Error::Overflow) == 4);
+	}
+
+	Tee_SubTest(test_checked_scopes) {
+		Mesi::ResetCheckedFailures();
+		{
+			Mesi::CheckedScope outer("outer");
+			{
+				Mesi::CheckedScope inner("inner");
+			}
+			(void)(CheckedMeters(1) / CheckedMeters(0));
+			Mesi::CheckedScope inner("inner");
+			(void)(CheckedMeters(2) / CheckedMeters(0));
+		}
+		assert(report.count(Op::Divide, Error::DivideByZero) == 2);
+		assert(std::string(report.first_scope) == "outer");
+		assert(report.first_left == 1.0);
+
+		// Failures are counted per thread
+		std::thread([] {
+			(void)(CheckedMeters(1) / CheckedMeters(0));
+			(void)(CheckedMeters(1) / CheckedMeters(0));
+			assert(Mesi::CheckedFailures().total() == 2);
+			assert(Mesi::CheckedFailures().first_scope == nullptr);
+		}).join();
+		assert(report.total() == 2);
+	}
+}
+
+Tee_Test(test_lookup_tables) {
+	using namespace Mesi::Literals;
+	using Kelvin = Mesi::Type<double, 0, 0, 0, 0, 1>;
+	using Pascals = Mesi::Type<double, -1, -2, 1>;
+	using Interpolation = Mesi::LutInterpolation;
+	// The Clausius-Clapeyron equation for water, referenced to its boiling point
+	auto vapourPressure = [](Kelvin t) {
+		return Pascals(101325) * std::exp(4883.0 * (1 / 373.15 - 1 / t.val));
+	};
+	auto relativeError = [&](auto const& table) {
+		double worst = 0;
+		for(double t = 280; t <= 370; t += 0.37)
+		{
+			double const exact = vapourPressure(Kelvin(t)).val;
+			worst = std::max(worst, std::abs(table(Kelvin(t)).val - exact) / exact);
+		}
+		return worst;
+	};
+
+	Tee_SubTest(test_uniform_tables) {
+		auto linear = Mesi::Lut<Kelvin, Pascals>::sample(vapourPressure, Kelvin(273), Kelvin(373), 256);
+		auto cubic = Mesi::Lut<Kelvin, Pascals, Interpolation::Cubic>::sample(vapourPressure, Kelvin(273), Kelvin(373), 256);
+		assert(linear.isUniform());
+		assert(linear.size() == 256);
+		assert(linear.min() == Kelvin(273));
+		assert(linear.max() == Kelvin(373));
+		assert((std::is_same<decltype(linear(Kelvin(300))), Pascals>::value));
+
+		assert(relativeError(linear) < 1e-4);
+		assert(relativeError(cubic) < 1e-6);
+		assert(std::abs(linear(Kelvin(373)).val - vapourPressure(Kelvin(373)).val) < 1e-6);
+
+		// Inputs beyond the ends give the values at the ends
+		assert(linear(Kelvin(200)) == vapourPressure(Kelvin(273)));
+		assert(cubic(Kelvin(400)) == vapourPressure(Kelvin(373)));
+	}
+
+	Tee_SubTest(test_non_uniform_tables) {
+		std::vector<Kelvin> inputs;
+		for(double t = 273; t < 373; t += 2 + (t - 273) / 20)
+		{
+			inputs.push_back(Kelvin(t));
+		}
+		inputs.push_back(Kelvin(373));
+		auto cubic = Mesi::Lut<Kelvin, Pascals, Interpolation::Cubic>::sample(vapourPressure, inputs);
+		assert(!cubic.isUniform());
+		assert(cubic.size() == inputs.size());
+		assert(relativeError(cubic) < 1e-3);
+		for(auto t : inputs)
+		{
+			assert(cubic(t) == vapourPressure(t));
+		}
+
+		// Cubic interpolation is exact for quadratics, however the inputs are spaced
+		Mesi::Seconds const times[] = {0_s, 0.5_s, 2_s, 2.25_s, 7_s};
+		auto fall = [](Mesi::Seconds t) { return Mesi::Type<float, 1, -2, 0>(4.9f) * t * t; };
+		auto distance = Mesi::Lut<Mesi::Seconds, Mesi::Meters, Interpolation::Cubic>::sample(fall, Mesi::Span<Mesi::Seconds const>(times));
+		for(float t = 0; t <= 7; t += 0.1f)
+		{
+			assert(std::abs(distance(Mesi::Seconds(t)).val - fall(Mesi::Seconds(t)).val) < 1e-3f);
+		}
+		Mesi::Meters const marks[] = {0_m, 1_m, 2_m, 3_m, 4_m};
+		auto linear = Mesi::Lut<Mesi::Seconds, Mesi::Meters>(times, marks);
+		assert(linear(1.25_s) == 1.5_m);
+		assert(linear(4.625_s) == 3.5_m);
+
+		// Entries too uneven for the index to separate them all
+		std::vector<Mesi::Seconds> uneven = {0_s};
+		for(float t = 1e-6f; t < 10; t *= 3)
+		{
+			uneven.push_back(Mesi::Seconds(t));
+		}
+		uneven.push_back(10_s);
+		auto logarithmic = Mesi::Lut<Mesi::Seconds, Mesi::Meters, Interpolation::Cubic>::sample(fall, uneven);
+		std::vector<Mesi::Seconds> queries;
+		for(float t = 0; t <= 10; t += 0.01f)
+		{
+			queries.push_back(Mesi::Seconds(t));
+		}
+		std::vector<Mesi::Meters> results(queries.size());
+		logarithmic(queries, results);
+		for(std::size_t i = 0; i < queries.size(); i++)
+		{
+			assert(results[i] == logarithmic(queries[i]));
+			assert(std::abs(results[i].val - fall(queries[i]).val) < 1e-3f * (1 + results[i].val));
+		}
+	}
+
+	Tee_SubTest(test_table_batches_and_scales) {
+		// Functions may return another scale of the output type
+		auto kilometres = [](Mesi::Seconds t) { return Mesi::Kilo<Mesi::Meters>(t.val); };
+		auto table = Mesi::Lut<Mesi::Seconds, Mesi::Meters>::sample(kilometres, 0_s, 10_s, 11);
+		assert(table(2.5_s) == 2500_m);
+
+		std::vector<Kelvin> temperatures;
+		for(int i = 0; i < 200; i++)
+		{
+			temperatures.push_back(Kelvin(260 + i * 0.6));
+		}
+		auto uniform = Mesi::Lut<Kelvin, Pascals, Interpolation::Cubic>::sample(vapourPressure, Kelvin(273), Kelvin(373), 100);
+		auto nonUniform = Mesi::Lut<Kelvin, Pascals>::sample(vapourPressure, Mesi::Span<Kelvin const>(temperatures.data() + 10, 150));
+		std::vector<Pascals> pressures(temperatures.size());
+		uniform(temperatures, pressures);
+		for(std::size_t i = 0; i < temperatures.size(); i++)
+		{
+			assert(pressures[i] == uniform(temperatures[i]));
+		}
+		nonUniform(temperatures, pressures);
+		for(std::size_t i = 0; i < temperatures.size(); i++)
+		{
+			assert(pressures[i] == nonUniform(temperatures[i]));
+		}
+	}
+}
+
+Tee_Test(test_polynomials) {
+	using namespace Mesi::Literals;
+	using Ohms = decltype(Mesi::Volts{} / Mesi::Amperes{});
+	using Celsius = Mesi::Kelvin;
+	using Rtd = Mesi::Polynomial<Celsius, Ohms, 2>;
+
+	Tee_SubTest(test_coefficient_types) {
+		assert((std::is_same<Rtd::Coefficient<0>, Ohms>::value));
+		assert((std::is_same<Rtd::Coefficient<1>, decltype(Ohms{} / Celsius{})>::value));
+		assert((std::is_same<Rtd::Coefficient<2>, decltype(Ohms{} / (Celsius{} * Celsius{}))>::value));
+		// Scaled inputs give coefficients in the matching scale
+		using Distance = Mesi::Polynomial<Mesi::Kilo<Mesi::Meters>, Mesi::Seconds, 1>;
+		assert((std::is_same<Distance::Coefficient<1>, decltype(Mesi::Seconds{} / Mesi::Kilo<Mesi::Meters>{})>::value));
+		assert((std::is_same<decltype(Rtd{}(Celsius{})), Ohms>::value));
+	}
+
+	Tee_SubTest(test_constant_evaluation) {
+		constexpr Rtd pt100(Ohms(100), Rtd::Coefficient<1>(0.39083f), Rtd::Coefficient<2>(-5.775e-5f));
+		static_assert(pt100(Celsius(0)) == Ohms(100), "Polynomials can be evaluated at compile time");
+		assert(std::abs(pt100(Celsius(100)).val - 138.5055f) < 1e-3f);
+		assert(pt100.coefficient<1>() == Rtd::Coefficient<1>(0.39083f));
+
+		constexpr auto position = Mesi::make_polynomial<Mesi::Seconds>(1_m, 2_m / 1_s, 3_m / (1_s * 1_s),
+			4_m / (1_s * 1_s * 1_s), 5_m / (1_s * 1_s * 1_s * 1_s));
+		static_assert(std::is_same<decltype(position(1_s)), Mesi::Meters>::value, "");
+		static_assert(decltype(position)::c_degree == 4, "");
+		static_assert(position(2_s) == Mesi::Meters(1 + 4 + 12 + 32 + 80), "");
+		static_assert(position.estrin(2_s) == Mesi::Meters(1 + 4 + 12 + 32 + 80), "");
+
+		// Coefficients are converted to the scale of the constant term
+		constexpr auto pace = Mesi::make_polynomial<Mesi::Kilo<Mesi::Meters>>(10_s, 1_s / 1_m);
+		static_assert(pace(Mesi::Kilo<Mesi::Meters>(2)) == 2010_s, "");
+	}
+
+	Tee_SubTest(test_horner_and_estrin) {
+		// Degrees either side of powers of two exercise Estrin's splitting
+		auto check = [](auto const& poly, float x) {
+			return std::abs(poly(Mesi::Scalar(x)).val - poly.estrin(Mesi::Scalar(x)).val) < 1e-5f;
+		};
+		auto const s = [](float v) { return Mesi::Scalar(v); };
+		for(float x = -2; x <= 2; x += 0.25f)
+		{
+			assert(check(Mesi::make_polynomial<Mesi::Scalar>(s(1)), x));
+			assert(check(Mesi::make_polynomial<Mesi::Scalar>(s(1), s(-0.5f)), x));
+			assert(check(Mesi::make_polynomial<Mesi::Scalar>(s(1), s(-0.5f), s(0.25f)), x));
+			assert(check(Mesi::make_polynomial<Mesi::Scalar>(s(1), s(-0.5f), s(0.25f), s(-0.125f), s(0.0625f)), x));
+			assert(check(Mesi::make_polynomial<Mesi::Scalar>(s(1), s(-0.5f), s(0.25f), s(-0.125f), s(0.0625f),
+				s(-0.03125f), s(0.015625f), s(-0.0078125f), s(0.00390625f)), x));
+		}
+		// 1 + x + x^2 + ... + x^8 at x = 2
+		auto const geometric = Mesi::make_polynomial<Mesi::Scalar>(s(1), s(1), s(1), s(1), s(1), s(1), s(1), s(1), s(1));
+		assert(geometric(s(2)) == s(511));
+		assert(geometric.estrin(s(2)) == s(511));
+	}
+
+	Tee_SubTest(test_polynomial_batches) {
+		using Counts = Mesi::Type<int32_t, 0, 0, 0>;
+		// An ADC reading 0-4095 for 0-3.3 V, with a small nonlinearity
+		auto const adc = Mesi::make_polynomial<Counts>(Mesi::Volts(0.01f),
+			Mesi::Volts(3.3f / 4095), Mesi::Volts(-1e-9f));
+		assert((std::is_same<decltype(adc(Counts(0))), Mesi::Volts>::value));
+		std::vector<Counts> readings;
+		for(int32_t i = 0; i < 4096; i += 3)
+		{
+			readings.push_back(Counts(i));
+		}
+		std::vector<Mesi::Volts> volts(readings.size());
+		adc(readings, volts);
+		for(std::size_t i = 0; i < readings.size(); i++)
+		{
+			assert(volts[i] == adc(readings[i]));
+		}
+		assert(std::abs(adc(Counts(4095)).val - (0.01f + 3.3f - 1e-9f * 4095 * 4095)) < 1e-5f);
+	}
+}
+
+Tee_Test(test_calculus) {
+	using namespace Mesi::Literals;
+	using Speed = decltype(Mesi::Meters{} / Mesi::Seconds{});
+	using WattsPerSecond = decltype(Mesi::Watts{} / Mesi::Seconds{});
+	// Power rising as a quadratic, sampled at uneven times
+	auto power = [](float t) { return Mesi::Watts(3 * t * t + 2 * t + 1); };
+	auto energy = [](float t) { return Mesi::Joules(t * t * t + t * t + t); };
+	std::vector<Mesi::Seconds> times;
+	std::vector<Mesi::Watts> samples;
+	for(int i = 0; i <= 10; i++)
+	{
+		float const t = i * i * 0.1f;
+		times.push_back(Mesi::Seconds(t));
+		samples.push_back(power(t));
+	}
+
+	Tee_SubTest(test_integration) {
+		assert((std::is_same<decltype(Mesi::trapezoid(samples, times)), Mesi::Joules>::value));
+		assert((std::is_same<decltype(Mesi::simpson(samples, 1_s)), Mesi::Joules>::value));
+		// Simpson's rule is exact for quadratics, with any spacing or count
+		assert(std::abs(Mesi::simpson(samples, times).val - energy(10).val) < 1e-3f);
+		auto const few = Mesi::Span<Mesi::Watts const>(samples.data(), 4);
+		assert(std::abs(Mesi::simpson(few, Mesi::Span<Mesi::Seconds const>(times.data(), 4)).val - energy(0.9f).val) < 1e-5f);
+		assert(std::abs(Mesi::trapezoid(samples, times).val - energy(10).val) < 15);
+
+		// The trapezoid rule is exact for straight lines
+		Mesi::Meters const ramp[] = {0_m, 1_m, 2_m, 3_m, 4_m};
+		assert((Mesi::trapezoid(ramp, 0.5_s) == Mesi::Meters(4) * 1_s));
+		assert((Mesi::simpson(ramp, 0.5_s) == Mesi::Meters(4) * 1_s));
+		assert((Mesi::trapezoid(Mesi::Span<Mesi::Meters const>(ramp, 2), 0.5_s) == Mesi::Meters(0.25f) * 1_s));
+		assert((Mesi::trapezoid(Mesi::Span<Mesi::Meters const>(ramp, 1), 0.5_s) == Mesi::Meters(0) * 1_s));
+
+		std::vector<Mesi::Joules> cumulative(samples.size());
+		Mesi::cumulative_simpson(samples, times, cumulative);
+		for(std::size_t i = 0; i < samples.size(); i++)
+		{
+			assert(std::abs(cumulative[i].val - energy(times[i].val).val) < 1e-3f);
+		}
+		Mesi::cumulative_trapezoid(samples, times, cumulative);
+		assert(cumulative[0] == 0_j);
+		assert(cumulative.back() == Mesi::trapezoid(samples, times));
+
+		// A single sample has no intervals, so its running total stays at zero
+		Mesi::Joules single[] = {1_j};
+		Mesi::cumulative_trapezoid(std::vector<Mesi::Watts>{5_w}, std::vector<Mesi::Seconds>{1_s}, single);
+		assert(single[0] == 0_j);
+		single[0] = 1_j;
+		Mesi::cumulative_simpson(Mesi::Span<Mesi::Watts const>(samples.data(), 1), 1_s, single);
+		assert(single[0] == 0_j);
+	}
+
+	Tee_SubTest(test_differentiation) {
+		std::vector<WattsPerSecond> slopes(samples.size());
+		Mesi::gradient(samples, times, slopes);
+		for(std::size_t i = 0; i < samples.size(); i++)
+		{
+			assert(std::abs(slopes[i].val - (6 * times[i].val + 2)) < 1e-3f);
+		}
+
+		Mesi::Meters const positions[] = {0_m, 1_m, 4_m, 9_m, 16_m};
+		Speed speeds[5];
+		Mesi::gradient(positions, 1_s, speeds);
+		for(int i = 0; i < 5; i++)
+		{
+			assert(speeds[i] == Speed(2.f * i));
+		}
+		Mesi::gradient(Mesi::Span<Mesi::Meters const>(positions, 2), 1_s, speeds);
+		assert(speeds[0] == Speed(1) && speeds[1] == Speed(1));
+	}
+
+	Tee_SubTest(test_threaded_calculus) {
+		// Sums of small integers are exact, so threading can't change them
+		std::size_t const n = 1000003;
+		using Seconds = Mesi::Type<double, 0, 1, 0>;
+		using Watts = Mesi::Type<double, 2, -3, 1>;
+		using Joules = decltype(Watts{} * Seconds{});
+		std::vector<Watts> steady(n, Watts(2));
+		std::vector<Seconds> ticks(n);
+		for(std::size_t i = 0; i < n; i++)
+		{
+			steady[i] = Watts(double(i % 7));
+			ticks[i] = Seconds(double(i));
+		}
+		std::vector<Joules> serial(n), threaded(n);
+		Mesi::cumulative_trapezoid(steady, ticks, serial, 1);
+		for(unsigned threads : {2u, 3u, 8u})
+		{
+			Mesi::cumulative_trapezoid(steady, ticks, threaded, threads);
+			assert(threaded == serial);
+			Mesi::cumulative_trapezoid(steady, Seconds(1), threaded, threads);
+			assert(threaded == serial);
+			assert(Mesi::trapezoid(steady, ticks, threads) == serial.back());
+		}
+		double expected = 0;
+		for(std::size_t i = 1; i < n; i++)
+		{
+			expected += 0.5 * double(i % 7 + (i - 1) % 7);
+			if(i % 99991 == 0)
+			{
+				assert(serial[i] == Joules(expected));
+			}
+		}
+		assert(serial.back() == Joules(expected));
+
+		std::vector<decltype(Watts{} / Seconds{})> serial_slopes(n), threaded_slopes(n);
+		Mesi::gradient(steady, ticks, serial_slopes, 1);
+		Mesi::gradient(steady, ticks, threaded_slopes, 4);
+		assert(serial_slopes == threaded_slopes);
+	}
+}
+
+template<typename T, typename = bool>
+struct IsOrderable : std::false_type {};
+
+template<typename T>
+struct IsOrderable<T, decltype(std::declval<T>() < std::declval<T>())> : std::true_type {};
+
+Tee_Test(test_complex) {
+	using Complex = std::complex<float>;
+	using ComplexVolts = Mesi::Type<Complex, 2, -3, 1, -1>;
+	using ComplexAmperes = Mesi::Type<Complex, 0, 0, 0, 1>;
+	using ComplexOhms = Mesi::Type<Complex, 2, -3, 1, -2>;
+	ComplexVolts const voltage(Complex(3, 4));
+	ComplexAmperes const current(Complex(0, 1));
+
+	Tee_SubTest(test_arithmetic) {
+		auto const impedance = voltage / current;
+		assert((std::is_same<decltype(impedance), ComplexOhms const>::value));
+		assert(impedance == ComplexOhms(Complex(4, -3)));
+		assert(impedance * current == voltage);
+		assert(voltage + voltage == ComplexVolts(Complex(6, 8)));
+		assert(voltage != ComplexVolts(Complex(3, -4)));
+		assert(!IsOrderable<ComplexVolts>::value);
+		assert(IsOrderable<Mesi::Volts>::value);
+	}
+
+	Tee_SubTest(test_real_parts) {
+		assert((std::is_same<decltype(Mesi::magnitude(voltage)), Mesi::Volts>::value));
+		assert((std::is_same<decltype(std::abs(voltage)), Mesi::Volts>::value));
+		assert((std::is_same<decltype(Mesi::phase(voltage)), Mesi::Scalar>::value));
+		assert((std::is_same<decltype(Mesi::norm(voltage)), decltype(Mesi::Volts{} * Mesi::Volts{})>::value));
+		assert(Mesi::magnitude(voltage) == Mesi::Volts(5));
+		assert(std::abs(voltage) == Mesi::Volts(5));
+		assert(std::abs(Mesi::phase(voltage).val - std::atan2(4.0f, 3.0f)) < 1e-6f);
+		assert(Mesi::real(voltage) == Mesi::Volts(3));
+		assert(Mesi::imag(voltage) == Mesi::Volts(4));
+		assert(Mesi::norm(voltage).val == 25);
+		assert(Mesi::conj(voltage) == ComplexVolts(Complex(3, -4)));
+
+		ComplexVolts const back = Mesi::polar(Mesi::magnitude(voltage), Mesi::phase(voltage));
+		assert(std::abs(back.val - voltage.val) < 1e-5f);
+	}
+
+	Tee_SubTest(test_scales_and_roots) {
+		Mesi::Milli<ComplexVolts> const milli(voltage);
+		assert(milli.val == Complex(3000, 4000));
+		assert(std::abs(ComplexVolts(milli).val - voltage.val) < 1e-6f);
+
+		using Length = Mesi::Type<Complex, 1, 0, 0>;
+		using Area = Mesi::Type<Complex, 2, 0, 0>;
+		Length const side(Complex(3, 4));
+		auto const root = std::sqrt(side * side);
+		assert((std::is_same<decltype(root), Length const>::value));
+		assert(std::abs(root.val - side.val) < 1e-5f);
+		assert(std::abs(std::cbrt(side * side * side).val - side.val) < 1e-4f);
+		assert((std::is_same<decltype(side * side), Area>::value));
+	}
+
+	Tee_SubTest(test_batch) {
+		std::size_t const n = 1001;
+		std::vector<ComplexVolts> voltages(n);
+		std::vector<ComplexAmperes> currents(n);
+		for(std::size_t i = 0; i < n; i++)
+		{
+			voltages[i] = ComplexVolts(Complex(float(i % 13) - 6, float(i % 7) + 0.5f));
+			currents[i] = ComplexAmperes(Complex(float(i % 5) + 1, float(i % 11) - 5));
+		}
+		std::vector<ComplexOhms> impedances(n);
+		Mesi::divide(voltages, currents, impedances);
+		std::vector<ComplexVolts> products(n);
+		Mesi::multiply(impedances, currents, products);
+		for(std::size_t i = 0; i < n; i++)
+		{
+			Complex const expected = voltages[i].val / currents[i].val;
+			assert(std::abs(impedances[i].val - expected) <= 1e-6f * std::abs(expected));
+			assert(std::abs(products[i].val - impedances[i].val * currents[i].val) <= 1e-6f * std::abs(voltages[i].val));
+		}
+
+		// Only the common length is written
+		std::vector<ComplexOhms> short_out(3, ComplexOhms(Complex(7, 7)));
+		Mesi::divide(Mesi::Span<ComplexVolts const>(voltages.data(), 2), currents, short_out);
+		assert(short_out[1] == ComplexOhms(voltages[1].val / currents[1].val));
+		assert(short_out[2] == ComplexOhms(Complex(7, 7)));
+	}
+}
+
+Tee_Test(test_angles) {
+	using Angle = Mesi::Angle<>;
+	using Radians = Mesi::Type<double, 0, 0, 0>;
+	// The exact angle of a code, in radians
+	auto exact = [](auto const angle) {
+		using Signed = typename std::make_signed<decltype(angle.code)>::type;
+		return (long double)(Signed(angle.code)) * 6.283185307179586476925286766559L
+			/ std::pow(2.0L, std::numeric_limits<decltype(angle.code)>::digits);
+	};
+	auto distance = [](long double a, long double b) {
+		long double const d = std::remainder(a - b, 6.283185307179586476925286766559L);
+		return std::fabs(d);
+	};
+
+	Tee_SubTest(test_wrapping) {
+		assert(Angle::fromTurns(0.25).code == 1u << 30);
+		assert(Angle::fromTurns(-0.25).code == 3u << 30);
+		assert(Angle::fromTurns(1.75) == Angle::fromTurns(-0.25));
+		assert(Angle(Mesi::Scalar(-1.0f)) == -Angle(Mesi::Scalar(1.0f)));
+		assert(Angle::fromTurns(0.5) + Angle::fromTurns(0.5) == Angle::fromCode(0));
+		assert(Angle::fromTurns(0.125) - Angle::fromTurns(0.25) == Angle::fromTurns(-0.125));
+		Angle heading(Mesi::Scalar(3.1f));
+		heading += Angle(Mesi::Scalar(0.1f));
+		assert(std::abs(heading.radians().val - (3.2f - 6.2831853f)) < 1e-6f);
+		heading -= Angle(Mesi::Scalar(0.1f));
+		assert(heading != Angle(Mesi::Scalar(-3.1f)));
+		assert(std::abs(heading.radians().val - 3.1f) < 1e-6f);
+
+		// Radians come back in [-pi, pi), and large inputs keep their
+		// accuracy
+		double const pi = 3.14159265358979323846;
+		assert(Angle::fromTurns(0.5).radians<double>().val == -pi);
+		assert(std::abs(Radians(Angle(Radians(1e6))).val - std::remainder(1e6, 2 * pi)) < 2e-9);
+		assert(Mesi::Angle<uint8_t>::fromTurns(0.75).code == 192);
+		assert(Mesi::Angle<uint64_t>::fromTurns(0.25).code == uint64_t(1) << 62);
+		assert(Mesi::Angle<uint64_t>::fromTurns(-0.25).code == uint64_t(3) << 62);
+	}
+
+	Tee_SubTest(test_trigonometry) {
+		assert((std::is_same<decltype(Mesi::sin(Angle())), Mesi::Scalar>::value));
+		assert((std::is_same<decltype(Mesi::cos<double>(Angle())), Radians>::value));
+		assert(Mesi::sin(Angle::fromTurns(0.25)).val == 1);
+		assert(Mesi::cos(Angle::fromTurns(0.5)).val == -1);
+		assert(Mesi::sin(Angle::fromCode(0)).val == 0);
+
+		double float_error = 0, double_error = 0, wide_error = 0;
+		uint32_t code = 12345;
+		for(int i = 0; i < 200000; i++)
+		{
+			code = code * 1664525u + 1013904223u;
+			Angle const angle = Angle::fromCode(code);
+			long double const x = exact(angle);
+			float_error = std::max(float_error, double(std::fabs(Mesi::sin(angle).val - std::sin(x))));
+			float_error = std::max(float_error, double(std::fabs(Mesi::cos(angle).val - std::cos(x))));
+			double_error = std::max(double_error, double(std::fabs(Mesi::sin<double>(angle).val - std::sin(x))));
+			double_error = std::max(double_error, double(std::fabs(Mesi::cos<double>(angle).val - std::cos(x))));
+			auto const wide = Mesi::Angle<uint64_t>::fromCode(uint64_t(code) << 32 | code);
+			wide_error = std::max(wide_error, double(std::fabs(Mesi::sin<double>(wide).val - std::sin(exact(wide)))));
+		}
+		assert(float_error < 1.5e-7);
+		assert(double_error < 1e-15);
+		assert(wide_error < 1e-15);
+	}
+
+	Tee_SubTest(test_atan2) {
+		using namespace Mesi::Literals;
+		assert(Angle::atan2(1_m, 0_m) == Angle::fromTurns(0.25));
+		assert(Angle::atan2(0_m, -1_m) == Angle::fromTurns(0.5));
+		assert(Angle::atan2(-1_m, 0_m) == Angle::fromTurns(-0.25));
+		assert(Angle::atan2(0_m, 0_m) == Angle::fromCode(0));
+		assert(Angle::atan2(-2_m, -2_m) == Angle::fromTurns(-0.375));
+
+		double float_error = 0, double_error = 0;
+		for(int i = 0; i < 100000; i++)
+		{
+			double const y = std::sin(i * 0.37) * (1 + i % 100);
+			double const x = std::cos(i * 0.37) * (1 + i % 100);
+			long double const expected = std::atan2((long double)y, (long double)x);
+			Angle const single = Angle::atan2(Mesi::Scalar(float(y)), Mesi::Scalar(float(x)));
+			float_error = std::max(float_error, double(distance(exact(single),
+				std::atan2((long double)float(y), (long double)float(x)))));
+			auto const wide = Mesi::Angle<uint64_t>::atan2(Radians(y), Radians(x));
+			double_error = std::max(double_error, double(distance(exact(wide), expected)));
+		}
+		assert(float_error < 1.5e-7);
+		assert(double_error < 1e-15);
+
+		// The direction survives the round trip through sin and cos
+		Angle const bearing = Angle::fromCode(0x9abcdef0u);
+		Angle const back = Angle::atan2(Mesi::sin<double>(bearing), Mesi::cos<double>(bearing));
+		assert(back.code - bearing.code + 1 <= 2);
+	}
+
+	Tee_SubTest(test_batch) {
+		std::size_t const n = 1003;
+		std::vector<Angle> angles(n);
+		std::vector<Mesi::Meters> ys(n), xs(n);
+		for(std::size_t i = 0; i < n; i++)
+		{
+			angles[i] = Angle::fromCode(uint32_t(i * 4282345u));
+			ys[i] = Mesi::Meters(float(i % 17) - 8);
+			xs[i] = Mesi::Meters(float(i % 23) - 11);
+		}
+		std::vector<Mesi::Scalar> sines(n), cosines(n);
+		std::vector<Radians> wide_sines(n);
+		std::vector<Angle> headings(n);
+		Mesi::sin(angles, sines);
+		Mesi::cos(angles, cosines);
+		Mesi::sin(angles, wide_sines);
+		Mesi::atan2(ys, xs, headings);
+		for(std::size_t i = 0; i < n; i++)
+		{
+			assert(sines[i] == Mesi::sin(angles[i]));
+			assert(cosines[i] == Mesi::cos(angles[i]));
+			assert(wide_sines[i] == Mesi::sin<double>(angles[i]));
+			assert(headings[i] == Angle::atan2(ys[i], xs[i]));
+		}
+	}
+}
+
+Tee_Test(test_fields) {
+	using namespace Mesi::Literals;
+	using PressureGradient = decltype(Mesi::Pascals{} / Mesi::Meters{});
+	using Curvature = decltype(Mesi::Kelvin{} / (Mesi::Meters{} * Mesi::Meters{}));
+
+	Tee_SubTest(test_indexing_and_halo) {
+		Mesi::Field<Mesi::Kelvin, 3> field({2, 3, 4}, Mesi::Kelvin(-1));
+		assert(field.size() == 24);
+		assert((field.extents() == std::array<std::size_t, 3>{{2, 3, 4}}));
+		assert(field(-1, 3, 4) == Mesi::Kelvin(-1));
+		for(int z = 0; z < 2; z++)
+			for(int y = 0; y < 3; y++)
+				for(int x = 0; x < 4; x++)
+					field(z, y, x) = Mesi::Kelvin(float(100 * z + 10 * y + x));
+		assert(field.at({{1, 2, 3}}) == Mesi::Kelvin(123));
+		assert(field.baseData()[field.offset({{1, 2, 3}})] == 123);
+		assert(field.strides()[2] == 1);
+
+		field.wrapHalo();
+		assert(field(0, 0, -1) == Mesi::Kelvin(3));
+		assert(field(0, 3, 0) == Mesi::Kelvin(0));
+		assert(field(-1, -1, -1) == Mesi::Kelvin(123));
+		assert(field(2, 3, 4) == Mesi::Kelvin(0));
+		assert(field(2, -1, 1) == Mesi::Kelvin(21));
+
+		field.extendHalo();
+		assert(field(0, 0, -1) == Mesi::Kelvin(0));
+		assert(field(-1, -1, -1) == Mesi::Kelvin(0));
+		assert(field(2, 3, 4) == Mesi::Kelvin(123));
+		assert(field(1, -1, 4) == Mesi::Kelvin(103));
+
+		field.fillHalo(Mesi::Kelvin(7));
+		assert(field(-1, 1, 1) == Mesi::Kelvin(7));
+		assert(field(1, 1, 4) == Mesi::Kelvin(7));
+		assert(field(1, 1, 1) == Mesi::Kelvin(111));
+	}
+
+	Tee_SubTest(test_stencils) {
+		// p = 3x - 2y + y^2 over a 2D grid with 0.5 m cells
+		std::size_t const ny = 6, nx = 9;
+		Mesi::Field<Mesi::Pascals, 2> pressure({ny, nx});
+		auto exact = [](float y, float x) { return 3 * x - 2 * y + y * y; };
+		for(std::size_t y = 0; y < ny; y++)
+			for(std::size_t x = 0; x < nx; x++)
+				pressure(y, x) = Mesi::Pascals(exact(0.5f * y, 0.5f * x));
+		pressure.extendHalo();
+
+		std::array<Mesi::Field<PressureGradient, 2>, 2> gradient{{
+			Mesi::Field<PressureGradient, 2>({ny, nx}), Mesi::Field<PressureGradient, 2>({ny, nx})}};
+		Mesi::gradient(pressure, 0.5_m, gradient);
+		assert((std::is_same<decltype(gradient[0](0, 0)), PressureGradient&>::value));
+		assert(std::abs(gradient[1](3, 4).val - 3) < 1e-5f);
+		assert(std::abs(gradient[0](3, 4).val - (2 * 1.5f - 2)) < 1e-5f);
+		// The zero-gradient halo halves the difference at the edge
+		assert(std::abs(gradient[1](3, 0).val - 1.5f) < 1e-5f);
+
+		Mesi::Field<decltype(Mesi::Pascals{} / (Mesi::Meters{} * Mesi::Meters{})), 2> curvature({ny, nx});
+		Mesi::laplacian(pressure, 0.5_m, curvature);
+		assert(std::abs(curvature(2, 4).val - 2) < 1e-4f);
+
+		// Different spacings along each axis
+		Mesi::Field<Mesi::Kelvin, 3> temperature({4, 5, 6});
+		for(int z = 0; z < 4; z++)
+			for(int y = 0; y < 5; y++)
+				for(int x = 0; x < 6; x++)
+					temperature(z, y, x) = Mesi::Kelvin(float(z * z + 2 * y * y + 3 * x * x));
+		temperature.wrapHalo();
+		Mesi::Field<Curvature, 3> heat({4, 5, 6});
+		Mesi::laplacian(temperature, std::array<Mesi::Meters, 3>{{1_m, 2_m, 1_m}}, heat);
+		assert(std::abs(heat(1, 2, 3).val - (2 + 4.0f / 4 + 6)) < 1e-4f);
+
+		// A 1D field
+		Mesi::Field<Mesi::Meters, 1> position({5});
+		for(int t = 0; t < 5; t++)
+			position(t) = Mesi::Meters(float(t * t));
+		position.extendHalo();
+		Mesi::Field<decltype(Mesi::Meters{} / Mesi::Seconds{}), 1> speed({5});
+		Mesi::derivative<0>(position, 1_s, speed);
+		assert(speed(2) == Mesi::Meters(4) / 1_s);
+
+		// Outputs of the wrong size are resized rather than overrun
+		Mesi::Field<decltype(Mesi::Meters{} / Mesi::Seconds{}), 1> small({2});
+		Mesi::derivative<0>(position, 1_s, small);
+		assert(small.extents() == position.extents() && small(2) == speed(2));
+		Mesi::Field<Curvature, 3> unsized;
+		Mesi::laplacian(temperature, std::array<Mesi::Meters, 3>{{1_m, 2_m, 1_m}}, unsized);
+		assert(unsized.extents() == temperature.extents() && unsized(1, 2, 3) == heat(1, 2, 3));
+	}
+
+	Tee_SubTest(test_threads) {
+		std::size_t const n = 150;
+		Mesi::Field<Mesi::Kelvin, 3> temperature({n, n, n});
+		for(std::size_t z = 0; z < n; z++)
+			for(std::size_t y = 0; y < n; y++)
+				for(std::size_t x = 0; x < n; x++)
+					temperature(z, y, x) = Mesi::Kelvin(float((z * 31 + y * 17 + x * 7) % 101));
+		temperature.wrapHalo();
+		Mesi::Field<Curvature, 3> serial({n, n, n}), threaded({n, n, n});
+		Mesi::laplacian(temperature, 1_m, serial, 1);
+		for(unsigned threads : {2u, 3u, 8u})
+		{
+			threaded.fill(Curvature(-1));
+			Mesi::laplacian(temperature, 1_m, threaded, threads);
+			for(std::size_t z = 0; z < n; z += 7)
+				for(std::size_t y = 0; y < n; y++)
+					for(std::size_t x = 0; x < n; x++)
+						assert(threaded(z, y, x) == serial(z, y, x));
+		}
+		auto const expected = temperature(1, 2, 0) + temperature(1, 0, 0) + temperature(0, 1, 0) + temperature(2, 1, 0)
+			+ temperature(1, 1, n - 1) + temperature(1, 1, 1) - 6.0f * temperature(1, 1, 0);
+		assert(std::abs(serial(1, 1, 0).val - expected.val) < 1e-3f);
+	}
+}
+
+Tee_Test(test_sorted_index) {
+	using Meters = Mesi::Meters;
+	using Kilometers = Mesi::Kilo<Meters>;
+	using Milliseconds = Mesi::Milli<Mesi::Type<int32_t, 0, 1, 0>>;
+
+	// Readings with plenty of repeats, in no particular order
+	std::vector<Meters> altitudes(1000);
+	for(std::size_t i = 0; i < altitudes.size(); i++)
+	{
+		altitudes[i] = Meters(float((i * 7919) % 613) * 10);
+	}
+	Mesi::SortedIndex<Meters> const index(altitudes);
+
+	Tee_SubTest(test_bounds) {
+		assert(index.size() == altitudes.size());
+		for(std::size_t i = 1; i < index.size(); i++)
+		{
+			assert(index.values()[i - 1] <= index.values()[i]);
+			assert(index.values()[i] == altitudes[index.rows()[i]]);
+			if(index.values()[i - 1] == index.values()[i])
+			{
+				assert(index.rows()[i - 1] < index.rows()[i]);
+			}
+		}
+		for(float x = -15; x < 6200; x += 5)
+		{
+			std::size_t below = 0, not_above = 0;
+			for(Meters const& a : altitudes)
+			{
+				below += a.val < x;
+				not_above += a.val <= x;
+			}
+			assert(index.lowerBound(Meters(x)) == below);
+			assert(index.upperBound(Meters(x)) == not_above);
+		}
+		float const infinity = std::numeric_limits<float>::infinity();
+		assert(index.lowerBound(Meters(infinity)) == index.size());
+		assert(index.upperBound(Meters(-infinity)) == 0);
+	}
+
+	Tee_SubTest(test_ranges) {
+		// Bounds in kilometres are converted to metres
+		auto const rows = index.between(Kilometers(3), Kilometers(5));
+		std::size_t expected = 0;
+		for(std::size_t i = 0; i < altitudes.size(); i++)
+		{
+			expected += altitudes[i].val >= 3000 && altitudes[i].val <= 5000;
+		}
+		assert(rows.size() == expected);
+		for(std::size_t row : rows)
+		{
+			assert(altitudes[row] >= Meters(3000) && altitudes[row] <= Meters(5000));
+		}
+		assert(index.between(Meters(5000), Meters(3000)).empty());
+		assert(index.above(Kilometers(6.12f)).size() == 0);
+		assert(index.above(Kilometers(6.11f)).size() == index.size() - index.upperBound(Meters(6110)));
+		assert(index.below(Meters(0)).empty());
+		assert(index.below(Meters(10)).size() + index.above(Meters(0)).size() == index.size());
+
+		// Integer storage, with latencies above 20 ms
+		std::vector<Milliseconds> latencies = {Milliseconds(5), Milliseconds(25), Milliseconds(20), Milliseconds(40)};
+		Mesi::SortedIndex<Milliseconds> const slow(latencies);
+		auto const above = slow.above(Milliseconds(20));
+		assert(above.size() == 2 && above[0] == 1 && above[1] == 3);
+
+		Mesi::SortedIndex<Meters> const empty;
+		assert(empty.lowerBound(Meters(1)) == 0 && empty.between(Meters(0), Meters(1)).empty());
+		std::vector<Meters> const nothing;
+		Mesi::SortedIndex<Meters> const none(nothing);
+		assert(none.upperBound(Meters(1)) == 0);
+	}
+
+	Tee_SubTest(test_batch) {
+		std::vector<Meters> keys;
+		for(float x = -5; x < 6200; x += 3.5f)
+		{
+			keys.push_back(Meters(x));
+		}
+		std::vector<std::size_t> out(keys.size());
+		index.lowerBounds(keys, out);
+		for(std::size_t i = 0; i < keys.size(); i++)
+		{
+			assert(out[i] == index.lowerBound(keys[i]));
+		}
+	}
+}
+
+Tee_Test(test_queues) {
+	using Volts = Mesi::Type<float, 2, -3, 1, -1>;
+	// Counts as quantities, so each value can carry its producer and order
+	using Tagged = Mesi::Type<int64_t, 0, 0, 0, 1>;
+
+	Tee_SubTest(test_spsc) {
+		Mesi::SpscQueue<Volts> queue(5);
+		assert(queue.capacity() == 8 && queue.empty());
+		Volts v;
+		assert(!queue.pop(v));
+		// Several laps, so the positions wrap around the buffer
+		for(int lap = 0; lap < 3; lap++)
+		{
+			for(int i = 0; i < 8; i++)
+			{
+				assert(queue.push(Volts(float(lap * 8 + i))));
+			}
+			assert(!queue.push(Volts(0.0f)) && queue.size() == 8);
+			for(int i = 0; i < 8; i++)
+			{
+				assert(queue.pop(v) && v == Volts(float(lap * 8 + i)));
+			}
+			assert(!queue.pop(v));
+		}
+
+		std::vector<Volts> in(6), out(10);
+		for(std::size_t i = 0; i < in.size(); i++)
+		{
+			in[i] = Volts(float(i));
+		}
+		assert(queue.push(in) == 6);
+		assert(queue.push(in) == 2);
+		assert(queue.pop(Mesi::Span<Volts>(out).subspan(0, 3)) == 3);
+		assert(queue.pop(out) == 5);
+		assert(out[0] == Volts(3.0f) && out[2] == Volts(5.0f) && out[3] == Volts(0.0f) && out[4] == Volts(1.0f));
+		assert(queue.pop(out) == 0);
+	}
+
+	Tee_SubTest(test_spsc_threads) {
+		constexpr int64_t count = 200000;
+		Mesi::SpscQueue<Tagged> queue(64);
+		std::thread producer([&] {
+			std::vector<Tagged> batch(7);
+			for(int64_t i = 0; i < count;)
+			{
+				if(i % 3 == 0)
+				{
+					bool const pushed = queue.push(Tagged(i));
+					i += pushed ? 1 : 0;
+					if(!pushed)
+					{
+						std::this_thread::yield();
+					}
+					continue;
+				}
+				std::size_t const n = std::size_t(std::min<int64_t>(7, count - i));
+				for(std::size_t j = 0; j < n; j++)
+				{
+					batch[j] = Tagged(i + int64_t(j));
+				}
+				std::size_t const pushed = queue.push(Mesi::Span<Tagged const>(batch.data(), n));
+				i += int64_t(pushed);
+				if(pushed == 0)
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+		std::vector<Tagged> block(16);
+		int64_t expected = 0;
+		bool ordered = true;
+		while(expected < count)
+		{
+			std::size_t const n = queue.pop(block);
+			if(n == 0)
+			{
+				std::this_thread::yield();
+			}
+			for(std::size_t j = 0; j < n; j++)
+			{
+				ordered = ordered && block[j].val == expected++;
+			}
+		}
+		producer.join();
+		assert(ordered && queue.empty());
+	}
+
+	Tee_SubTest(test_mpsc_threads) {
+		constexpr int producers = 4;
+		constexpr int64_t count = 50000;
+		Mesi::MpscQueue<Tagged> queue(100);
+		assert(queue.capacity() == 128);
+		std::vector<std::thread> threads;
+		for(int p = 0; p < producers; p++)
+		{
+			threads.emplace_back([&queue, p] {
+				Tagged batch[5];
+				for(int64_t i = 0; i < count;)
+				{
+					if(i % 2 == 0)
+					{
+						bool const pushed = queue.push(Tagged(p * count + i));
+						i += pushed ? 1 : 0;
+						if(!pushed)
+						{
+							std::this_thread::yield();
+						}
+						continue;
+					}
+					std::size_t const n = std::size_t(std::min<int64_t>(5, count - i));
+					for(std::size_t j = 0; j < n; j++)
+					{
+						batch[j] = Tagged(p * count + i + int64_t(j));
+					}
+					std::size_t const pushed = queue.push(Mesi::Span<Tagged const>(batch, n));
+					i += int64_t(pushed);
+					if(pushed == 0)
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+		// Each producer's values must arrive in its order
+		std::vector<int64_t> next(producers, 0);
+		std::vector<Tagged> block(9);
+		int64_t received = 0;
+		bool ordered = true;
+		while(received < producers * count)
+		{
+			Tagged one;
+			std::size_t n = 0;
+			if(received % 2 == 0)
+			{
+				n = queue.pop(one) ? 1 : 0;
+				block[0] = one;
+			}
+			else
+			{
+				n = queue.pop(block);
+			}
+			if(n == 0)
+			{
+				std::this_thread::yield();
+			}
+			for(std::size_t j = 0; j < n; j++)
+			{
+				int64_t const p = block[j].val / count;
+				ordered = ordered && block[j].val % count == next[p]++;
+			}
+			received += int64_t(n);
+		}
+		for(auto& t : threads)
+		{
+			t.join();
+		}
+		assert(ordered && queue.empty());
+		for(int p = 0; p < producers; p++)
+		{
+			assert(next[p] == count);
+		}
+	}
+}
+
+Tee_Test(test_dual) {
+	using Meters = Mesi::Meters;
+	using Seconds = Mesi::Seconds;
+	using Stiffness = decltype(Mesi::Newtons{} / Meters{});
+	auto close = [](double a, double b) {
+		return std::abs(a - b) <= 1e-5 * (1 + std::abs(b));
+	};
+
+	Tee_SubTest(test_typed_derivatives) {
+		// The force from a spring's potential energy, U = k x^2 / 2
+		Stiffness const k(40.0f);
+		auto const x = Mesi::independent(Meters(0.25f));
+		auto const energy = Mesi::Scalar(0.5f) * k * x * x;
+		assert((std::is_same<decltype(Mesi::value(energy)), Mesi::Joules>::value));
+		assert((std::is_same<decltype(Mesi::derivative(energy, x)), Mesi::Newtons>::value));
+		assert(Mesi::value(energy) == Mesi::Joules(1.25f));
+		assert(-Mesi::derivative(energy, x) == -Mesi::Newtons(10.0f));
+
+		// Through Mesi::pow, sqrt, scale conversions and comparisons
+		auto const area = Mesi::pow<std::ratio<3, 2>>(x * x * Mesi::Scalar(4.0f));
+		assert(close(Mesi::derivative(area, x).val, 3 * 8 * 0.25 * 0.25));
+		auto const root = std::sqrt(x);
+		assert(close(Mesi::derivative(root, x).val, 0.5 / 0.5));
+		Mesi::Kilo<decltype(x)> const far(x * 2000);
+		assert(close(Mesi::value(far).val, 0.5) && close(Mesi::derivative(far, x).val, 2));
+		assert((std::is_same<decltype(Mesi::derivative(far, x)), Mesi::Kilo<Mesi::Scalar>>::value));
+		assert(x < x * 2 && x == x + Mesi::Meters(0.0f) * 0);
+	}
+
+	Tee_SubTest(test_maths) {
+		using Dual = Mesi::Type<Mesi::Dual<double>, 0, 0, 0>;
+		double const at = 0.3;
+		auto const x = Mesi::independent(Mesi::Type<double, 0, 0, 0>(at));
+		auto d = [&](Dual const& y) {
+			return Mesi::derivative(y, x).val;
+		};
+		assert(close(d(std::sin(x)), std::cos(at)));
+		assert(close(d(std::cos(x)), -std::sin(at)));
+		assert(close(d(std::tan(x)), 1 / (std::cos(at) * std::cos(at))));
+		assert(close(d(std::exp(x * 2)), 2 * std::exp(2 * at)));
+		assert(close(d(std::log(x)), 1 / at));
+		assert(close(d(std::log2(x)), 1 / (at * std::log(2.0))));
+		assert(close(d(std::atan(x)), 1 / (1 + at * at)));
+		assert(close(d(std::asin(x)), 1 / std::sqrt(1 - at * at)));
+		assert(close(d(std::tanh(x)), 1 - std::tanh(at) * std::tanh(at)));
+		assert(close(d(std::erf(x)), 2 / std::sqrt(3.14159265358979323846) * std::exp(-at * at)));
+		assert(close(d(std::cbrt(x)), 1 / (3 * std::cbrt(at * at))));
+		// digamma(1) is minus the Euler-Mascheroni constant, and
+		// digamma(x + 1) = digamma(x) + 1 / x
+		double const euler = 0.57721566490153286;
+		assert(close(d(std::lgamma(x / at)), -euler / at));
+		assert(close(d(std::tgamma(x / at + Dual(1.0))), (1 - euler) / at));
+		for(double const y : {0.5, 1.0, 6.0})
+		{
+			double const exact = y == 0.5 ? -euler - 2 * std::log(2.0) : y == 1 ? -euler : 137.0 / 60 - euler;
+			assert(std::abs(Mesi::_internal::Digamma(y) - exact) < 1e-10);
+		}
+		assert(close(d(std::abs(-x)), 1) && close(d(std::floor(x)), 0));
+		assert(close(d(std::fmax(x, Dual(0.1))), 1) && close(d(std::fmin(x, Dual(0.1))), 0));
+		assert(close(d(std::atan2(x, Dual(1.0))), 1 / (1 + at * at)));
+	}
+
+	Tee_SubTest(test_directions) {
+		// Both partial derivatives of a distance travelled in one evaluation
+		using Speed = decltype(Meters{} / Seconds{});
+		auto const v = Mesi::independent<2>(Speed(3.0f), 0);
+		auto const t = Mesi::independent<2>(Seconds(4.0f), 1);
+		auto const distance = v * t + Mesi::Scalar(0.5f) * Mesi::Type<float, 1, -2, 0>(2.0f) * t * t;
+		assert((std::is_same<decltype(Mesi::derivative(distance, v, 0)), Seconds>::value));
+		assert((std::is_same<decltype(Mesi::derivative(distance, t, 1)), Speed>::value));
+		assert(Mesi::derivative(distance, v, 0) == Seconds(4.0f));
+		assert(Mesi::derivative(distance, t, 1) == Speed(3.0f + 2.0f * 4.0f));
+
+		// One column of the Jacobian at many points
+		std::vector<std::remove_const<decltype(distance)>::type> distances;
+		for(int i = 0; i < 10; i++)
+		{
+			distances.push_back(v * t * Mesi::Scalar(float(i)));
+		}
+		std::vector<Seconds> out(10);
+		Mesi::derivative(distances, v, out, 0);
+		for(int i = 0; i < 10; i++)
+		{
+			assert(out[i] == Seconds(4.0f * float(i)));
+		}
+	}
+}
+
+Tee_Test(test_group_by) {
+	using Watts = Mesi::Watts;
+	using Seconds = Mesi::Seconds;
+	using Kelvin = Mesi::Kelvin;
+	using Joules = Mesi::Joules;
+
+	// Readings from devices 7, 3 and 1000, interleaved
+	std::vector<uint32_t> const devices = {7, 3, 7, 1000, 3, 7};
+	std::vector<Watts> const power = {Watts(10), Watts(2), Watts(30), Watts(5), Watts(4), Watts(20)};
+	std::vector<Seconds> const durations = {Seconds(1), Seconds(2), Seconds(1), Seconds(3), Seconds(1), Seconds(2)};
+	std::vector<Kelvin> const temperature = {Kelvin(300), Kelvin(280), Kelvin(310), Kelvin(250), Kelvin(290), Kelvin(320)};
+
+	Tee_SubTest(test_aggregates) {
+		Mesi::GroupBy<uint32_t> const groups(devices);
+		assert(groups.size() == 3);
+		assert(groups.keys()[0] == 7 && groups.keys()[1] == 3 && groups.keys()[2] == 1000);
+		assert(groups.counts()[0] == 3 && groups.counts()[1] == 2 && groups.counts()[2] == 1);
+		assert(groups.find(3) == 1 && groups.find(4) == groups.size());
+		assert(groups.groups()[3] == 2);
+
+		std::vector<Joules> energy(groups.size());
+		groups.sumProduct(power, durations, energy);
+		assert(energy[0] == Joules(80) && energy[1] == Joules(8) && energy[2] == Joules(15));
+
+		std::vector<Watts> peak(groups.size());
+		std::vector<Watts> low(groups.size());
+		std::vector<Watts> total(groups.size());
+		groups.max(power, peak);
+		groups.min(power, low);
+		groups.sum(power, total);
+		assert(peak[0] == Watts(30) && peak[1] == Watts(4) && peak[2] == Watts(5));
+		assert(low[0] == Watts(10) && low[1] == Watts(2) && low[2] == Watts(5));
+		assert(total[0] == Watts(60) && total[1] == Watts(6) && total[2] == Watts(5));
+
+		std::vector<Kelvin> typical(groups.size());
+		groups.mean(temperature, typical);
+		assert(typical[0] == Kelvin(310) && typical[1] == Kelvin(285) && typical[2] == Kelvin(250));
+	}
+
+	Tee_SubTest(test_threads) {
+		// Many groups, with keys that collide in a small table
+		std::size_t const rows = 100000;
+		std::vector<uint64_t> keys(rows);
+		std::vector<Watts> values(rows);
+		uint32_t state = 1;
+		for(std::size_t i = 0; i < rows; i++)
+		{
+			state = state * 1664525u + 1013904223u;
+			keys[i] = uint64_t(state >> 22) << 32;
+			values[i] = Watts(float(state >> 8 & 1023));
+		}
+		Mesi::GroupBy<uint64_t> const serial(keys, 1);
+		Mesi::GroupBy<uint64_t> const parallel(keys, 4);
+		assert(serial.size() == parallel.size() && serial.size() <= 1024);
+		std::size_t counted = 0;
+		for(std::size_t g = 0; g < serial.size(); g++)
+		{
+			assert(serial.keys()[g] == parallel.keys()[g]);
+			assert(serial.counts()[g] == parallel.counts()[g]);
+			counted += serial.counts()[g];
+		}
+		assert(counted == rows);
+		for(std::size_t i = 0; i < rows; i++)
+		{
+			assert(serial.groups()[i] == parallel.groups()[i]);
+			assert(serial.keys()[serial.groups()[i]] == keys[i]);
+		}
+
+		// Sums of whole numbers are exact in any order
+		std::vector<Watts> a(serial.size());
+		std::vector<Watts> b(serial.size());
+		serial.sum(values, a, 1);
+		parallel.sum(values, b, 3);
+		assert(a == b);
+		serial.max(values, a, 1);
+		parallel.max(values, b, 4);
+		assert(a == b);
+	}
+}
+
+Tee_Test(test_clock) {
+	using Seconds = Mesi::Seconds;
+
+	Tee_SubTest(test_chrono) {
+		// Periods map onto scales, so only the count is copied
+		assert((std::is_same<decltype(Mesi::from_chrono(std::chrono::duration<float, std::milli>())), Mesi::Milli<Seconds>>::value));
+		assert((std::is_same<decltype(Mesi::from_chrono(std::chrono::nanoseconds())), Mesi::Nano<Mesi::Type<std::chrono::nanoseconds::rep, 0, 1, 0>>>::value));
+		assert((std::is_same<decltype(Mesi::to_chrono(Mesi::Nano<Seconds>())), std::chrono::duration<float, std::nano>>::value));
+		assert((std::is_same<decltype(Mesi::to_chrono(Seconds::Multiply<60>())), std::chrono::duration<float, std::ratio<60>>>::value));
+		assert(Mesi::from_chrono(std::chrono::duration<float, std::milli>(2.5f)) == Mesi::Milli<Seconds>(2.5f));
+		assert(Mesi::to_chrono(Mesi::Kilo<Seconds>(3.0f)).count() == 3.0f);
+		assert(Mesi::from_chrono(std::chrono::minutes(2)).val == 2);
+		assert(std::chrono::duration_cast<std::chrono::seconds>(Mesi::to_chrono(Mesi::from_chrono(std::chrono::minutes(2)))).count() == 120);
+		Mesi::Nano<Seconds> const elapsed = Mesi::ClockDuration(1500);
+		assert(elapsed == Mesi::Nano<Seconds>(1500.0f));
+	}
+
+	Tee_SubTest(test_clocks) {
+		std::uint64_t const start = Mesi::SteadyClock::ticks();
+		std::uint64_t const tsc = Mesi::ProfileClock::ticks();
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		Mesi::ClockDuration const steady = Mesi::SteadyClock::elapsed(start, Mesi::SteadyClock::ticks());
+		Mesi::ClockDuration const profile = Mesi::ProfileClock::elapsed(tsc, Mesi::ProfileClock::ticks());
+		assert(steady >= Mesi::ClockDuration(20000000) && profile >= Mesi::ClockDuration(19000000));
+		assert(Mesi::SteadyClock::now() > Mesi::ClockDuration(0));
+	}
+
+	Tee_SubTest(test_histogram) {
+		using Histogram = Mesi::TimeHistogram;
+		for(std::size_t b = 0; b < Histogram::c_buckets; b++)
+		{
+			std::uint64_t const lo = std::uint64_t(Histogram::lowerBound(b).val);
+			std::uint64_t const hi = std::uint64_t(Histogram::upperBound(b).val);
+			assert(Histogram::bucketOf(lo) == b && Histogram::bucketOf(hi) == b);
+			assert(b == 0 || Histogram::upperBound(b - 1).val + 1 == Histogram::lowerBound(b).val);
+			assert(double(hi - lo) <= 0.125 * double(lo));
+		}
+
+		Histogram h;
+		assert(h.count() == 0 && h.quantile(0.5) == Mesi::ClockDuration(0));
+		for(int i = 1; i <= 100; i++)
+		{
+			h.record(Mesi::Micro<Seconds>(float(i)));
+		}
+		h.record(Mesi::ClockDuration(-5));
+		assert(h.count() == 101 && h.countIn(0) == 1);
+		assert(h.total() == Mesi::ClockDuration(5050000));
+		Mesi::ClockDuration const median = h.quantile(0.5);
+		assert(median >= Mesi::ClockDuration(50000) && median <= Mesi::ClockDuration(57000));
+		assert(h.quantile(1) >= Mesi::ClockDuration(100000));
+		h.reset();
+		assert(h.count() == 0);
+
+		// Many threads recording at once lose nothing
+		std::vector<std::thread> threads;
+		for(int t = 0; t < 4; t++)
+		{
+			threads.emplace_back([&h] {
+				for(int i = 0; i < 1000; i++)
+				{
+					Mesi::ScopedTimer<> timer(h);
+				}
+			});
+		}
+		for(auto& t : threads)
+		{
+			t.join();
+		}
+		assert(h.count() == 4000);
+	}
+}
+
 int main() {
 	int successes;
 	vector<string> fails;